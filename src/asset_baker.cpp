@@ -0,0 +1,142 @@
+#include <SDL.h>
+#include <SDL_image.h>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <game/atlas.hpp>
+#include <game/utils.hpp>
+
+/**
+ * Build step: bakes assets into C++ source
+ *
+ * Usage: asset_baker <output.cpp> <font.ttf> <image.png>...
+ *
+ * Images are decoded, packed into atlas and stored in the pixel format
+ * preferred by renderers, font is stored as it is.
+ */
+namespace {
+//! Pixel format of baked atlas (native for most of SDL's renderers)
+constexpr auto bakedFormat = SDL_PIXELFORMAT_ARGB8888;
+
+//! Atlas limit, supported by all renderers of the target platforms
+constexpr SDL_Point maxAtlasSize = { 4096, 4096 };
+
+auto
+loadImage(const std::string& path) -> utils::RaiiOwnership<SDL_Surface>
+{
+  SDL_Surface* image = utils::throw_if_null(
+    IMG_Load(path.c_str()), std::string("Failed to load image: ") + path);
+  SDL_Surface* converted = SDL_ConvertSurfaceFormat(image, bakedFormat, 0);
+  SDL_FreeSurface(image);
+
+  return utils::make_raii_deleter<SDL_Surface>(
+    utils::throw_if_null(converted,
+                         std::string("Failed to convert image: ") + path),
+    [](SDL_Surface* surface) { SDL_FreeSurface(surface); });
+}
+
+void
+writeFont(std::ostream& output, const std::string& path)
+{
+  std::ifstream input(path, std::ios::binary);
+  if (!input) {
+    throw std::runtime_error("Failed to open font: " + path);
+  }
+  const std::vector<char> bytes((std::istreambuf_iterator<char>(input)),
+                                std::istreambuf_iterator<char>());
+
+  output << "static const std::uint8_t fontData[] = {";
+  for (std::size_t i = 0; i < bytes.size(); i++) {
+    output << (i % 24 == 0 ? "\n" : "")
+           << static_cast<unsigned>(static_cast<unsigned char>(bytes[i]))
+           << ",";
+  }
+  output << "\n};\n";
+  output << "const std::span<const std::uint8_t> font = fontData;\n\n";
+}
+
+void
+writeAtlas(std::ostream& output, const std::vector<std::string>& paths)
+{
+  std::vector<utils::RaiiOwnership<SDL_Surface>> images;
+  std::vector<SDL_Point> sizes;
+  for (const auto& path : paths) {
+    images.push_back(loadImage(path));
+    sizes.push_back(SDL_Point{ images.back()->w, images.back()->h });
+  }
+
+  const auto layout = atlas::pack(sizes, maxAtlasSize);
+
+  // copy images into atlas (transparent padding is zero)
+  std::vector<std::uint32_t> pixels(layout.size.x * layout.size.y, 0);
+  for (std::size_t i = 0; i < images.size(); i++) {
+    const auto& image = images[i];
+    const auto& rect = layout.rects[i];
+    for (int y = 0; y < rect.h; y++) {
+      const auto* row = reinterpret_cast<const std::uint32_t*>(
+        static_cast<const std::uint8_t*>(image->pixels) + y * image->pitch);
+      std::copy(
+        row, row + rect.w, &pixels[(rect.y + y) * layout.size.x + rect.x]);
+    }
+  }
+
+  output << "alignas(16) static const std::uint32_t atlasPixels[] = {";
+  for (std::size_t i = 0; i < pixels.size(); i++) {
+    output << (i % 16 == 0 ? "\n" : "") << "0x" << std::hex << pixels[i]
+           << std::dec << ",";
+  }
+  output << "\n};\n\n";
+
+  output << "static const Sprite sprites[] = {\n";
+  for (std::size_t i = 0; i < paths.size(); i++) {
+    const auto& rect = layout.rects[i];
+    output << "  { \"" << std::filesystem::path(paths[i]).stem().string()
+           << "\", { " << rect.x << ", " << rect.y << ", " << rect.w << ", "
+           << rect.h << " } },\n";
+  }
+  output << "};\n\n";
+
+  output << "const Atlas atlas = { " << layout.size.x << ", " << layout.size.y
+         << ", " << bakedFormat << "u, atlasPixels, sprites };\n";
+}
+} // namespace
+
+int
+main(int argc, char* args[])
+{
+  if (argc < 3) {
+    std::cerr << "Usage: asset_baker <output.cpp> <font.ttf> <image.png>..."
+              << std::endl;
+    return 1;
+  }
+
+  try {
+    const std::string outputPath = args[1];
+    const std::string fontPath = args[2];
+    const std::vector<std::string> imagePaths(args + 3, args + argc);
+
+    std::ofstream output(outputPath, std::ios::trunc);
+    if (!output) {
+      throw std::runtime_error("Failed to create: " + outputPath);
+    }
+
+    output << "// Generated by asset_baker, do not edit\n";
+    output << "#include \"game/baked_assets.hpp\"\n\n";
+    output << "namespace baked_assets {\n";
+    writeFont(output, fontPath);
+    writeAtlas(output, imagePaths);
+    output << "} // namespace baked_assets\n";
+
+    if (!output) {
+      throw std::runtime_error("Failed to write: " + outputPath);
+    }
+  } catch (const std::runtime_error& error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
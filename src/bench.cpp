@@ -0,0 +1,555 @@
+#include <SDL.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <optional>
+#include <queue>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "game/level.hpp"
+#include "game/world.hpp"
+
+/**
+ * Microbenchmarks of collision, update & observation hot paths
+ *
+ * Usage: bench [--filter substring] [--repetitions N] [--output results.json]
+ *              [--baseline baseline.json] [--tolerance percent]
+ *
+ * Each benchmark runs a batch of operations repeatedly and reports median
+ * and minimum time per operation. With --output, results are written as
+ * JSON, which can be stored and passed later as --baseline. Benchmark whose
+ * minimum (the least noisy) is slower than baseline by more than tolerance
+ * (default 15 %, or "tolerance" of the baseline entry) is reported as
+ * regression and bench exits with 1.
+ */
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+constexpr unsigned randomSeed = 42;
+
+//! Cheap batches are repeated, so that each takes at least milliseconds
+constexpr unsigned batchRounds = 64;
+
+//! Allowed slowdown against baseline (ratio)
+constexpr double defaultTolerance = 0.15;
+
+//! Levels for world benchmarks (columns x rows, every 4th cell is empty)
+constexpr std::array<SDL_Point, 3> levelSizes = { {
+  { 10, 7 },
+  { 100, 70 },
+  { 400, 280 },
+} };
+
+//! Simulated time between frames of World::update benchmark
+constexpr auto frameDelta = std::chrono::microseconds(16'667);
+
+struct Settings
+{
+  std::string filter;
+  unsigned repetitions{ 7 };
+  std::string outputPath;
+  std::string baselinePath;
+  double tolerance{ defaultTolerance };
+};
+
+struct Result
+{
+  std::string name;
+
+  //! Operations in single batch
+  std::uint64_t operations{ 0 };
+
+  double medianNs{ 0 };
+  double minNs{ 0 };
+};
+
+struct BaselineEntry
+{
+  double minNs;
+  std::optional<double> tolerance;
+};
+
+Settings
+parseSettings(int argc, char* args[])
+{
+  Settings settings;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = args[i];
+    const auto nextValue = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value of " + arg);
+      }
+      return args[++i];
+    };
+
+    if (arg == "--filter") {
+      settings.filter = nextValue();
+    } else if (arg == "--repetitions") {
+      settings.repetitions = std::max(1ul, std::stoul(nextValue()));
+    } else if (arg == "--output") {
+      settings.outputPath = nextValue();
+    } else if (arg == "--baseline") {
+      settings.baselinePath = nextValue();
+    } else if (arg == "--tolerance") {
+      settings.tolerance = std::stod(nextValue()) / 100.0;
+    } else {
+      throw std::runtime_error("Unknown argument: " + arg);
+    }
+  }
+  return settings;
+}
+
+//! Exposes internals of world to benchmarks
+class BenchWorld : public World
+{
+public:
+  using World::detectBallCollisions;
+  using World::initializeWorld;
+  using World::onReleaseBall;
+  using World::spawnPickup;
+  using World::updatePickups;
+};
+
+//! Keeps result of benchmarked code alive (not optimized out)
+volatile std::uint64_t sink = 0;
+
+/**
+ * @brief Runs benchmarks and collects their results
+ */
+class Runner
+{
+public:
+  explicit Runner(const Settings& settings)
+    : m_settings(settings)
+  {
+  }
+
+  //! Measure batch (returns count of operations) repeatedly, setup of each
+  //! batch is not measured
+  void run(const std::string& name,
+           const std::function<void()>& setup,
+           const std::function<std::uint64_t()>& batch)
+  {
+    if (name.find(m_settings.filter) == std::string::npos) {
+      return;
+    }
+
+    // warm up caches (and allocations)
+    setup();
+    batch();
+
+    std::vector<double> times;
+    std::uint64_t operations = 0;
+    for (unsigned i = 0; i < m_settings.repetitions; i++) {
+      setup();
+      const auto beginning = Clock::now();
+      operations = batch();
+      const auto duration = std::chrono::duration<double, std::nano>(
+        Clock::now() - beginning);
+      times.push_back(duration.count() /
+                      std::max<std::uint64_t>(1, operations));
+    }
+
+    std::sort(times.begin(), times.end());
+    m_results.push_back(
+      Result{ name, operations, times[times.size() / 2], times.front() });
+    std::cout << std::format("{:<48} {:>12.1f} ns/op (min {:.1f})\n",
+                             name,
+                             m_results.back().medianNs,
+                             m_results.back().minNs);
+  }
+
+  const std::vector<Result>& getResults() const { return m_results; }
+
+private:
+  const Settings& m_settings;
+  std::vector<Result> m_results;
+};
+
+//! Write level of given size into temporary directory, returns its path
+std::string
+createLevel(SDL_Point size)
+{
+  const auto path =
+    std::filesystem::temp_directory_path() /
+    std::format("arkanoid_bench_{}x{}.arkl", size.x, size.y);
+
+  const std::vector<level::PaletteEntry> palette = {
+    { 0xFF, 0x00, 0x00, 0xFF },
+    { 0x00, 0xFF, 0x00, 0xFF },
+    { 0x00, 0x00, 0xFF, 0xFF },
+  };
+  std::vector<level::TileRecord> tiles;
+  for (int y = 0; y < size.y; y++) {
+    for (int x = 0; x < size.x; x++) {
+      const bool isEmpty = (x + y) % 4 == 0;
+      tiles.push_back(level::TileRecord{
+        static_cast<std::uint8_t>((x + y) % palette.size()),
+        static_cast<std::uint8_t>(isEmpty ? 0 : 1 + (x * y) % 2),
+        0,
+        0 });
+    }
+  }
+  level::writeLevelFile(path.string(), size.x, size.y, palette, tiles);
+  return path.string();
+}
+
+std::unique_ptr<BenchWorld>
+createWorld(const std::string& levelPath)
+{
+  auto world = std::make_unique<BenchWorld>();
+  world->setRandomSeed(randomSeed);
+  world->loadLevel(level::LevelFile(levelPath));
+  world->initializeWorld();
+  return world;
+}
+
+SDL_Keysym
+makeKey(SDL_Keycode code)
+{
+  SDL_Keysym key{};
+  key.sym = code;
+  return key;
+}
+
+void
+benchmarkCollisionState(Runner& runner)
+{
+  constexpr unsigned rectCount = 4096;
+
+  // rectangles around ball: missing, touching sides & corners, covering it
+  Ball ball;
+  ball.position = SDL_FPoint{ 500, 500 };
+  ball.radius = Constants::ballRadius;
+
+  std::srand(randomSeed);
+  std::vector<SDL_FRect> rects;
+  for (unsigned i = 0; i < rectCount; i++) {
+    const auto offset = [](float range) {
+      return (std::rand() % 1000) / 1000.0f * range - range * 0.5f;
+    };
+    rects.push_back(SDL_FRect{ ball.position.x + offset(4 * ball.radius) -
+                                 Constants::tileWidth * 0.5f,
+                               ball.position.y + offset(4 * ball.radius) -
+                                 Constants::tileHeight * 0.5f,
+                               Constants::tileWidth,
+                               Constants::tileHeight });
+  }
+
+  runner.run(
+    "ball/getCollisionStateForGivenRect",
+    []() {},
+    [&]() -> std::uint64_t {
+      std::uint64_t states = 0;
+      for (unsigned round = 0; round < batchRounds; round++) {
+        for (const auto& rect : rects) {
+          states +=
+            static_cast<unsigned>(ball.getCollisionStateForGivenRect(rect));
+        }
+      }
+      sink = sink + states;
+      return static_cast<std::uint64_t>(batchRounds) * rects.size();
+    });
+}
+
+void
+benchmarkBallCollisions(Runner& runner, const std::string& name, SDL_Point size)
+{
+  const auto world = createWorld(createLevel(size));
+
+  // balls spread over the initial view (where tiles are resident)
+  std::vector<Ball> balls;
+  for (unsigned y = 0; y < Constants::worldHeight; y += 10) {
+    for (unsigned x = 0; x < Constants::worldWidth; x += 10) {
+      Ball ball;
+      ball.position = SDL_FPoint{ static_cast<float>(x),
+                                  static_cast<float>(y) };
+      ball.radius = Constants::ballRadius;
+      ball.speed = SDL_FPoint{ 100, -Constants::ballSpeed };
+      balls.push_back(ball);
+    }
+  }
+
+  runner.run(
+    "world/detectBallCollisions/" + name,
+    []() {},
+    [&]() -> std::uint64_t {
+      std::uint64_t collisions = 0;
+      for (unsigned round = 0; round < batchRounds; round++) {
+        for (auto ball : balls) {
+          collisions += world->detectBallCollisions(ball, false);
+        }
+      }
+      sink = sink + collisions;
+      return static_cast<std::uint64_t>(batchRounds) * balls.size();
+    });
+}
+
+void
+benchmarkUpdate(Runner& runner, const std::string& name, SDL_Point size)
+{
+  constexpr unsigned frames = 3000;
+  constexpr unsigned paddleSweepFrames = 40;
+
+  const auto levelPath = createLevel(size);
+  std::unique_ptr<BenchWorld> world;
+  runner.run(
+    "world/update/" + name,
+    [&]() { world = createWorld(levelPath); },
+    [&]() -> std::uint64_t {
+      for (unsigned frame = 0; frame < frames; frame++) {
+        // release ball whenever it's lost, sweep paddle
+        if (frame % paddleSweepFrames == 0) {
+          world->onReleaseBall();
+          const bool moveLeft = (frame / paddleSweepFrames) % 2;
+          world->onKeyPressed(moveLeft, makeKey(SDLK_LEFT));
+          world->onKeyPressed(!moveLeft, makeKey(SDLK_RIGHT));
+        }
+        world->update(frameDelta);
+      }
+      return frames;
+    });
+}
+
+void
+benchmarkPickups(Runner& runner, unsigned pickupCount)
+{
+  // note: pickups fall only a few units, none leaves world or hits paddle
+  constexpr unsigned steps = 1000;
+  constexpr auto stepDelta = std::chrono::microseconds(100);
+
+  const auto levelPath = createLevel(levelSizes.front());
+  std::unique_ptr<BenchWorld> world;
+  runner.run(
+    std::format("world/updatePickups/pickups={}", pickupCount),
+    [&]() {
+      world = createWorld(levelPath);
+      std::srand(randomSeed);
+      for (unsigned i = 0; i < pickupCount; i++) {
+        const int x = std::rand() % Constants::worldWidth;
+        const int y = std::rand() % (Constants::worldHeight / 2);
+        world->spawnPickup(
+          SDL_Point{ x, y },
+          Color::white,
+          static_cast<Pickup::Type>(i % Pickup::Type::size));
+      }
+    },
+    [&]() -> std::uint64_t {
+      for (unsigned step = 0; step < steps; step++) {
+        world->updatePickups(stepDelta);
+      }
+      return static_cast<std::uint64_t>(steps) * pickupCount;
+    });
+}
+
+void
+benchmarkEvents(Runner& runner, unsigned eventCount)
+{
+  std::srand(randomSeed);
+  std::vector<std::chrono::milliseconds> delays;
+  for (unsigned i = 0; i < eventCount; i++) {
+    delays.push_back(std::chrono::milliseconds(std::rand() % 10'000));
+  }
+
+  // note: small queues are filled & drained repeatedly
+  const auto rounds = std::max(1u, batchRounds * 100 / eventCount);
+
+  // same queue as world uses
+  runner.run(
+    std::format("event/pushPop/events={}", eventCount),
+    []() {},
+    [&]() -> std::uint64_t {
+      std::priority_queue<Event> events;
+      std::uint64_t evaluated = 0;
+      for (unsigned round = 0; round < rounds; round++) {
+        for (const auto delay : delays) {
+          events.push(Event(delay, [&evaluated]() { evaluated++; }));
+        }
+        while (!events.empty()) {
+          const auto event = events.top();
+          events.pop();
+          event.getCallback()();
+        }
+      }
+      sink = sink + evaluated;
+      return static_cast<std::uint64_t>(rounds) * delays.size();
+    });
+}
+
+void
+benchmarkOccupancyGrid(Runner& runner, int width, int height)
+{
+  const auto levelPath = createLevel(levelSizes.front());
+  const auto world = createWorld(levelPath);
+  world->onReleaseBall();
+
+  std::vector<std::uint8_t> cells(OccupancyGrid::getSize(width, height));
+  OccupancyGrid grid(cells, width, height);
+  runner.run(
+    std::format("world/renderOccupancyGrid/{}x{}", width, height),
+    []() {},
+    [&]() -> std::uint64_t {
+      for (unsigned round = 0; round < batchRounds; round++) {
+        world->renderOccupancyGrid(grid);
+      }
+      sink = sink + cells[cells.size() / 2];
+      return batchRounds;
+    });
+}
+
+void
+writeResults(const std::string& path, const std::vector<Result>& results)
+{
+  std::ofstream file(path);
+  if (!file) {
+    throw std::runtime_error("Failed to open results file: " + path);
+  }
+
+  // note: one benchmark per line, as expected by readBaseline()
+  file << "{\n  \"benchmarks\": [\n";
+  for (std::size_t i = 0; i < results.size(); i++) {
+    const auto& result = results[i];
+    file << std::format("    {{ \"name\": \"{}\", \"operations\": {}, "
+                        "\"ns_per_op\": {:.3f}, "
+                        "\"min_ns_per_op\": {:.3f} }}{}\n",
+                        result.name,
+                        result.operations,
+                        result.medianNs,
+                        result.minNs,
+                        i + 1 < results.size() ? "," : "");
+  }
+  file << "  ]\n}\n";
+
+  if (!file) {
+    throw std::runtime_error("Failed to write results file: " + path);
+  }
+}
+
+//! Read results written by writeResults() (entries may be extended by
+//! "tolerance" in percent)
+std::unordered_map<std::string, BaselineEntry>
+readBaseline(const std::string& path)
+{
+  std::ifstream file(path);
+  if (!file) {
+    throw std::runtime_error("Failed to open baseline: " + path);
+  }
+
+  const std::regex namePattern(R"re("name"\s*:\s*"([^"]*)")re");
+  const std::regex timePattern(R"re("min_ns_per_op"\s*:\s*([0-9.eE+-]+))re");
+  const std::regex tolerancePattern(R"re("tolerance"\s*:\s*([0-9.eE+-]+))re");
+
+  std::unordered_map<std::string, BaselineEntry> baseline;
+  std::string line;
+  while (std::getline(file, line)) {
+    std::smatch name;
+    std::smatch time;
+    if (!std::regex_search(line, name, namePattern) ||
+        !std::regex_search(line, time, timePattern)) {
+      continue;
+    }
+
+    BaselineEntry entry{ std::stod(time[1].str()), std::nullopt };
+    std::smatch tolerance;
+    if (std::regex_search(line, tolerance, tolerancePattern)) {
+      entry.tolerance = std::stod(tolerance[1].str()) / 100.0;
+    }
+    baseline[name[1].str()] = entry;
+  }
+
+  if (baseline.empty()) {
+    throw std::runtime_error("No benchmarks in baseline: " + path);
+  }
+  return baseline;
+}
+
+//! Returns count of regressions
+unsigned
+compareWithBaseline(const Settings& settings,
+                    const std::vector<Result>& results)
+{
+  const auto baseline = readBaseline(settings.baselinePath);
+
+  unsigned regressions = 0;
+  std::cout << std::format("\nbaseline: {}\n", settings.baselinePath);
+  for (const auto& result : results) {
+    const auto it = baseline.find(result.name);
+    if (it == baseline.end()) {
+      std::cout << std::format("{:<48} new\n", result.name);
+      continue;
+    }
+
+    const auto& entry = it->second;
+    const auto tolerance = entry.tolerance.value_or(settings.tolerance);
+    const auto change = result.minNs / entry.minNs - 1.0;
+
+    const char* status = "ok";
+    if (change > tolerance) {
+      status = "REGRESSION";
+      regressions++;
+    } else if (change < -tolerance) {
+      status = "improved";
+    }
+    std::cout << std::format("{:<48} {:>+7.1f} % (tolerance {:.0f} %) {}\n",
+                             result.name,
+                             change * 100.0,
+                             tolerance * 100.0,
+                             status);
+  }
+  return regressions;
+}
+} // namespace
+
+int
+main(int argc, char* args[])
+{
+  try {
+    const auto settings = parseSettings(argc, args);
+
+    // note: world logs its events, that is not what should be measured
+    SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN);
+
+    Runner runner(settings);
+    benchmarkCollisionState(runner);
+    for (const auto size : levelSizes) {
+      const auto name = std::format("level={}x{}", size.x, size.y);
+      benchmarkBallCollisions(runner, name, size);
+      benchmarkUpdate(runner, name, size);
+    }
+    benchmarkPickups(runner, 100);
+    benchmarkPickups(runner, 10'000);
+    benchmarkEvents(runner, 100);
+    benchmarkEvents(runner, 10'000);
+    benchmarkOccupancyGrid(runner, 84, 84);
+
+    if (!settings.outputPath.empty()) {
+      writeResults(settings.outputPath, runner.getResults());
+    }
+
+    if (!settings.baselinePath.empty()) {
+      const auto regressions =
+        compareWithBaseline(settings, runner.getResults());
+      if (regressions > 0) {
+        std::cerr << std::format("{} benchmark(s) regressed\n", regressions);
+        return 1;
+      }
+    }
+  } catch (const std::exception& e) {
+    std::cerr << "Benchmark failed: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,151 @@
+#include "arkanoid_env.h"
+
+#include <SDL.h>
+
+#include <exception>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "game/vector_env.hpp"
+
+struct arkanoid_env
+{
+  arkanoid_env(size_t count,
+               unsigned threads,
+               unsigned seed,
+               unsigned frameSkip)
+    : env(count, threads, seed, frameSkip)
+    , actions(count)
+  {
+  }
+
+  VectorEnv env;
+
+  //! Validated actions of current step
+  std::vector<AgentAction> actions;
+};
+
+static_assert(static_cast<int>(AgentAction::none) == ARKANOID_ACTION_NONE);
+static_assert(static_cast<int>(AgentAction::left) == ARKANOID_ACTION_LEFT);
+static_assert(static_cast<int>(AgentAction::right) == ARKANOID_ACTION_RIGHT);
+static_assert(static_cast<int>(AgentAction::release) ==
+              ARKANOID_ACTION_RELEASE);
+
+namespace {
+thread_local std::string lastError;
+
+//! Run function, converting exceptions into error code & message
+template<typename Function>
+int
+guard(Function&& function)
+{
+  try {
+    function();
+    lastError.clear();
+    return 0;
+  } catch (const std::exception& e) {
+    lastError = e.what();
+  } catch (...) {
+    lastError = "Unknown error";
+  }
+  return -1;
+}
+} // namespace
+
+extern "C" {
+size_t
+arkanoid_env_observation_size(void)
+{
+  return World::observationSize;
+}
+
+arkanoid_env*
+arkanoid_env_create(size_t count,
+                    unsigned threads,
+                    unsigned seed,
+                    unsigned frame_skip)
+{
+  // note: worlds log their events, which floods output & slows stepping down
+  SDL_LogSetPriority(SDL_LOG_CATEGORY_APPLICATION, SDL_LOG_PRIORITY_WARN);
+
+  arkanoid_env* env = nullptr;
+  guard([&]() { env = new arkanoid_env(count, threads, seed, frame_skip); });
+  return env;
+}
+
+void
+arkanoid_env_destroy(arkanoid_env* env)
+{
+  delete env;
+}
+
+size_t
+arkanoid_env_count(const arkanoid_env* env)
+{
+  return env != nullptr ? env->env.getEnvCount() : 0;
+}
+
+int
+arkanoid_env_reset(arkanoid_env* env, float* observations)
+{
+  return guard([&]() {
+    if (env == nullptr || observations == nullptr) {
+      throw std::invalid_argument("Missing environment or buffer");
+    }
+    env->env.reset(observations);
+  });
+}
+
+int
+arkanoid_env_step(arkanoid_env* env,
+                  const int32_t* actions,
+                  float* observations,
+                  float* rewards,
+                  uint8_t* dones)
+{
+  return guard([&]() {
+    if (env == nullptr || actions == nullptr || observations == nullptr ||
+        rewards == nullptr || dones == nullptr) {
+      throw std::invalid_argument("Missing environment or buffer");
+    }
+
+    for (size_t i = 0; i < env->actions.size(); i++) {
+      if (actions[i] < ARKANOID_ACTION_NONE ||
+          actions[i] > ARKANOID_ACTION_RELEASE) {
+        throw std::invalid_argument("Invalid action of environment " +
+                                    std::to_string(i));
+      }
+      env->actions[i] = static_cast<AgentAction>(actions[i]);
+    }
+    env->env.step(env->actions.data(), observations, rewards, dones);
+  });
+}
+
+size_t
+arkanoid_env_grid_size(int width, int height)
+{
+  return width > 0 && height > 0 ? OccupancyGrid::getSize(width, height) : 0;
+}
+
+int
+arkanoid_env_render_grids(arkanoid_env* env,
+                          int width,
+                          int height,
+                          uint8_t* grids)
+{
+  return guard([&]() {
+    if (env == nullptr || grids == nullptr) {
+      throw std::invalid_argument("Missing environment or buffer");
+    }
+    env->env.renderGrids(width, height, grids);
+  });
+}
+
+const char*
+arkanoid_env_last_error(void)
+{
+  return lastError.c_str();
+}
+}
@@ -0,0 +1,90 @@
+#ifndef ARKANOID_ENV_H
+#define ARKANOID_ENV_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * C API of vectorized game environments (for bots & reinforcement learning)
+ *
+ * Environments are stepped in parallel by a pool of threads. All buffers are
+ * owned by caller and written in place:
+ *   observations: count * arkanoid_env_observation_size() floats
+ *   rewards:      count floats (change of score during step)
+ *   dones:        count bytes (1 if episode finished, environment is then
+ *                 restarted and its observation is the first of next episode)
+ *
+ * Functions returning int return 0 on success and -1 on failure, see
+ * arkanoid_env_last_error(). Single environment set must not be used from
+ * multiple threads at once.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct arkanoid_env arkanoid_env;
+
+/* Action of single environment for one step */
+enum arkanoid_action
+{
+  ARKANOID_ACTION_NONE = 0,
+  ARKANOID_ACTION_LEFT = 1,
+  ARKANOID_ACTION_RIGHT = 2,
+  ARKANOID_ACTION_RELEASE = 3
+};
+
+/* Count of floats in observation of single environment */
+size_t
+arkanoid_env_observation_size(void);
+
+/* Create count environments stepped by threads (0 = all cores). Environment
+ * i is seeded by seed + i, each step repeats action for frame_skip frames.
+ * Returns NULL on failure. */
+arkanoid_env*
+arkanoid_env_create(size_t count,
+                    unsigned threads,
+                    unsigned seed,
+                    unsigned frame_skip);
+
+void
+arkanoid_env_destroy(arkanoid_env* env);
+
+size_t
+arkanoid_env_count(const arkanoid_env* env);
+
+/* Restart all environments, must be called before the first step */
+int
+arkanoid_env_reset(arkanoid_env* env, float* observations);
+
+/* Apply one action (enum arkanoid_action) per environment */
+int
+arkanoid_env_step(arkanoid_env* env,
+                  const int32_t* actions,
+                  float* observations,
+                  float* rewards,
+                  uint8_t* dones);
+
+/* Count of bytes in occupancy grid of single environment: planes of
+ * width * height cells (tiles, paddle, ball, ball's speed x & y, pickups of
+ * 4 types), see OccupancyGrid */
+size_t
+arkanoid_env_grid_size(int width, int height);
+
+/* Render current state of all environments into occupancy grids
+ * (count * arkanoid_env_grid_size(width, height) bytes) */
+int
+arkanoid_env_render_grids(arkanoid_env* env,
+                          int width,
+                          int height,
+                          uint8_t* grids);
+
+/* Message of the last failure on calling thread (empty if none) */
+const char*
+arkanoid_env_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
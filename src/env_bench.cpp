@@ -0,0 +1,135 @@
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "env/arkanoid_env.h"
+
+/**
+ * Throughput of vectorized environments (through their C API)
+ *
+ * Usage: env_bench [--envs N] [--threads N] [--steps N] [--frame-skip N]
+ *                  [--grid N]
+ *
+ * Steps all environments with random actions and reports steps per second
+ * across all environments. With --grid, each step also renders NxN
+ * occupancy grids of all environments.
+ */
+
+namespace {
+struct Settings
+{
+  std::size_t envs{ 64 };
+  unsigned threads{ 0 };
+  unsigned steps{ 2000 };
+  unsigned frameSkip{ 1 };
+  int grid{ 0 };
+};
+
+Settings
+parseSettings(int argc, char* args[])
+{
+  Settings settings;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = args[i];
+    const auto nextValue = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value of " + arg);
+      }
+      return args[++i];
+    };
+
+    if (arg == "--envs") {
+      settings.envs = std::stoul(nextValue());
+    } else if (arg == "--threads") {
+      settings.threads = std::stoul(nextValue());
+    } else if (arg == "--steps") {
+      settings.steps = std::stoul(nextValue());
+    } else if (arg == "--frame-skip") {
+      settings.frameSkip = std::stoul(nextValue());
+    } else if (arg == "--grid") {
+      settings.grid = std::stoi(nextValue());
+    } else {
+      throw std::runtime_error("Unknown argument: " + arg);
+    }
+  }
+  return settings;
+}
+} // namespace
+
+int
+main(int argc, char* args[])
+{
+  using clock = std::chrono::steady_clock;
+
+  try {
+    const auto settings = parseSettings(argc, args);
+
+    auto* env = arkanoid_env_create(
+      settings.envs, settings.threads, 42, settings.frameSkip);
+    if (env == nullptr) {
+      throw std::runtime_error(arkanoid_env_last_error());
+    }
+
+    const auto count = arkanoid_env_count(env);
+    std::vector<float> observations(count * arkanoid_env_observation_size());
+    std::vector<float> rewards(count);
+    std::vector<std::uint8_t> dones(count);
+    std::vector<std::int32_t> actions(count);
+    std::vector<std::uint8_t> grids(
+      count * arkanoid_env_grid_size(settings.grid, settings.grid));
+
+    if (arkanoid_env_reset(env, observations.data()) != 0) {
+      throw std::runtime_error(arkanoid_env_last_error());
+    }
+
+    std::minstd_rand random(42);
+    std::uint64_t episodes = 0;
+    double totalReward = 0;
+    const auto beginning = clock::now();
+    for (unsigned step = 0; step < settings.steps; step++) {
+      for (auto& action : actions) {
+        action = static_cast<std::int32_t>(random() % 4);
+      }
+      if (arkanoid_env_step(env,
+                            actions.data(),
+                            observations.data(),
+                            rewards.data(),
+                            dones.data()) != 0) {
+        throw std::runtime_error(arkanoid_env_last_error());
+      }
+      if (settings.grid > 0 &&
+          arkanoid_env_render_grids(
+            env, settings.grid, settings.grid, grids.data()) != 0) {
+        throw std::runtime_error(arkanoid_env_last_error());
+      }
+
+      for (std::size_t i = 0; i < count; i++) {
+        episodes += dones[i];
+        totalReward += rewards[i];
+      }
+    }
+    const auto seconds =
+      std::chrono::duration<double>(clock::now() - beginning).count();
+    arkanoid_env_destroy(env);
+
+    const auto steps = static_cast<double>(settings.steps) * count;
+    std::cout << std::format("environments: {}, steps: {}, episodes: {}, "
+                             "reward: {}\n",
+                             count,
+                             steps,
+                             episodes,
+                             totalReward);
+    std::cout << std::format("steps per second: {:.0f} ({:.0f} frames)\n",
+                             steps / seconds,
+                             steps * settings.frameSkip / seconds);
+  } catch (const std::exception& e) {
+    std::cerr << "Benchmark failed: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -7,84 +7,301 @@
 
 #include "application.hpp"
 #include "constants.hpp"
+#include "resample.hpp"
 #include <assert.h>
 
+#ifdef ARKANOID_EMBED_ASSETS
+#include "baked_assets.hpp"
+#endif
+
 namespace {
-//! How often should we check for unused text textures
-constexpr unsigned framesBetweenTextGarbageCollection = 1000; // frames
+//! Limit of atlas size when renderer does not report any
+constexpr int maxAtlasSize = 4096; // px
+
+//! Profiler's graph: frames shown, their scale and how often are
+//! percentiles refreshed
+constexpr int profilerGraphFrames = 120;
+constexpr int profilerBarWidth = 2;         // px
+constexpr int profilerGraphHeight = 80;     // px
+constexpr float profilerPixelsPerMs = 4.0f; // px
+constexpr unsigned profilerLabelInterval = 30; // frames
+
+//! Colors of phases stacked in profiler's graph (sleep is not shown)
+constexpr SDL_Color profilerPhaseColors[] = {
+  { 0xFF, 0xD7, 0x00, 0xFF }, // events
+  { 0xFF, 0x8C, 0x00, 0xFF }, // pickups
+  { 0x32, 0xCD, 0x32, 0xFF }, // dynamics
+  { 0x00, 0xBF, 0xFF, 0xFF }, // collision dry run
+  { 0x1E, 0x3C, 0xFF, 0xFF }, // microstepping
+  { 0xBA, 0x55, 0xD3, 0xFF }, // render entities
+  { 0xFF, 0x69, 0xB4, 0xFF }, // render HUD
+  { 0xA0, 0xA0, 0xA0, 0xFF }, // present
+};
+static_assert(std::size(profilerPhaseColors) ==
+              static_cast<std::size_t>(ProfilePhase::sleep));
+
+//! Name of file with current local time, e.g. prefix-20240101-120000.suffix
+std::string
+getTimestampedName(const std::string& prefix, const std::string& suffix)
+{
+  const auto now =
+    std::chrono::floor<std::chrono::seconds>(std::chrono::system_clock::now());
+  return std::format("{}-{:%Y%m%d-%H%M%S}{}", prefix, now, suffix);
+}
 } // namespace
 
+Application::~Application()
+{
+  if (Profiler::getCurrent() == &m_profiler) {
+    Profiler::setCurrent(nullptr);
+  }
+}
+
+void
+Application::setRenderBackend(RenderBackendType type)
+{
+  m_backendType = type;
+}
+
 void
 Application::createApplication()
 {
+  // note: hints must be set before SDL and window are created
+  SDL_SetHint(SDL_HINT_WINDOWS_DPI_AWARENESS, "permonitorv2");
+
   initializeSDL();
 
-  initializeWindowAndRenderer();
+  initializeWindowAndRenderer(false);
 
   m_textManager.initialize();
+  Profiler::setCurrent(&m_profiler);
 
   onInitCallback();
 }
 
 void
-Application::runLoop()
+Application::createHeadlessApplication()
 {
-  unsigned frameId = 0;
+  // note: hints must be set before SDL and renderer are created
+  SDL_SetHint(SDL_HINT_VIDEODRIVER, "offscreen");
+  SDL_SetHint(SDL_HINT_RENDER_DRIVER, "software");
 
+  initializeSDL();
+
+  initializeWindowAndRenderer(true);
+
+  m_textManager.initialize();
+  Profiler::setCurrent(&m_profiler);
+
+  onInitCallback();
+}
+
+void
+Application::runLoop()
+{
   SDL_Event e;
   bool quit = false;
   while (quit == false) {
-    while (SDL_PollEvent(&e)) {
-      if (e.type == SDL_QUIT)
-        quit = true;
-      if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) {
-        m_isStopped = !m_isStopped;
+    // nothing would change: sleep until input, or until scene changes itself
+    // note: waiting is sleep of the previous frame, not its busy time
+    const auto idleTimeout = getIdleTimeout();
+    if (idleTimeout != 0) {
+      bool hasEvent = false;
+      {
+        const ProfileScope scope(ProfilePhase::sleep);
+        hasEvent = SDL_WaitEventTimeout(&e, idleTimeout);
       }
-
-      if (onSDLEventCallback) {
-        onSDLEventCallback(e);
+      if (hasEvent) {
+        quit |= handleEvent(e);
       }
     }
 
+    while (SDL_PollEvent(&e)) {
+      quit |= handleEvent(e);
+    }
+
+    if (m_isMinimized) {
+      continue;
+    }
+
     const auto frameBeggining = std::chrono::high_resolution_clock::now();
 
-    const auto clearColor = Color::white;
-    SDL_SetRenderDrawColor(
-      m_renderer.get(), clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+    // note: swapped between frames, never in the middle of one
+    applyReloadedAssets();
 
-    SDL_RenderClear(m_renderer.get());
-    onRenderCallback();
-    SDL_RenderPresent(m_renderer.get());
+    renderFrame();
 
     // FPS lock on circa 60FPS
     using namespace std::chrono_literals;
+    const ProfileScope scope(ProfilePhase::sleep);
     std::this_thread::sleep_until(frameBeggining + 16ms);
+  }
+}
 
-    if (frameId % framesBetweenTextGarbageCollection == 0) {
-      // clean-up text render cache once a few frames
-      m_textManager.removeUnused();
+bool
+Application::handleEvent(const SDL_Event& e)
+{
+  if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_ESCAPE) {
+    m_isStopped = !m_isStopped;
+  }
+  if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F9) {
+    if (isRecording()) {
+      stopRecording();
+    } else {
+      startRecording("recordings/" + getTimestampedName("frames", ""));
     }
+  }
+  if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F3) {
+    m_isProfilerVisible = !m_isProfilerVisible;
+  }
+  if (e.type == SDL_KEYDOWN && e.key.keysym.sym == SDLK_F4) {
+    const auto path = getTimestampedName("profile", ".json");
+    try {
+      m_profiler.exportChromeTrace(path);
+      SDL_Log("Exported profile: %s", path.c_str());
+    } catch (const std::runtime_error& error) {
+      SDL_Log("%s", error.what());
+    }
+  }
+  if (e.type == SDL_WINDOWEVENT) {
+    switch (e.window.event) {
+      case SDL_WINDOWEVENT_SIZE_CHANGED:
+        logOutputSize();
+        break;
+      case SDL_WINDOWEVENT_FOCUS_LOST:
+        // note: player is away, pause instead of playing on
+        m_isStopped = true;
+        break;
+      case SDL_WINDOWEVENT_MINIMIZED:
+        m_isStopped = true;
+        m_isMinimized = true;
+        break;
+      case SDL_WINDOWEVENT_RESTORED:
+      case SDL_WINDOWEVENT_SHOWN:
+        m_isMinimized = false;
+        break;
+    }
+  }
 
-    frameId++;
+  if (onSDLEventCallback) {
+    onSDLEventCallback(e);
   }
+  return e.type == SDL_QUIT;
+}
+
+int
+Application::getIdleTimeout() const
+{
+  // nothing is visible, only input can change it
+  if (m_isMinimized) {
+    return -1;
+  }
+
+  // recording keeps timing of frames, scene must be rendered continuously
+  if (isRecording() || !getTimeUntilChangeCallback) {
+    return 0;
+  }
+
+  const auto timeUntilChange = getTimeUntilChangeCallback();
+  if (!timeUntilChange) {
+    return -1;
+  }
+
+  // note: rounded up, waking up earlier would render the same frame
+  return static_cast<int>(
+    std::chrono::ceil<std::chrono::milliseconds>(*timeUntilChange).count());
 }
 
 void
-Application::loadTexture(const std::string& name)
+Application::renderFrame()
 {
-  SDL_Log("Loading texture: %s", name.c_str());
+  // note: textures used by previous frame are no longer referenced by draws
+  m_textureCache.beginFrame();
+  m_textureCache.evictUnused(Constants::maxUnusedTextureFrames);
+  m_scaledSprites.beginFrame();
+  m_scaledSprites.evictUnused(Constants::maxUnusedTextureFrames);
+  m_profiler.beginFrame();
+
+  m_backend->beginFrame(Color::white);
+  onRenderCallback();
+
+  if (m_isProfilerVisible) {
+    renderProfilerOverlay();
+  }
 
-  SDL_Texture* texture =
-    utils::throw_if_null(IMG_LoadTexture(m_renderer.get(), name.c_str()),
-                         std::string("Failed to load texture: ") + name);
+  // note: frame is read back before present, encoding & I/O run on recorder
+  if (m_recorder) {
+    m_recorder->capture(
+      [this](SDL_Surface* frame) { return m_backend->readPixels(frame); });
+  }
 
-  const auto fileName = std::filesystem::path(name).stem().string();
-  m_textures[fileName] = texture;
+  const ProfileScope scope(ProfilePhase::present);
+  m_backend->endFrame();
+}
+
+void
+Application::renderProfilerOverlay()
+{
+  const auto frames = m_profiler.getFrames();
+  const auto ws = getWindowSize();
+  const int graphWidth = profilerGraphFrames * profilerBarWidth;
+  const auto graph = SDL_Rect{
+    5, ws.y - 5 - profilerGraphHeight, graphWidth, profilerGraphHeight
+  };
+  const int bottom = graph.y + graph.h;
+
+  fillRect(graph, SDL_Color{ 0, 0, 0, 0xA0 }, SDL_BLENDMODE_BLEND);
+
+  // stacked phases of the latest frames, the newest on the right
+  const auto shown = std::min<std::size_t>(frames.size(), profilerGraphFrames);
+  for (std::size_t i = 0; i < shown; i++) {
+    const auto& frame = frames[frames.size() - shown + i];
+    const int x = graph.x + static_cast<int>(i) * profilerBarWidth;
+
+    float top = static_cast<float>(bottom);
+    for (std::size_t phase = 0; phase < std::size(profilerPhaseColors);
+         phase++) {
+      const float height =
+        frame.phaseNs[phase] / 1'000'000.0f * profilerPixelsPerMs;
+      const auto newTop = std::max(top - height, static_cast<float>(graph.y));
+      const int y = static_cast<int>(newTop);
+      if (static_cast<int>(top) > y) {
+        fillRect(SDL_Rect{ x, y, profilerBarWidth, static_cast<int>(top) - y },
+                 profilerPhaseColors[phase]);
+      }
+      top = newTop;
+    }
+  }
+
+  // budget of 60 FPS frame
+  const int budgetY =
+    bottom - static_cast<int>(1000.0f / 60.0f * profilerPixelsPerMs);
+  fillRect(SDL_Rect{ graph.x, budgetY, graphWidth, 1 }, Color::red);
+
+  // note: label is refreshed rarely, each text is a new texture
+  if (m_profilerLabel.empty() ||
+      m_profiler.getFrameCount() % profilerLabelInterval == 0) {
+    const auto lastFrame = frames.empty() ? ProfileFrame{} : frames.back();
+    m_profilerLabel =
+      std::format("p50 {:.1f} ms p99 {:.1f} ms queue {} late {:.1f} ms",
+                  m_profiler.getBusyPercentile(50) / 1000.0,
+                  m_profiler.getBusyPercentile(99) / 1000.0,
+                  lastFrame.eventQueueDepth,
+                  lastFrame.maxLatenessUs / 1000.0);
+  }
+
+  auto* label = getCachedTextureForText(m_profilerLabel);
+  const auto labelSize = getTextureSize(label);
+  const auto labelRect =
+    SDL_Rect{ graph.x, graph.y - labelSize.y, labelSize.x, labelSize.y };
+  copyTexture(label, nullptr, &labelRect);
 }
 
 void
 Application::loadAssets(const std::string& assetDirectory)
 {
+  clearSprites();
+
   for (auto const& dir_entry :
        std::filesystem::directory_iterator{ assetDirectory }) {
     if (!dir_entry.is_regular_file()) {
@@ -92,23 +309,282 @@ Application::loadAssets(const std::string& assetDirectory)
     }
 
     if (dir_entry.path().extension() == ".png") {
-      loadTexture(dir_entry.path().string());
+      const auto path = dir_entry.path().string();
+      SDL_Log("Loading image: %s", path.c_str());
+
+      addSprite(dir_entry.path().stem().string(),
+                utils::make_raii_deleter<SDL_Surface>(
+                  utils::throw_if_null(
+                    IMG_Load(path.c_str()),
+                    std::string("Failed to load image: ") + path),
+                  [](SDL_Surface* surface) { SDL_FreeSurface(surface); }));
     }
   }
+
+  createAtlas();
+}
+
+void
+Application::loadBakedAssets()
+{
+#ifdef ARKANOID_EMBED_ASSETS
+  const auto& atlas = baked_assets::atlas;
+
+  // pixels are already in renderer's format, upload them as they are
+  const auto atlasImage = utils::make_raii_deleter<SDL_Surface>(
+    utils::throw_if_null(
+      SDL_CreateRGBSurfaceWithFormatFrom(
+        const_cast<std::uint32_t*>(atlas.pixels.data()),
+        atlas.width,
+        atlas.height,
+        32,
+        atlas.width * sizeof(std::uint32_t),
+        atlas.format),
+      "Failed to create atlas surface"),
+    [](SDL_Surface* surface) { SDL_FreeSurface(surface); });
+  m_atlas = makeTexture(atlasImage.get(), "Failed to create atlas texture");
+
+  // keep views of baked pixels as sources, atlas is repacked from them
+  // when a reloaded sprite changes its size (note: pixels are never written)
+  clearSprites();
+  for (const auto& sprite : atlas.sprites) {
+    const auto* pixels =
+      atlas.pixels.data() + sprite.rect.y * atlas.width + sprite.rect.x;
+    const auto handle = addSprite(
+      sprite.name,
+      utils::make_raii_deleter<SDL_Surface>(
+        utils::throw_if_null(SDL_CreateRGBSurfaceWithFormatFrom(
+                               const_cast<std::uint32_t*>(pixels),
+                               sprite.rect.w,
+                               sprite.rect.h,
+                               32,
+                               atlas.width * sizeof(std::uint32_t),
+                               atlas.format),
+                             "Failed to create sprite surface"),
+        [](SDL_Surface* surface) { SDL_FreeSurface(surface); }));
+    m_spriteTable[handle.index] = Sprite{ m_atlas.get(), sprite.rect };
+  }
+#else
+  throw std::runtime_error("Assets were not embedded into this build");
+#endif
+}
+
+void
+Application::watchAssets(const std::string& assetDirectory)
+{
+  if (!AssetWatcher::isSupported()) {
+    SDL_Log("Hot-reload of assets is not supported on this platform");
+    return;
+  }
+
+  // wake up idle loop to apply reloaded images
+  const auto wakeUpEvent = SDL_RegisterEvents(1);
+  m_assetWatcher =
+    std::make_unique<AssetWatcher>(assetDirectory, [wakeUpEvent]() {
+      SDL_Event event{};
+      event.type = wakeUpEvent;
+      SDL_PushEvent(&event);
+    });
+  SDL_Log("Watching assets: %s", assetDirectory.c_str());
+}
+
+void
+Application::applyReloadedAssets()
+{
+  if (!m_assetWatcher) {
+    return;
+  }
+
+  auto reloadedImages = m_assetWatcher->takeReloaded();
+  if (reloadedImages.empty()) {
+    return;
+  }
+
+  // note: scaled sprites are rebuilt from the new images
+  m_scaledSprites.clear();
+
+  bool hasChangedSize = false;
+  for (auto& reloaded : reloadedImages) {
+    const auto handle = findSprite(reloaded.name);
+    if (!handle.isValid()) {
+      SDL_Log("Ignoring new sprite (needs restart): %s", reloaded.name.c_str());
+      continue;
+    }
+
+    const auto& rect = m_spriteTable[handle.index].source;
+    m_spriteImages[handle.index] = reloaded.image;
+    if (rect.w != reloaded.image->w || rect.h != reloaded.image->h) {
+      hasChangedSize = true;
+      continue;
+    }
+
+    // same size: overwrite sprite's pixels in place
+    m_backend->updateTexture(m_atlas.get(), rect, reloaded.image.get());
+  }
+
+  if (hasChangedSize) {
+    createAtlas();
+  }
+}
+
+SpriteHandle
+Application::findSprite(const std::string& name) const
+{
+  const auto it = m_spriteHandles.find(name);
+  if (it == m_spriteHandles.end()) {
+    SDL_Log("Missing sprite: %s", name.c_str());
+    return SpriteHandle{};
+  }
+
+  return it->second;
+}
+
+const Sprite&
+Application::getSprite(SpriteHandle handle) const
+{
+  static const Sprite missingSprite;
+  if (!handle.isValid()) {
+    return missingSprite;
+  }
+
+  assert(handle.index < m_spriteTable.size());
+  return m_spriteTable[handle.index];
+}
+
+Sprite
+Application::getScaledSprite(SpriteHandle handle, SDL_Point size)
+{
+  const auto& sprite = getSprite(handle);
+  if (!handle.isValid() || size.x <= 0 || size.y <= 0 ||
+      (sprite.source.w == size.x && sprite.source.h == size.y)) {
+    return sprite;
+  }
+
+  if (const auto* rect = m_scaledSprites.find(handle, size)) {
+    return Sprite{ m_scaledAtlas.get(), *rect };
+  }
+
+  // note: without space (or too large for atlas) renderer scales the sprite
+  const auto rect = m_scaledSprites.insert(handle, size);
+  if (!rect) {
+    return sprite;
+  }
+
+  if (!m_scaledAtlas) {
+    const auto atlasSize = m_scaledSprites.getAtlasSize();
+    const auto blank = utils::make_raii_deleter<SDL_Surface>(
+      utils::throw_if_null(
+        SDL_CreateRGBSurfaceWithFormat(
+          0, atlasSize.x, atlasSize.y, 32, SDL_PIXELFORMAT_ARGB8888),
+        "Failed to create surface of scaled sprites"),
+      [](SDL_Surface* surface) { SDL_FreeSurface(surface); });
+    m_scaledAtlas =
+      makeTexture(blank.get(), "Failed to create atlas of scaled sprites");
+  }
+
+  const auto image =
+    resample::scaleAreaAverage(m_spriteImages[handle.index].get(), size);
+  m_backend->updateTexture(m_scaledAtlas.get(), *rect, image.get());
+  return Sprite{ m_scaledAtlas.get(), *rect };
+}
+
+void
+Application::clearSprites()
+{
+  m_spriteHandles.clear();
+  m_spriteTable.clear();
+  m_spriteImages.clear();
+  m_scaledSprites.clear();
+}
+
+SpriteHandle
+Application::addSprite(const std::string& name,
+                       utils::RaiiOwnership<SDL_Surface> image)
+{
+  const auto handle =
+    SpriteHandle{ static_cast<std::uint32_t>(m_spriteTable.size()) };
+  m_spriteHandles[name] = handle;
+  m_spriteTable.push_back(Sprite{});
+  m_spriteImages.push_back(std::move(image));
+  return handle;
+}
+
+void
+Application::createAtlas()
+{
+  const auto& images = m_spriteImages;
+
+  // note: some renderers report no limit
+  const auto limit = m_backend->getMaxTextureSize();
+  const auto maxSize =
+    SDL_Point{ limit.x > 0 ? limit.x : maxAtlasSize,
+               limit.y > 0 ? limit.y : maxAtlasSize };
+
+  std::vector<SDL_Point> sizes;
+  for (const auto& image : images) {
+    sizes.push_back(SDL_Point{ image->w, image->h });
+  }
+  const auto layout = atlas::pack(sizes, maxSize);
+
+  utils::RaiiOwnership<SDL_Surface> atlasSurface =
+    utils::make_raii_deleter<SDL_Surface>(
+      utils::throw_if_null(
+        SDL_CreateRGBSurfaceWithFormat(
+          0, layout.size.x, layout.size.y, 32, SDL_PIXELFORMAT_RGBA32),
+        "Failed to create atlas surface"),
+      [](SDL_Surface* surface) { SDL_FreeSurface(surface); });
+
+  for (std::size_t i = 0; i < images.size(); i++) {
+    // copy pixels including alpha, do not blend them
+    auto rect = layout.rects[i];
+    SDL_SetSurfaceBlendMode(images[i].get(), SDL_BLENDMODE_NONE);
+    SDL_BlitSurface(images[i].get(), nullptr, atlasSurface.get(), &rect);
+  }
+
+  m_atlas = makeTexture(atlasSurface.get(), "Failed to create atlas texture");
+
+  // note: handles stay valid, only their rectangles are updated
+  for (std::size_t i = 0; i < images.size(); i++) {
+    m_spriteTable[i] = Sprite{ m_atlas.get(), layout.rects[i] };
+  }
+
+  SDL_Log("Created %dx%d atlas with %d sprites",
+          layout.size.x,
+          layout.size.y,
+          static_cast<int>(images.size()));
 }
 
-SDL_Texture*
+Texture*
 Application::getCachedTextureForText(const std::string& textureText)
 {
-  // create and cache texture for given text
-  if (!m_textManager.hasTexture(textureText)) {
-    m_textManager.addTexture(textureText,
-                             createTextureFromText(m_textManager.getFont(),
-                                                   textureText,
-                                                   Color::black));
+  if (auto* texture = m_textureCache.find(textureText)) {
+    return texture;
   }
 
-  return m_textManager.getTexture(textureText);
+  // create and cache texture for given text
+  auto texture =
+    createTextureFromText(m_textManager.getFont(), textureText, Color::black);
+  const auto size = m_backend->getTextureSize(texture.get());
+  const auto bytes = static_cast<std::size_t>(size.x) * size.y * 4;
+  return m_textureCache.insert(textureText, std::move(texture), bytes);
+}
+
+void
+Application::setTextureBudget(std::size_t budgetBytes)
+{
+  m_textureCache.setBudget(budgetBytes);
+}
+
+const TextureCacheStats&
+Application::getTextureCacheStats() const
+{
+  return m_textureCache.getStats();
+}
+
+SDL_Point
+Application::getTextureSize(Texture* texture) const
+{
+  return m_backend->getTextureSize(texture);
 }
 
 bool
@@ -117,6 +593,72 @@ Application::isStopped() const
   return m_isStopped;
 }
 
+void
+Application::setViewport(const SDL_Rect* viewport)
+{
+  m_backend->setViewport(viewport);
+  m_viewportSize = viewport ? SDL_Point{ viewport->w, viewport->h }
+                            : getWindowSize();
+}
+
+void
+Application::fillRect(const SDL_Rect& rect,
+                      SDL_Color color,
+                      SDL_BlendMode blendMode)
+{
+  m_backend->fillRect(rect, color, blendMode);
+  countDrawCall(&rect);
+}
+
+void
+Application::copyTexture(Texture* texture,
+                         const SDL_Rect* source,
+                         const SDL_Rect* destination)
+{
+  m_backend->copy(texture, source, destination);
+  countDrawCall(destination);
+}
+
+void
+Application::copySprite(const Sprite& sprite, const SDL_Rect& destination)
+{
+  copyTexture(sprite.texture, &sprite.source, &destination);
+}
+
+const RenderStats&
+Application::getRenderStats() const
+{
+  return m_renderStats;
+}
+
+void
+Application::resetRenderStats()
+{
+  m_renderStats = RenderStats{};
+}
+
+Profiler&
+Application::getProfiler()
+{
+  return m_profiler;
+}
+
+void
+Application::countDrawCall(const SDL_Rect* destination)
+{
+  // destination is relative to viewport, whole viewport if not given
+  const auto viewport = SDL_Rect{ 0, 0, m_viewportSize.x, m_viewportSize.y };
+  SDL_Rect written = viewport;
+  if (destination != nullptr &&
+      !SDL_IntersectRect(destination, &viewport, &written)) {
+    written = SDL_Rect{ 0, 0, 0, 0 };
+  }
+
+  m_renderStats.drawCalls++;
+  m_renderStats.filledPixels +=
+    static_cast<std::uint64_t>(written.w) * written.h;
+}
+
 void
 Application::initializeSDL()
 {
@@ -136,7 +678,7 @@ Application::initializeSDL()
 }
 
 void
-Application::initializeWindowAndRenderer()
+Application::initializeWindowAndRenderer(bool isHeadless)
 {
   m_window = utils::make_raii_deleter<SDL_Window>(
     SDL_CreateWindow("Arkanoid",
@@ -144,30 +686,36 @@ Application::initializeWindowAndRenderer()
                      SDL_WINDOWPOS_UNDEFINED,
                      Constants::screenWidth,
                      Constants::screenHeight,
-                     SDL_WINDOW_SHOWN),
+                     isHeadless ? SDL_WINDOW_HIDDEN
+                                : SDL_WINDOW_SHOWN | SDL_WINDOW_RESIZABLE |
+                                    SDL_WINDOW_ALLOW_HIGHDPI),
     [](SDL_Window* window) -> void { SDL_DestroyWindow(window); });
 
   utils::throw_if_null(m_window.get(), "Failed to initialize SDL Window");
 
-  m_renderer = utils::make_raii_deleter<SDL_Renderer>(
-    utils::throw_if_null(
-      SDL_CreateRenderer(m_window.get(),
-                         -1,
-                         SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC),
-      "Failed to initialize renderer"),
-    [](SDL_Renderer* renderer) { SDL_DestroyRenderer(renderer); });
+  m_backend = createRenderBackend(m_backendType, m_window.get(), isHeadless);
+
+  SDL_SetWindowMinimumSize(
+    m_window.get(), Constants::screenWidth, Constants::screenHeight);
+
+  logOutputSize();
+}
+
+void
+Application::logOutputSize() const
+{
+  const auto outputSize = m_backend->getOutputSize();
+  SDL_Log("Render output size: %dx%d", outputSize.x, outputSize.y);
 }
 
 //! Adapted from: https://lazyfoo.net/tutorials/SDL/16_true_type_fonts/index.php
-SDL_Texture*
+utils::RaiiOwnership<Texture>
 Application::createTextureFromText(TTF_Font* font,
                                    const std::string& textureText,
                                    SDL_Color textColor)
 {
   assert(font != nullptr);
 
-  SDL_Texture* texture = nullptr;
-
   // Render text surface
   utils::RaiiOwnership<SDL_Surface> textSurface =
     utils::make_raii_deleter<SDL_Surface>(
@@ -177,31 +725,58 @@ Application::createTextureFromText(TTF_Font* font,
       [](SDL_Surface* surface) { SDL_FreeSurface(surface); });
 
   // Create texture from surface pixels
-  texture = utils::throw_if_null(
-    SDL_CreateTextureFromSurface(m_renderer.get(), textSurface.get()),
-    "Unable to create texture from rendered text!");
-
-  return texture;
+  return makeTexture(textSurface.get(),
+                     "Unable to create texture from rendered text!");
 }
 
 SDL_Point
-Application::getWindowSize()
+Application::getWindowSize() const
+{
+  return SDL_Point{ Constants::screenWidth, Constants::screenHeight };
+}
+
+void
+Application::startRecording(const std::string& directory)
 {
-  SDL_Surface* surface =
-    utils::throw_if_null(SDL_GetWindowSurface(m_window.get()),
-                         "Failed to obtain SDL's window surface");
-  return SDL_Point(surface->w, surface->h);
+  m_recorder = std::make_unique<FrameRecorder>(directory, getWindowSize());
+  SDL_Log("Recording frames into: %s", directory.c_str());
 }
 
-SDL_Texture*
-Application::getTexture(const std::string& name)
+void
+Application::stopRecording()
+{
+  if (!m_recorder) {
+    return;
+  }
+
+  // note: waits until queued frames are written
+  m_recorder->finish();
+
+  const auto stats = m_recorder->getStats();
+  SDL_Log("Recorded %llu frames (%llu dropped, %llu KiB) into: %s",
+          static_cast<unsigned long long>(stats.writtenFrames),
+          static_cast<unsigned long long>(stats.droppedFrames),
+          static_cast<unsigned long long>(stats.writtenBytes / 1024),
+          m_recorder->getDirectory().c_str());
+  m_recorder.reset();
+}
+
+bool
+Application::isRecording() const
+{
+  return m_recorder != nullptr;
+}
+
+bool
+Application::readPixels(SDL_Surface* target)
 {
-  assert(m_textures.count(name));
-  return m_textures[name];
+  return m_backend->readPixels(target);
 }
 
-SDL_Renderer*
-Application::getRenderer() const
+utils::RaiiOwnership<Texture>
+Application::makeTexture(SDL_Surface* image, const std::string& errorMessage)
 {
-  return utils::throw_if_null(m_renderer.get(), "renderer is nullptr");
+  return utils::make_raii_deleter<Texture>(
+    utils::throw_if_null(m_backend->createTexture(image), errorMessage),
+    [this](Texture* texture) { m_backend->destroyTexture(texture); });
 }
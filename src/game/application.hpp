@@ -2,34 +2,128 @@
 
 #include <SDL.h>
 #include <SDL_ttf.h>
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <memory>
+#include <optional>
+#include <unordered_map>
 #include <vector>
 
+#include "asset_watcher.hpp"
+#include "atlas.hpp"
+#include "constants.hpp"
+#include "frame_recorder.hpp"
+#include "profiler.hpp"
+#include "render_backend.hpp"
+#include "scaled_sprite_cache.hpp"
 #include "text_manager.hpp"
+#include "texture_cache.hpp"
 #include "utils.hpp"
 
+//! Work done by renderer since the last reset
+struct RenderStats
+{
+  //! Count of fill & copy calls
+  unsigned drawCalls{ 0 };
+
+  //! Count of written pixels (after clipping against viewport)
+  std::uint64_t filledPixels{ 0 };
+};
+
 struct Application
 {
 
 public:
+  ~Application();
+
+  //! Choose backend used for rendering (before application is created)
+  void setRenderBackend(RenderBackendType type);
+
   void createApplication();
+
+  //! Create application without visible window, using SDL's offscreen video
+  //! driver and software rendering (for machines without display and GPU)
+  void createHeadlessApplication();
+
   void runLoop();
 
-  void loadTexture(const std::string& name);
+  //! Render single frame: clear, call render callback and present
+  void renderFrame();
+
+  //! Load all PNG images of directory as sprites of single atlas texture
   void loadAssets(const std::string& assetDirectory);
 
-  SDL_Renderer* getRenderer() const;
+  //! Upload atlas baked into executable (see ARKANOID_EMBED_ASSETS)
+  void loadBakedAssets();
+
+  //! Reload images of directory whenever they change (between frames)
+  void watchAssets(const std::string& assetDirectory);
+
+  //! Record each rendered frame into directory (see FrameRecorder)
+  void startRecording(const std::string& directory);
+
+  void stopRecording();
+
+  bool isRecording() const;
 
-  //! Helper: get pixel size of app's window
-  SDL_Point getWindowSize();
+  //! Read pixels drawn so far in this frame into ARGB8888 surface of
+  //! logical size (see getWindowSize), returns false on failure
+  bool readPixels(SDL_Surface* target);
 
-  SDL_Texture* getTexture(const std::string& name);
+  //! Size of render target in logical pixels (independent of window's size
+  //! and DPI, renderer scales it to window with letterboxing)
+  SDL_Point getWindowSize() const;
+
+  //! Find sprite by its name (file name without extension), intended to be
+  //! called once at load time. Returns invalid handle if it's missing.
+  SpriteHandle findSprite(const std::string& name) const;
+
+  //! Get sprite by handle (empty sprite for invalid handle)
+  const Sprite& getSprite(SpriteHandle handle) const;
+
+  //! Get sprite pre-scaled to given size (built on first use into atlas of
+  //! scaled sprites), so that drawing it is 1:1 copy. Valid until the end of
+  //! frame.
+  Sprite getScaledSprite(SpriteHandle handle, SDL_Point size);
 
   //! Given text to be render, internally obtain a texture with rendered text
-  SDL_Texture* getCachedTextureForText(const std::string& textureText);
+  //! (valid until the end of current frame)
+  Texture* getCachedTextureForText(const std::string& textureText);
+
+  //! Limit memory held by cached textures of texts (in bytes)
+  void setTextureBudget(std::size_t budgetBytes);
+
+  const TextureCacheStats& getTextureCacheStats() const;
+
+  SDL_Point getTextureSize(Texture* texture) const;
 
   bool isStopped() const;
 
+  //! Restrict drawing to rectangle (whole target if null), following draws
+  //! are relative to it
+  void setViewport(const SDL_Rect* viewport);
+
+  //! Draw rectangle filled by color (coordinates relative to viewport)
+  void fillRect(const SDL_Rect& rect,
+                SDL_Color color,
+                SDL_BlendMode blendMode = SDL_BLENDMODE_NONE);
+
+  //! Copy part of texture (whole if source is null) to destination (whole
+  //! viewport if null)
+  void copyTexture(Texture* texture,
+                   const SDL_Rect* source,
+                   const SDL_Rect* destination);
+
+  //! Draw sprite to destination rectangle
+  void copySprite(const Sprite& sprite, const SDL_Rect& destination);
+
+  const RenderStats& getRenderStats() const;
+  void resetRenderStats();
+
+  //! Phase timers of frames (see ProfileScope)
+  Profiler& getProfiler();
+
 public:
   //! Called when event arises in SDL polling mechanism
   std::function<void(const SDL_Event&)> onSDLEventCallback;
@@ -40,14 +134,53 @@ public:
   //! Call each frame after clear and before swap (present)
   std::function<void()> onRenderCallback;
 
+  //! Time until rendered scene changes without input: zero if it is animated,
+  //! none if it is static. Loop does not render identical frames, it waits
+  //! for input instead (rendering continuously if not set).
+  std::function<std::optional<std::chrono::microseconds>()>
+    getTimeUntilChangeCallback;
+
 protected:
   void initializeSDL();
 
-  void initializeWindowAndRenderer();
+  void initializeWindowAndRenderer(bool isHeadless);
+
+  //! Draw graph of the latest frames' phases (toggled by F3)
+  void renderProfilerOverlay();
+
+  //! Process event of SDL, returns true if application should quit
+  bool handleEvent(const SDL_Event& e);
+
+  //! Time to wait for input before next frame in ms (0 when scene changes
+  //! continuously, -1 to wait for input only)
+  int getIdleTimeout() const;
+
+  //! Log size of window's drawable area (once window is created or resized)
+  void logOutputSize() const;
+
+  //! Count draw call writing given rectangle
+  void countDrawCall(const SDL_Rect* destination);
 
-  SDL_Texture* createTextureFromText(TTF_Font* font,
-                                     const std::string& textureText,
-                                     SDL_Color textColor);
+  void clearSprites();
+
+  //! Register sprite with its source image (packed by createAtlas)
+  SpriteHandle addSprite(const std::string& name,
+                         utils::RaiiOwnership<SDL_Surface> image);
+
+  //! Pack images of all sprites into atlas texture
+  void createAtlas();
+
+  //! Swap images reloaded by asset watcher into atlas
+  void applyReloadedAssets();
+
+  //! Create texture owned by backend (throws errorMessage on failure)
+  utils::RaiiOwnership<Texture> makeTexture(SDL_Surface* image,
+                                            const std::string& errorMessage);
+
+  utils::RaiiOwnership<Texture> createTextureFromText(
+    TTF_Font* font,
+    const std::string& textureText,
+    SDL_Color textColor);
 
 private:
   //! Handle to SDL (to deinitialize on destructor)
@@ -56,13 +189,56 @@ private:
   //! Handle to application window
   utils::RaiiOwnership<SDL_Window> m_window;
 
-  //! Handle to SDL's 2D renderer
-  utils::RaiiOwnership<SDL_Renderer> m_renderer;
+  RenderBackendType m_backendType = { RenderBackendType::sdl };
+
+  //! Draws into window, note: must outlive all textures
+  std::unique_ptr<RenderBackend> m_backend;
 
   TextManager m_textManager;
 
+  //! Textures of rendered texts (least recently used are evicted over
+  //! budget)
+  TextureCache m_textureCache{ Constants::textureCacheBudget };
+
   //! Is application (render) running?
   bool m_isStopped = { false };
 
-  std::unordered_map<std::string, SDL_Texture*> m_textures;
+  //! Is window minimized (nothing is rendered)?
+  bool m_isMinimized = { false };
+
+  //! Single texture with all sprites
+  utils::RaiiOwnership<Texture> m_atlas;
+
+  //! Sprite name => handle
+  std::unordered_map<std::string, SpriteHandle> m_spriteHandles;
+
+  //! Handle => sprite
+  std::vector<Sprite> m_spriteTable;
+
+  //! Handle => source image of sprite (to repack atlas)
+  std::vector<utils::RaiiOwnership<SDL_Surface>> m_spriteImages;
+
+  //! Sprites scaled at runtime share single texture, thus they are drawn
+  //! without switching textures
+  utils::RaiiOwnership<Texture> m_scaledAtlas;
+  ScaledSpriteCache m_scaledSprites{
+    { Constants::scaledSpriteAtlasSize, Constants::scaledSpriteAtlasSize }
+  };
+
+  //! Records frames (while recording)
+  std::unique_ptr<FrameRecorder> m_recorder;
+
+  //! Watches asset directory for changes (if enabled)
+  std::unique_ptr<AssetWatcher> m_assetWatcher;
+
+  RenderStats m_renderStats;
+
+  Profiler m_profiler;
+  bool m_isProfilerVisible = { false };
+
+  //! Percentiles shown by profiler's graph
+  std::string m_profilerLabel;
+
+  //! Size of current viewport (in logical pixels)
+  SDL_Point m_viewportSize{ Constants::screenWidth, Constants::screenHeight };
 };
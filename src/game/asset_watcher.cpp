@@ -0,0 +1,138 @@
+#include "asset_watcher.hpp"
+
+#include <SDL_image.h>
+#include <algorithm>
+#include <filesystem>
+#include <stdexcept>
+#include <utility>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace {
+//! How often does watcher check whether it should stop
+constexpr int stopCheckInterval = 100; // ms
+} // namespace
+
+AssetWatcher::AssetWatcher(const std::string& directory,
+                           std::function<void()> onReloaded)
+  : m_directory(directory)
+  , m_onReloaded(std::move(onReloaded))
+{
+#ifdef __linux__
+  m_inotify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (m_inotify < 0) {
+    throw std::runtime_error("Failed to initialize inotify");
+  }
+
+  // note: editors either rewrite file in place or move a new one over it
+  if (inotify_add_watch(
+        m_inotify, directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+    close(m_inotify);
+    throw std::runtime_error("Failed to watch directory: " + directory);
+  }
+
+  m_thread = std::thread([this]() { run(); });
+#else
+  throw std::runtime_error("Watching assets is not supported on platform");
+#endif
+}
+
+AssetWatcher::~AssetWatcher()
+{
+  m_isStopping = true;
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+
+#ifdef __linux__
+  close(m_inotify);
+#endif
+}
+
+std::vector<AssetWatcher::Image>
+AssetWatcher::takeReloaded()
+{
+  std::lock_guard lock(m_mutex);
+  return std::exchange(m_reloaded, {});
+}
+
+bool
+AssetWatcher::isSupported()
+{
+#ifdef __linux__
+  return true;
+#else
+  return false;
+#endif
+}
+
+void
+AssetWatcher::run()
+{
+#ifdef __linux__
+  alignas(inotify_event) char buffer[4096];
+
+  pollfd descriptor = { m_inotify, POLLIN, 0 };
+  while (!m_isStopping) {
+    if (poll(&descriptor, 1, stopCheckInterval) <= 0) {
+      continue;
+    }
+
+    const auto length = read(m_inotify, buffer, sizeof(buffer));
+    if (length <= 0) {
+      continue;
+    }
+
+    // note: one save may emit several events, decode each file once
+    std::vector<std::string> changedFiles;
+    for (ssize_t offset = 0; offset < length;) {
+      const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+      offset += sizeof(inotify_event) + event->len;
+
+      if (event->len == 0 ||
+          std::filesystem::path(event->name).extension() != ".png") {
+        continue;
+      }
+
+      if (std::find(changedFiles.begin(), changedFiles.end(), event->name) ==
+          changedFiles.end()) {
+        changedFiles.push_back(event->name);
+      }
+    }
+
+    for (const auto& fileName : changedFiles) {
+      reload(fileName);
+    }
+  }
+#endif
+}
+
+void
+AssetWatcher::reload(const std::string& fileName)
+{
+  const auto path = (std::filesystem::path(m_directory) / fileName).string();
+
+  auto* image = IMG_Load(path.c_str());
+  if (image == nullptr) {
+    // note: file may be still incomplete, the next write will retry
+    SDL_Log("Failed to reload image: %s", path.c_str());
+    return;
+  }
+  SDL_Log("Reloaded image: %s", path.c_str());
+
+  {
+    std::lock_guard lock(m_mutex);
+    m_reloaded.push_back(Image{
+      std::filesystem::path(fileName).stem().string(),
+      utils::make_raii_deleter<SDL_Surface>(
+        image, [](SDL_Surface* surface) { SDL_FreeSurface(surface); }) });
+  }
+
+  if (m_onReloaded) {
+    m_onReloaded();
+  }
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SDL.h>
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils.hpp"
+
+/**
+ * @brief Watches asset directory and decodes changed images in background
+ *
+ * Uses inotify (Linux only, see isSupported()). Decoded images are handed
+ * over by takeReloaded(), so that they can be swapped between frames.
+ */
+class AssetWatcher
+{
+public:
+  struct Image
+  {
+    //! File name without extension
+    std::string name;
+
+    utils::RaiiOwnership<SDL_Surface> image;
+  };
+
+  //! Throws std::runtime_error if directory can not be watched. Callback is
+  //! called by watcher's thread whenever images are reloaded.
+  AssetWatcher(const std::string& directory, std::function<void()> onReloaded);
+  ~AssetWatcher();
+
+  AssetWatcher(const AssetWatcher&) = delete;
+  AssetWatcher& operator=(const AssetWatcher&) = delete;
+
+  //! Take images decoded since the last call
+  std::vector<Image> takeReloaded();
+
+  static bool isSupported();
+
+protected:
+  void run();
+
+  //! Decode image of directory and queue it for takeReloaded()
+  void reload(const std::string& fileName);
+
+private:
+  std::string m_directory;
+
+  std::function<void()> m_onReloaded;
+
+  //! inotify instance watching the directory
+  int m_inotify = { -1 };
+
+  std::mutex m_mutex;
+  std::vector<Image> m_reloaded;
+  std::atomic<bool> m_isStopping = { false };
+
+  //! Note: must be the last member, it uses all the members above
+  std::thread m_thread;
+};
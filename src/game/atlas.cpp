@@ -0,0 +1,102 @@
+#include "atlas.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+namespace atlas {
+Layout
+pack(const std::vector<SDL_Point>& sizes, SDL_Point maxSize, int padding)
+{
+  Layout layout;
+  layout.rects.resize(sizes.size());
+
+  // aim for roughly square atlas, but fit the widest image
+  long long area = 0;
+  int widestImage = 0;
+  for (const auto& size : sizes) {
+    area += static_cast<long long>(size.x + padding) * (size.y + padding);
+    widestImage = std::max(widestImage, size.x + padding);
+  }
+  const auto width = std::min(
+    maxSize.x,
+    std::max(widestImage, static_cast<int>(std::ceil(std::sqrt(area)))));
+
+  // place the tallest images first, so that shelves waste less space
+  std::vector<std::size_t> order(sizes.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](auto a, auto b) {
+    return sizes[a].y > sizes[b].y;
+  });
+
+  SDL_Point cursor = { 0, 0 };
+  int shelfHeight = 0;
+  for (const auto index : order) {
+    const auto& size = sizes[index];
+    if (size.x + padding > width) {
+      throw std::runtime_error("Image is too wide for texture atlas");
+    }
+
+    // start a new shelf
+    if (cursor.x + size.x + padding > width) {
+      cursor.x = 0;
+      cursor.y += shelfHeight;
+      shelfHeight = 0;
+    }
+
+    layout.rects[index] = SDL_Rect{ cursor.x, cursor.y, size.x, size.y };
+    cursor.x += size.x + padding;
+    shelfHeight = std::max(shelfHeight, size.y + padding);
+  }
+
+  layout.size = SDL_Point{ width, cursor.y + shelfHeight };
+  if (layout.size.y > maxSize.y) {
+    throw std::runtime_error("Images do not fit into texture atlas");
+  }
+
+  return layout;
+}
+
+ShelfAllocator::ShelfAllocator(SDL_Point size, int padding)
+  : m_size(size)
+  , m_padding(padding)
+{
+}
+
+std::optional<SDL_Rect>
+ShelfAllocator::allocate(SDL_Point size)
+{
+  if (size.x + m_padding > m_size.x) {
+    return std::nullopt;
+  }
+
+  // start a new shelf
+  if (m_cursor.x + size.x + m_padding > m_size.x) {
+    m_cursor.x = 0;
+    m_cursor.y += m_shelfHeight;
+    m_shelfHeight = 0;
+  }
+  if (m_cursor.y + size.y + m_padding > m_size.y) {
+    return std::nullopt;
+  }
+
+  const auto rect = SDL_Rect{ m_cursor.x, m_cursor.y, size.x, size.y };
+  m_cursor.x += size.x + m_padding;
+  m_shelfHeight = std::max(m_shelfHeight, size.y + m_padding);
+  return rect;
+}
+
+void
+ShelfAllocator::clear()
+{
+  m_cursor = { 0, 0 };
+  m_shelfHeight = 0;
+}
+
+SDL_Point
+ShelfAllocator::getSize() const
+{
+  return m_size;
+}
+} // namespace atlas
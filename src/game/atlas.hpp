@@ -0,0 +1,75 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+//! Texture of render backend (see render_backend.hpp)
+struct Texture;
+
+//! Part of atlas texture with one sprite
+struct Sprite
+{
+  Texture* texture = { nullptr };
+  SDL_Rect source = { 0, 0, 0, 0 };
+};
+
+//! Index of sprite, resolved from name once (see Application::findSprite)
+struct SpriteHandle
+{
+  static constexpr std::uint32_t invalidIndex = ~0u;
+
+  std::uint32_t index = { invalidIndex };
+
+  bool isValid() const { return index != invalidIndex; }
+};
+
+namespace atlas {
+//! Placement of images within atlas
+struct Layout
+{
+  //! Size of whole atlas (in pixels)
+  SDL_Point size = { 0, 0 };
+
+  //! Placement of each image, in the order of input sizes
+  std::vector<SDL_Rect> rects;
+};
+
+/**
+ * @brief Pack images of given sizes into shelves (rows) of single atlas
+ *
+ * Images are separated by padding so that filtering does not bleed between
+ * neighbours. Throws std::runtime_error if atlas would exceed maxSize.
+ */
+Layout
+pack(const std::vector<SDL_Point>& sizes, SDL_Point maxSize, int padding = 1);
+
+/**
+ * @brief Places images one by one into shelves of atlas of fixed size
+ *
+ * For images not known up front (e.g. sprites scaled at runtime), thus
+ * placements are never moved, only freed all at once.
+ */
+class ShelfAllocator
+{
+public:
+  explicit ShelfAllocator(SDL_Point size, int padding = 1);
+
+  //! Place image of given size, std::nullopt if it does not fit anymore
+  std::optional<SDL_Rect> allocate(SDL_Point size);
+
+  //! Free all placements
+  void clear();
+
+  SDL_Point getSize() const;
+
+private:
+  SDL_Point m_size;
+  int m_padding;
+
+  //! Top-left corner of free space on current shelf
+  SDL_Point m_cursor = { 0, 0 };
+  int m_shelfHeight = { 0 };
+};
+} // namespace atlas
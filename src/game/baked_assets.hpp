@@ -0,0 +1,37 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <span>
+
+/**
+ * @brief Assets baked into executable by asset_baker at build time
+ *
+ * Sprites are already decoded and packed into atlas in the pixel format
+ * preferred by renderers, thus loading is a single texture upload.
+ * Only available when built with ARKANOID_EMBED_ASSETS.
+ */
+namespace baked_assets {
+struct Sprite
+{
+  const char* name;
+  SDL_Rect rect;
+};
+
+struct Atlas
+{
+  int width;
+  int height;
+
+  //! SDL pixel format of packed pixels (one 32-bit value per pixel)
+  std::uint32_t format;
+  std::span<const std::uint32_t> pixels;
+
+  std::span<const Sprite> sprites;
+};
+
+extern const Atlas atlas;
+
+//! TTF file of font
+extern const std::span<const std::uint8_t> font;
+} // namespace baked_assets
@@ -1,7 +1,7 @@
 #include "ball.hpp"
 
 SDL_FRect
-Ball::getBoundingRect()
+Ball::getBoundingRect() const
 {
   SDL_FRect ballBody;
   ballBody.x = position.x - radius;
@@ -12,7 +12,7 @@ Ball::getBoundingRect()
 }
 
 std::array<SDL_FPoint, 4>
-Ball::getBoundingRectCorners()
+Ball::getBoundingRectCorners() const
 {
   const auto b = getBoundingRect();
   return { SDL_FPoint{ b.x, b.y },   // top-left
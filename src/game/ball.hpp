@@ -12,7 +12,7 @@ struct Ball
   float radius = 50.0;         // world units
 
   //! Returns bounding box (rectangle)
-  SDL_FRect getBoundingRect();
+  SDL_FRect getBoundingRect() const;
 
   enum Corner
   {
@@ -23,7 +23,7 @@ struct Ball
   };
 
   //! Return bounding rectangle as an array of corners (2D points)
-  std::array<SDL_FPoint, 4> getBoundingRectCorners();
+  std::array<SDL_FPoint, 4> getBoundingRectCorners() const;
 
   //! Collision states that can happen between ball and rectangle (e.g. tile)
   enum class CollisionState
@@ -0,0 +1,66 @@
+#include "camera.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace {
+//! How fast camera catches up with the target (fraction per second)
+constexpr float followRate = 5.0f;
+} // namespace
+
+void
+Camera::moveTo(SDL_FPoint target, SDL_FPoint worldSize)
+{
+  view.x = target.x - view.w * 0.5f;
+  view.y = target.y - view.h * 0.5f;
+  clampToWorld(worldSize);
+}
+
+void
+Camera::follow(SDL_FPoint target, SDL_FPoint worldSize, float elapsedSeconds)
+{
+  const auto ratio = std::min(1.0f, followRate * elapsedSeconds);
+
+  view.x += (target.x - view.w * 0.5f - view.x) * ratio;
+  view.y += (target.y - view.h * 0.5f - view.y) * ratio;
+  clampToWorld(worldSize);
+}
+
+void
+Camera::keepInView(SDL_FRect body, SDL_FPoint worldSize)
+{
+  // note: body larger than view keeps its top-left corner visible
+  view.x = std::clamp(
+    view.x, std::min(body.x, body.x + body.w - view.w), body.x);
+  view.y = std::clamp(
+    view.y, std::min(body.y, body.y + body.h - view.h), body.y);
+  clampToWorld(worldSize);
+}
+
+ViewTransform
+Camera::getViewTransform(SDL_Point viewportSize) const
+{
+  return ViewTransform{
+    .origin = { view.x, view.y },
+    .scale = { static_cast<float>(viewportSize.x) / view.w,
+               static_cast<float>(viewportSize.y) / view.h },
+  };
+}
+
+void
+Camera::clampToWorld(SDL_FPoint worldSize)
+{
+  view.x = std::clamp(view.x, 0.0f, std::max(0.0f, worldSize.x - view.w));
+  view.y = std::clamp(view.y, 0.0f, std::max(0.0f, worldSize.y - view.h));
+}
+
+SDL_Rect
+ViewTransform::toView(SDL_FRect units) const
+{
+  return SDL_Rect{
+    static_cast<int>(std::roundf((units.x - origin.x) * scale.x)),
+    static_cast<int>(std::roundf((units.y - origin.y) * scale.y)),
+    static_cast<int>(std::roundf(units.w * scale.x)),
+    static_cast<int>(std::roundf(units.h * scale.y)),
+  };
+}
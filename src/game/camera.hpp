@@ -0,0 +1,43 @@
+#pragma once
+
+#include <SDL.h>
+
+/**
+ * @brief Mapping of world units to pixels of viewport (computed once a frame)
+ */
+struct ViewTransform
+{
+  //! World position shown at top-left corner of viewport
+  SDL_FPoint origin = { 0, 0 };
+
+  //! Pixels per world unit
+  SDL_FPoint scale = { 1, 1 };
+
+  //! Convert rectangle in world units to viewport pixels
+  SDL_Rect toView(SDL_FRect units) const;
+};
+
+/**
+ * @brief Visible window of the world, following a target
+ */
+struct Camera
+{
+  //! Visible part of the world (in world units)
+  SDL_FRect view = { 0, 0, 0, 0 };
+
+  //! Center view on target immediately
+  void moveTo(SDL_FPoint target, SDL_FPoint worldSize);
+
+  //! Smoothly move view towards target, keeping it within world
+  void follow(SDL_FPoint target, SDL_FPoint worldSize, float elapsedSeconds);
+
+  //! Move view the least to contain body (if it fits), keeping it within
+  //! world
+  void keepInView(SDL_FRect body, SDL_FPoint worldSize);
+
+  //! Transform of current view into viewport of given size (in pixels)
+  ViewTransform getViewTransform(SDL_Point viewportSize) const;
+
+protected:
+  void clampToWorld(SDL_FPoint worldSize);
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+
+#include "level_dsl.hpp"
+
+//! Built-in levels, played before random ones
+namespace campaign {
+inline constexpr auto wall = level::parseLevel(
+  "RRRRRRRRRR",
+  "GGGGGGGGGG",
+  "BBBBBBBBBB",
+  "..........",
+  "HHHHSHHHHH");
+
+inline constexpr auto pyramid = level::parseLevel(
+  "....RR....",
+  "...RRRR...",
+  "..GGGGGG..",
+  ".GGGPSGGG.",
+  "BBBBBBBBBB",
+  "B.B.B.B.B.");
+
+inline constexpr auto fortress = level::parseLevel(
+  "H.HHHHHH.H",
+  "H.RRRRRR.H",
+  "H.RGGGGR.H",
+  "H.RGSPGR.H",
+  "H.RGGGGR.H",
+  "H.RRRRRR.H",
+  "HHHH..HHHH");
+
+inline constexpr std::array<level::LevelView, 3> levels = {
+  wall.getView(),
+  pyramid.getView(),
+  fortress.getView(),
+};
+} // namespace campaign
@@ -0,0 +1,181 @@
+#include "collision_spans.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+void
+CollisionSpans::rebuild(const std::vector<Tile>& tiles,
+                        SDL_Rect cells,
+                        SDL_FPoint tileSize)
+{
+  m_origin = SDL_Point{ cells.x, cells.y };
+  m_columns = cells.w;
+  m_rows = cells.h;
+  m_tileSize = tileSize;
+
+  m_cells.assign(m_columns * m_rows, invalidEntityID);
+  m_rowSpans.assign(m_rows, {});
+  m_columnSpans.assign(m_columns, {});
+
+  for (const auto& tile : tiles) {
+    if (SDL_PointInRect(&tile.cell, &cells)) {
+      cellAt(tile.cell.x - m_origin.x, tile.cell.y - m_origin.y) = tile.id;
+    }
+  }
+
+  for (int row = 0; row < m_rows; row++) {
+    mergeRow(row);
+  }
+  for (int column = 0; column < m_columns; column++) {
+    mergeColumn(column);
+  }
+}
+
+void
+CollisionSpans::removeTile(const Tile& tile)
+{
+  const auto column = tile.cell.x - m_origin.x;
+  const auto row = tile.cell.y - m_origin.y;
+  if (column < 0 || column >= m_columns || row < 0 || row >= m_rows) {
+    return;
+  }
+
+  auto& cell = cellAt(column, row);
+  if (cell != tile.id) {
+    return;
+  }
+
+  cell = invalidEntityID;
+  mergeRow(row);
+  mergeColumn(column);
+}
+
+EntityID
+CollisionSpans::getTileHitBySpan(const Span& span, SDL_FRect body) const
+{
+  // the tile below center of the body has the largest overlap with it
+  if (span.isColumn) {
+    const auto center = body.y + body.h * 0.5f;
+    const auto row =
+      static_cast<int>(std::floor(center / m_tileSize.y)) - m_origin.y;
+    return cellAt(span.line, std::clamp(row, span.first, span.last));
+  }
+
+  const auto center = body.x + body.w * 0.5f;
+  const auto column =
+    static_cast<int>(std::floor(center / m_tileSize.x)) - m_origin.x;
+  return cellAt(std::clamp(column, span.first, span.last), span.line);
+}
+
+std::size_t
+CollisionSpans::getSpanCount() const
+{
+  std::size_t count = 0;
+  for (const auto& row : m_rowSpans) {
+    count += row.size();
+  }
+  for (const auto& column : m_columnSpans) {
+    count += column.size();
+  }
+  return count;
+}
+
+void
+CollisionSpans::mergeRow(int row)
+{
+  auto& spans = m_rowSpans[row];
+  spans.clear();
+
+  int column = 0;
+  while (column < m_columns) {
+    if (cellAt(column, row) == invalidEntityID) {
+      column++;
+      continue;
+    }
+
+    // greedily extend the run while neighbouring cells are alive
+    const auto firstColumn = column;
+    while (column < m_columns && cellAt(column, row) != invalidEntityID) {
+      column++;
+    }
+    const auto lastColumn = column - 1;
+
+    Span span;
+    span.isColumn = false;
+    span.line = row;
+    span.first = firstColumn;
+    span.last = lastColumn;
+    span.body.x = (m_origin.x + firstColumn) * m_tileSize.x;
+    span.body.y = (m_origin.y + row) * m_tileSize.y;
+    span.body.w = (lastColumn - firstColumn + 1) * m_tileSize.x;
+    span.body.h = m_tileSize.y;
+    spans.push_back(span);
+  }
+}
+
+void
+CollisionSpans::mergeColumn(int column)
+{
+  auto& spans = m_columnSpans[column];
+  spans.clear();
+
+  int row = 0;
+  while (row < m_rows) {
+    if (cellAt(column, row) == invalidEntityID) {
+      row++;
+      continue;
+    }
+
+    const auto firstRow = row;
+    while (row < m_rows && cellAt(column, row) != invalidEntityID) {
+      row++;
+    }
+    const auto lastRow = row - 1;
+
+    Span span;
+    span.isColumn = true;
+    span.line = column;
+    span.first = firstRow;
+    span.last = lastRow;
+    span.body.x = (m_origin.x + column) * m_tileSize.x;
+    span.body.y = (m_origin.y + firstRow) * m_tileSize.y;
+    span.body.w = m_tileSize.x;
+    span.body.h = (lastRow - firstRow + 1) * m_tileSize.y;
+    spans.push_back(span);
+  }
+}
+
+const CollisionSpans::Span&
+CollisionSpans::selectContact(const Span& rowSpan, SDL_FPoint center) const
+{
+  // center above (or below) the run: its top (or bottom) face is hit
+  if (center.x >= rowSpan.body.x &&
+      center.x <= rowSpan.body.x + rowSpan.body.w) {
+    return rowSpan;
+  }
+
+  // beyond the end of run: side of its end tile, which is flat along the
+  // column span of that tile when center is next to that span
+  const auto column =
+    center.x < rowSpan.body.x ? rowSpan.first : rowSpan.last;
+  for (const auto& span : m_columnSpans[column]) {
+    if (span.first <= rowSpan.line && rowSpan.line <= span.last) {
+      const bool isNextToSpan = center.y >= span.body.y &&
+                                center.y <= span.body.y + span.body.h;
+      return isNextToSpan ? span : rowSpan;
+    }
+  }
+  return rowSpan;
+}
+
+EntityID&
+CollisionSpans::cellAt(int column, int row)
+{
+  return m_cells[row * m_columns + column];
+}
+
+EntityID
+CollisionSpans::cellAt(int column, int row) const
+{
+  return m_cells[row * m_columns + column];
+}
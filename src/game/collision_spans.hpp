@@ -0,0 +1,126 @@
+#pragma once
+
+#include <SDL.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <vector>
+
+#include "entities.hpp"
+
+/**
+ * @brief Derived collision layer: runs of adjacent live tiles within a grid
+ * row (and within a grid column) are greedily merged into a single
+ * axis-aligned span
+ *
+ * Ball is tested against spans instead of individual tiles, thus hitting the
+ * seam between two neighbouring tiles is resolved as a hit of one flat
+ * surface. The axis is picked per contact: row span, unless the ball is
+ * beyond its end and faces the side of the column span of the end tile
+ * (e.g. the side of a vertical stack of tiles).
+ */
+class CollisionSpans
+{
+public:
+  struct Span
+  {
+    //! Merged body of the run (in world units)
+    SDL_FRect body;
+
+    //! Run goes along a column (otherwise along a row)
+    bool isColumn;
+
+    //! Row (or column) of the run (relative to covered region)
+    int line;
+
+    //! First and last cell along the run (inclusive, relative)
+    int first;
+    int last;
+  };
+
+  //! Cover given region of tile grid, fill it with tiles and merge all rows
+  //! & columns
+  //! Note: tiles outside the region are ignored
+  void rebuild(const std::vector<Tile>& tiles,
+               SDL_Rect cells,
+               SDL_FPoint tileSize);
+
+  //! Remove tile from grid and re-merge its row & column only
+  void removeTile(const Tile& tile);
+
+  //! Call fn(const Span&) once for each surface touched by given rect
+  template<typename Fn>
+  void forEachContact(SDL_FRect rect, Fn fn) const;
+
+  //! Returns ID of the exact tile within span that was hit by given body
+  EntityID getTileHitBySpan(const Span& span, SDL_FRect body) const;
+
+  //! Total count of row & column spans (for diagnostics)
+  std::size_t getSpanCount() const;
+
+protected:
+  void mergeRow(int row);
+  void mergeColumn(int column);
+
+  //! Surface hit by rect whose center is at given point
+  const Span& selectContact(const Span& rowSpan, SDL_FPoint center) const;
+
+  EntityID& cellAt(int column, int row);
+  EntityID cellAt(int column, int row) const;
+
+private:
+  //! Covered region of tile grid (in cells)
+  SDL_Point m_origin = { 0, 0 };
+  int m_columns = { 0 };
+  int m_rows = { 0 };
+
+  SDL_FPoint m_tileSize = { 0, 0 };
+
+  //! Row-major grid of tile IDs (invalidEntityID for empty cell)
+  std::vector<EntityID> m_cells;
+
+  //! Merged spans for each row, resp. column
+  std::vector<std::vector<Span>> m_rowSpans;
+  std::vector<std::vector<Span>> m_columnSpans;
+};
+
+template<typename Fn>
+void
+CollisionSpans::forEachContact(SDL_FRect rect, Fn fn) const
+{
+  if (m_rows == 0) {
+    return;
+  }
+
+  // only rows overlapped by rect can contain a candidate
+  const auto firstRow = std::max(
+    0, static_cast<int>(std::floor(rect.y / m_tileSize.y)) - m_origin.y);
+  const auto lastRow = std::min(
+    m_rows - 1,
+    static_cast<int>(std::floor((rect.y + rect.h) / m_tileSize.y)) -
+      m_origin.y);
+
+  // note: row spans of a vertical stack share its column span, report it
+  // once (rect overlaps only a few spans)
+  const SDL_FPoint center{ rect.x + rect.w * 0.5f, rect.y + rect.h * 0.5f };
+  std::array<const Span*, 8> reported{};
+  std::size_t reportedCount = 0;
+
+  for (int row = firstRow; row <= lastRow; row++) {
+    for (const auto& rowSpan : m_rowSpans[row]) {
+      if (!SDL_HasIntersectionF(&rowSpan.body, &rect)) {
+        continue;
+      }
+
+      const auto& span = selectContact(rowSpan, center);
+      const auto end = reported.begin() + reportedCount;
+      if (std::find(reported.begin(), end, &span) != end) {
+        continue;
+      }
+      if (reportedCount < reported.size()) {
+        reported[reportedCount++] = &span;
+      }
+      fn(span);
+    }
+  }
+}
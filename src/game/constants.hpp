@@ -1,6 +1,7 @@
 #pragma once
 
 #include "SDL2/SDL.h"
+#include <cstddef>
 
 namespace Color {
 static constexpr auto white = SDL_Color{ 0xFF, 0xFF, 0xFF, 0xFF };
@@ -42,6 +43,17 @@ static constexpr float paddleSpeed = 1000;    // world units * s^-1
 static constexpr float ballSpeed = 500;       // world units * s^-1
 static constexpr float pickupFallSpeed = 300; // world units * s^-1
 
+static constexpr unsigned ticksPerSecond = 60;     // script ticks * s^-1
+static constexpr unsigned ballMicrosteps = 10;     // steps per update
+static constexpr unsigned minBallMicrosteps = 3;   // steps per update
+static constexpr unsigned pickupEffectDuration = 10; // s
+static constexpr unsigned restartDelay = 10;         // s
+
+static constexpr std::size_t textureCacheBudget = 4 << 20; // bytes
+static constexpr int scaledSpriteAtlasSize = 1024;          // pixels
+static constexpr std::size_t commandQueueCapacity = 256;    // commands
+static constexpr unsigned maxUnusedTextureFrames = 300;     // frames
+
 static constexpr unsigned penaltyLostBall = 100;    // score points
 static constexpr unsigned rewardTileDestroyed = 10; // score points
 static constexpr unsigned rewardPickupPicked = 1;   // score points
@@ -17,4 +17,15 @@ Paddle::getCurrentSpeed() const
     speed += movement;
 
   return speed;
-}
\ No newline at end of file
+}
+Tile
+Tile::atCell(SDL_Point cell)
+{
+  Tile tile;
+  tile.body = SDL_FRect{ static_cast<float>(cell.x * Constants::tileWidth),
+                         static_cast<float>(cell.y * Constants::tileHeight),
+                         static_cast<float>(Constants::tileWidth),
+                         static_cast<float>(Constants::tileHeight) };
+  tile.cell = cell;
+  return tile;
+}
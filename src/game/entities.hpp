@@ -2,22 +2,53 @@
 
 #include <SDL.h>
 #include <bitset>
+#include <optional>
 
 #include "constants.hpp"
 
 using EntityID = unsigned;
-struct Tile
+static constexpr EntityID invalidEntityID = -1;
+
+struct Pickup
 {
+public:
+  enum Type
+  {
+    speedup,
+    slowdown,
+    change_ball_size,
+    change_paddle_size,
+    size
+  };
+
+public:
   EntityID id = -1;
+  Type type;
+  SDL_FRect body;
+  SDL_Color color = Color::white;
+};
+
+struct Tile
+{
+  EntityID id = invalidEntityID;
 
   //! Position with width/height (in world units)
   SDL_FRect body = { 0, 0, 0, 0 };
 
+  //! Position in the tile grid (column, row)
+  SDL_Point cell = { 0, 0 };
+
   //! Color when drawing tile
   SDL_Color color = Color::white;
 
   //! How many count of collions remains before dying
   std::uint8_t lifes = 1;
+
+  //! Pickup always dropped when destroyed (otherwise dropped by chance)
+  std::optional<Pickup::Type> drop;
+
+  //! Tile covering given cell of the grid (without id)
+  static Tile atCell(SDL_Point cell);
 };
 
 enum ControllerKeys
@@ -36,22 +67,3 @@ struct Paddle
 
   float getCurrentSpeed() const;
 };
-
-struct Pickup
-{
-public:
-  enum Type
-  {
-    speedup,
-    slowdown,
-    change_ball_size,
-    change_paddle_size,
-    size
-  };
-
-public:
-  EntityID id = -1;
-  Type type;
-  SDL_FRect body;
-  SDL_Color color = Color::white;
-};
@@ -11,12 +11,27 @@ Event::Event(EventCallback callback)
 {
 }
 
+Event::Event(TimePoint deadline,
+             std::uint64_t sequence,
+             EventCallback callback)
+  : deadline(deadline)
+  , sequence(sequence)
+  , callback(std::move(callback))
+{
+}
+
 const Event::TimePoint&
 Event::getDeadline() const
 {
   return deadline;
 }
 
+std::uint64_t
+Event::getSequence() const
+{
+  return sequence;
+}
+
 Event::EventCallback
 Event::getCallback() const
 {
@@ -1,10 +1,15 @@
 #pragma once
 
 #include <chrono>
+#include <cstdint>
 #include <functional>
 
 /**
- * @brief Helper: lambda with defined real-time for evaluation
+ * @brief Helper: lambda with defined time for evaluation
+ *
+ * Deadline is either real time (delay from now) or time given by owner (e.g.
+ * simulated time of world). Events with the same deadline are ordered by
+ * their sequence (e.g. order of pushing).
  */
 class Event
 {
@@ -18,15 +23,22 @@ public:
 
   Event(EventCallback callback);
 
+  Event(TimePoint deadline, std::uint64_t sequence, EventCallback callback);
+
   const TimePoint& getDeadline() const;
+  std::uint64_t getSequence() const;
   EventCallback getCallback() const;
 
   bool operator<(const Event& other) const
   {
-    return this->deadline > other.deadline;
+    if (this->deadline != other.deadline) {
+      return this->deadline > other.deadline;
+    }
+    return this->sequence > other.sequence;
   }
 
 private:
   TimePoint deadline;
+  std::uint64_t sequence = { 0 };
   EventCallback callback;
 };
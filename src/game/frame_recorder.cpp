@@ -0,0 +1,162 @@
+#include "frame_recorder.hpp"
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+#include "qoi.hpp"
+
+namespace {
+//! Frames which can wait for writer (~0.5 s of game at 60 FPS)
+constexpr std::size_t bufferCount = 32;
+} // namespace
+
+FrameRecorder::FrameRecorder(const std::string& directory, SDL_Point frameSize)
+  : m_directory(directory)
+{
+  std::error_code error;
+  std::filesystem::create_directories(directory, error);
+  if (error) {
+    throw std::runtime_error("Failed to create recording directory: " +
+                             directory);
+  }
+
+  for (std::size_t i = 0; i < bufferCount; i++) {
+    m_buffers.push_back(utils::make_raii_deleter<SDL_Surface>(
+      utils::throw_if_null(
+        SDL_CreateRGBSurfaceWithFormat(
+          0, frameSize.x, frameSize.y, 32, SDL_PIXELFORMAT_ARGB8888),
+        "Failed to allocate recording buffer"),
+      [](SDL_Surface* surface) { SDL_FreeSurface(surface); }));
+    m_freeBuffers.push_back(m_buffers.back().get());
+  }
+
+  m_thread = std::thread([this]() { run(); });
+}
+
+FrameRecorder::~FrameRecorder()
+{
+  finish();
+}
+
+bool
+FrameRecorder::capture(const std::function<bool(SDL_Surface*)>& readPixels)
+{
+  Frame frame;
+  {
+    std::lock_guard lock(m_mutex);
+    if (m_isStopping) {
+      return false;
+    }
+
+    m_stats.capturedFrames++;
+    if (m_freeBuffers.empty()) {
+      m_stats.droppedFrames++;
+      return false;
+    }
+    frame.surface = m_freeBuffers.back();
+    m_freeBuffers.pop_back();
+  }
+
+  // note: buffer is owned by game thread until it is queued
+  const bool isRead = readPixels(frame.surface);
+
+  {
+    std::lock_guard lock(m_mutex);
+    if (!isRead) {
+      m_stats.droppedFrames++;
+      m_freeBuffers.push_back(frame.surface);
+      return false;
+    }
+
+    // note: only queued frames are numbered, image sequence has no gaps
+    frame.index = m_nextIndex++;
+    m_queue.push_back(frame);
+  }
+  m_hasFrames.notify_one();
+  return true;
+}
+
+void
+FrameRecorder::finish()
+{
+  {
+    std::lock_guard lock(m_mutex);
+    m_isStopping = true;
+  }
+  m_hasFrames.notify_one();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+RecordingStats
+FrameRecorder::getStats() const
+{
+  std::lock_guard lock(m_mutex);
+  return m_stats;
+}
+
+const std::string&
+FrameRecorder::getDirectory() const
+{
+  return m_directory;
+}
+
+void
+FrameRecorder::run()
+{
+  // note: reused by all frames, grows to size of the largest one
+  std::vector<std::uint8_t> encoded;
+
+  while (true) {
+    Frame frame;
+    {
+      std::unique_lock lock(m_mutex);
+      m_hasFrames.wait(lock,
+                       [this]() { return m_isStopping || !m_queue.empty(); });
+
+      // queued frames are written even when stopping
+      if (m_queue.empty()) {
+        return;
+      }
+      frame = m_queue.front();
+      m_queue.pop_front();
+    }
+
+    const auto bytes = write(frame, encoded);
+
+    std::lock_guard lock(m_mutex);
+    m_freeBuffers.push_back(frame.surface);
+    if (bytes > 0) {
+      m_stats.writtenFrames++;
+      m_stats.writtenBytes += bytes;
+    } else {
+      m_stats.droppedFrames++;
+    }
+  }
+}
+
+std::size_t
+FrameRecorder::write(const Frame& frame, std::vector<std::uint8_t>& encoded)
+{
+  const auto* surface = frame.surface;
+  encoded.clear();
+  qoi::encode(static_cast<const std::uint32_t*>(surface->pixels),
+              surface->w,
+              surface->h,
+              surface->pitch,
+              encoded);
+
+  const auto path =
+    std::filesystem::path(m_directory) /
+    std::format("frame_{:06}.qoi", frame.index);
+  std::ofstream file(path, std::ios::binary);
+  file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+  if (!file) {
+    SDL_Log("Failed to write frame: %s", path.string().c_str());
+    return 0;
+  }
+  return encoded.size();
+}
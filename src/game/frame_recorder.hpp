@@ -0,0 +1,94 @@
+#pragma once
+
+#include <SDL.h>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils.hpp"
+
+//! Frames handled by recorder so far
+struct RecordingStats
+{
+  std::uint64_t capturedFrames{ 0 };
+  std::uint64_t writtenFrames{ 0 };
+
+  //! Frames skipped because all buffers were waiting for writer (disk is
+  //! slower than the game) or because reading them failed
+  std::uint64_t droppedFrames{ 0 };
+
+  std::uint64_t writtenBytes{ 0 };
+};
+
+/**
+ * @brief Records frames as numbered QOI images into directory
+ *
+ * Frames are read into a fixed pool of buffers and encoded & written by a
+ * background thread. When no buffer is free, the frame is dropped instead of
+ * waiting, so the game never blocks on disk.
+ */
+class FrameRecorder
+{
+public:
+  //! Throws std::runtime_error if directory can not be created
+  FrameRecorder(const std::string& directory, SDL_Point frameSize);
+
+  //! Writes all frames captured so far (see finish())
+  ~FrameRecorder();
+
+  FrameRecorder(const FrameRecorder&) = delete;
+  FrameRecorder& operator=(const FrameRecorder&) = delete;
+
+  //! Read frame by given function (into ARGB8888 surface of frame size) and
+  //! queue it for writing, returns false if frame was dropped
+  bool capture(const std::function<bool(SDL_Surface*)>& readPixels);
+
+  //! Wait until captured frames are written, no more frames can be captured
+  void finish();
+
+  RecordingStats getStats() const;
+
+  const std::string& getDirectory() const;
+
+protected:
+  struct Frame
+  {
+    std::uint64_t index;
+    SDL_Surface* surface;
+  };
+
+  void run();
+
+  //! Returns count of written bytes (0 on failure)
+  std::size_t write(const Frame& frame, std::vector<std::uint8_t>& encoded);
+
+private:
+  std::string m_directory;
+
+  //! All buffers of pool
+  std::vector<utils::RaiiOwnership<SDL_Surface>> m_buffers;
+
+  mutable std::mutex m_mutex;
+  std::condition_variable m_hasFrames;
+
+  //! Buffers ready to be filled by game
+  std::vector<SDL_Surface*> m_freeBuffers;
+
+  //! Filled buffers waiting for writer (in order of capture)
+  std::deque<Frame> m_queue;
+
+  RecordingStats m_stats;
+
+  //! Number of the next queued frame (its file name)
+  std::uint64_t m_nextIndex = { 0 };
+
+  bool m_isStopping = { false };
+
+  //! Note: must be the last member, it uses all the members above
+  std::thread m_thread;
+};
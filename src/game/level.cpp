@@ -0,0 +1,196 @@
+#include "level.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <tuple>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+//! Map whole file into memory, returns the mapping and its size
+auto
+mapFile(const std::string& path)
+  -> std::pair<utils::RaiiOwnership<const std::byte>, std::size_t>
+{
+#ifdef _WIN32
+  HANDLE file = CreateFileA(path.c_str(),
+                            GENERIC_READ,
+                            FILE_SHARE_READ,
+                            nullptr,
+                            OPEN_EXISTING,
+                            FILE_ATTRIBUTE_NORMAL,
+                            nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    throw std::runtime_error(std::format("Failed to open level: {}", path));
+  }
+  auto fileOwnership = utils::make_raii_action([=]() { CloseHandle(file); });
+
+  LARGE_INTEGER size;
+  if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+    throw std::runtime_error(std::format("Invalid level file: {}", path));
+  }
+
+  HANDLE mapping =
+    CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (mapping == nullptr) {
+    throw std::runtime_error(std::format("Failed to map level: {}", path));
+  }
+  auto mappingOwnership =
+    utils::make_raii_action([=]() { CloseHandle(mapping); });
+
+  // note: view keeps the mapping alive after handles are closed
+  const auto* data = static_cast<const std::byte*>(
+    MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+  if (data == nullptr) {
+    throw std::runtime_error(std::format("Failed to map level: {}", path));
+  }
+
+  return { utils::make_raii_deleter<const std::byte>(
+             data, [](const std::byte* ptr) { UnmapViewOfFile(ptr); }),
+           static_cast<std::size_t>(size.QuadPart) };
+#else
+  const int file = open(path.c_str(), O_RDONLY);
+  if (file < 0) {
+    throw std::runtime_error(std::format("Failed to open level: {}", path));
+  }
+  auto fileOwnership = utils::make_raii_action([=]() { close(file); });
+
+  struct stat info;
+  if (fstat(file, &info) != 0 || info.st_size == 0) {
+    throw std::runtime_error(std::format("Invalid level file: {}", path));
+  }
+  const auto size = static_cast<std::size_t>(info.st_size);
+
+  // note: mapping stays valid after the descriptor is closed
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+  if (data == MAP_FAILED) {
+    throw std::runtime_error(std::format("Failed to map level: {}", path));
+  }
+
+  return { utils::make_raii_deleter<const std::byte>(
+             static_cast<const std::byte*>(data),
+             [size](const std::byte* ptr) {
+               munmap(const_cast<std::byte*>(ptr), size);
+             }),
+           size };
+#endif
+}
+
+//! Does table of count elements at offset fit into file of given size?
+template<typename T>
+bool
+isTableInFile(std::uint64_t offset, std::uint64_t count, std::size_t fileSize)
+{
+  // note: count is untrusted, count * sizeof(T) could overflow
+  return offset % alignof(T) == 0 && offset <= fileSize &&
+         count <= (fileSize - offset) / sizeof(T);
+}
+} // namespace
+
+namespace level {
+LevelFile::LevelFile(const std::string& path)
+{
+  std::tie(m_data, m_size) = mapFile(path);
+
+  // validate the header, fields of records are used as they are
+  if (m_size < sizeof(Header)) {
+    throw std::runtime_error(std::format("Truncated level file: {}", path));
+  }
+
+  const auto& header = *reinterpret_cast<const Header*>(m_data.get());
+  if (header.magic != magic) {
+    throw std::runtime_error(std::format("Not a level file: {}", path));
+  }
+
+  if (header.version != version) {
+    throw std::runtime_error(std::format(
+      "Unsupported level version {} in: {}", header.version, path));
+  }
+
+  const auto tilesCount =
+    static_cast<std::uint64_t>(header.columns) * header.rows;
+  if (!isTableInFile<PaletteEntry>(
+        header.paletteOffset, header.paletteCount, m_size) ||
+      !isTableInFile<TileRecord>(header.tilesOffset, tilesCount, m_size)) {
+    throw std::runtime_error(std::format("Corrupted level file: {}", path));
+  }
+
+  // note: tiles are not scanned to verify tileCount (it would touch all
+  // records), only a count beyond the grid is refused, world clamps the rest
+  if (header.tileCount > tilesCount) {
+    throw std::runtime_error(
+      std::format("Tile count exceeds tiles in: {}", path));
+  }
+}
+
+LevelView
+LevelFile::getView() const
+{
+  const auto* data = m_data.get();
+  const auto& header = *reinterpret_cast<const Header*>(data);
+
+  LevelView view;
+  view.columns = header.columns;
+  view.rows = header.rows;
+  view.tileCount = header.tileCount;
+  view.tiles = { reinterpret_cast<const TileRecord*>(data + header.tilesOffset),
+                 static_cast<std::size_t>(header.columns) * header.rows };
+  view.palette = {
+    reinterpret_cast<const PaletteEntry*>(data + header.paletteOffset),
+    header.paletteCount
+  };
+  return view;
+}
+
+void
+writeLevelFile(const std::string& path,
+               unsigned columns,
+               unsigned rows,
+               const std::vector<PaletteEntry>& palette,
+               const std::vector<TileRecord>& tiles)
+{
+  if (tiles.size() != static_cast<std::size_t>(columns) * rows) {
+    throw std::runtime_error("Tile count does not match level dimensions");
+  }
+
+  Header header = {};
+  header.magic = magic;
+  header.version = version;
+  header.columns = columns;
+  header.rows = rows;
+  header.paletteOffset = sizeof(Header);
+  header.paletteCount = static_cast<std::uint32_t>(palette.size());
+  header.tilesOffset = static_cast<std::uint32_t>(
+    header.paletteOffset + palette.size() * sizeof(PaletteEntry));
+  header.tileCount = static_cast<std::uint32_t>(
+    std::count_if(tiles.begin(), tiles.end(), [](const TileRecord& tile) {
+      return tile.lifes > 0;
+    }));
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  if (!file) {
+    throw std::runtime_error(std::format("Failed to create level: {}", path));
+  }
+
+  file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+  file.write(reinterpret_cast<const char*>(palette.data()),
+             palette.size() * sizeof(PaletteEntry));
+  file.write(reinterpret_cast<const char*>(tiles.data()),
+             tiles.size() * sizeof(TileRecord));
+
+  if (!file) {
+    throw std::runtime_error(std::format("Failed to write level: {}", path));
+  }
+}
+} // namespace level
@@ -0,0 +1,108 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "utils.hpp"
+
+/**
+ * @brief Binary level format (little-endian)
+ *
+ * [LevelHeader][PaletteEntry * paletteCount][TileRecord * columns * rows]
+ *
+ * Records are naturally aligned and used in place, directly from the mapped
+ * file, thus loading a level costs only page faults of touched records.
+ */
+namespace level {
+static constexpr std::array<char, 4> magic = { 'A', 'R', 'K', 'L' };
+static constexpr std::uint16_t version = 2;
+
+struct PaletteEntry
+{
+  std::uint8_t r, g, b, a;
+};
+
+struct TileRecord
+{
+  //! Index to palette
+  std::uint8_t color;
+
+  //! How many hits the tile survives (0 = empty cell)
+  std::uint8_t lifes;
+
+  //! Pickup dropped when destroyed (0 = by chance, else Pickup::Type + 1)
+  std::uint8_t pickup;
+
+  std::uint8_t reserved;
+};
+
+struct Header
+{
+  std::array<char, 4> magic;
+  std::uint16_t version;
+  std::uint16_t flags;
+
+  //! Grid dimensions (in tiles)
+  std::uint32_t columns;
+  std::uint32_t rows;
+
+  //! Offsets of tables from the beginning of file (in bytes)
+  std::uint32_t paletteOffset;
+  std::uint32_t paletteCount;
+  std::uint32_t tilesOffset;
+
+  //! Count of tiles with non-zero lifes
+  std::uint32_t tileCount;
+};
+
+static_assert(sizeof(PaletteEntry) == 4);
+static_assert(sizeof(TileRecord) == 4);
+static_assert(sizeof(Header) == 32);
+
+/**
+ * @brief Non-owning view of level data (mapped file or static table)
+ */
+struct LevelView
+{
+  unsigned columns = { 0 };
+  unsigned rows = { 0 };
+
+  //! Count of tiles with non-zero lifes
+  unsigned tileCount = { 0 };
+
+  //! Row-major grid of tiles
+  std::span<const TileRecord> tiles;
+
+  std::span<const PaletteEntry> palette;
+};
+
+/**
+ * @brief Read-only memory mapping of binary level file
+ *
+ * Copies share the same mapping, which lives until the last copy is gone.
+ */
+class LevelFile
+{
+public:
+  //! Map and validate file (throws std::runtime_error)
+  explicit LevelFile(const std::string& path);
+
+  LevelView getView() const;
+
+private:
+  utils::RaiiOwnership<const std::byte> m_data;
+  std::size_t m_size = { 0 };
+};
+
+//! Serialize level into binary file (throws std::runtime_error)
+void
+writeLevelFile(const std::string& path,
+               unsigned columns,
+               unsigned rows,
+               const std::vector<PaletteEntry>& palette,
+               const std::vector<TileRecord>& tiles);
+} // namespace level
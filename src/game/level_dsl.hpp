@@ -0,0 +1,106 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "entities.hpp"
+#include "level.hpp"
+
+/**
+ * @brief Levels written as string literals, parsed at compile time
+ *
+ * Each literal is a row of tiles:
+ *   '.' empty, 'R' red, 'G' green, 'B' blue, 'H' hard (2 lifes),
+ *   'S' hard tile dropping speedup, 'P' hard tile dropping bigger paddle
+ *
+ * Malformed layout (unknown symbol, rows of different length) fails the build.
+ */
+namespace level {
+static constexpr std::array<PaletteEntry, 4> builtinPalette = { {
+  { 0xFF, 0x00, 0x00, 0xFF }, // red
+  { 0x00, 0xFF, 0x00, 0xFF }, // green
+  { 0x00, 0x00, 0xFF, 0xFF }, // blue
+  { 0x33, 0x33, 0x33, 0xFF }, // gray
+} };
+
+template<std::size_t Columns, std::size_t Rows>
+struct StaticLevel
+{
+  std::array<TileRecord, Columns * Rows> tiles;
+  unsigned tileCount;
+
+  constexpr LevelView getView() const
+  {
+    LevelView view;
+    view.columns = Columns;
+    view.rows = Rows;
+    view.tileCount = tileCount;
+    view.tiles = tiles;
+    view.palette = builtinPalette;
+    return view;
+  }
+};
+
+namespace detail {
+//! Pickup of tile record is encoded as Pickup::Type + 1 (0: no pickup)
+constexpr std::uint8_t
+encodePickup(Pickup::Type type)
+{
+  return static_cast<std::uint8_t>(type) + 1;
+}
+
+constexpr TileRecord
+parseSymbol(char symbol)
+{
+  switch (symbol) {
+    case '.':
+      return TileRecord{ 0, 0, 0, 0 };
+    case 'R':
+      return TileRecord{ 0, 1, 0, 0 };
+    case 'G':
+      return TileRecord{ 1, 1, 0, 0 };
+    case 'B':
+      return TileRecord{ 2, 1, 0, 0 };
+    case 'H':
+      return TileRecord{ 3, 2, 0, 0 };
+    case 'S':
+      return TileRecord{ 3, 2, encodePickup(Pickup::Type::speedup), 0 };
+    case 'P':
+      return TileRecord{
+        3, 2, encodePickup(Pickup::Type::change_paddle_size), 0
+      };
+  }
+
+  // reached only during constant evaluation => compile error
+  throw "Unknown tile symbol in level layout";
+}
+} // namespace detail
+
+//! Parse rows of level at compile time
+template<std::size_t N, std::size_t... Ns>
+consteval auto
+parseLevel(const char (&first)[N], const char (&... rest)[Ns])
+{
+  static_assert(((Ns == N) && ...), "Rows of level must have equal length");
+  static_assert(N > 1, "Level must have at least one column");
+
+  constexpr std::size_t columns = N - 1;
+  constexpr std::size_t rows = 1 + sizeof...(Ns);
+
+  StaticLevel<columns, rows> level{};
+  const char* lines[] = { first, rest... };
+
+  for (std::size_t y = 0; y < rows; y++) {
+    for (std::size_t x = 0; x < columns; x++) {
+      const auto tile = detail::parseSymbol(lines[y][x]);
+      if (tile.lifes > 0) {
+        level.tileCount++;
+      }
+      level.tiles[y * columns + x] = tile;
+    }
+  }
+
+  return level;
+}
+} // namespace level
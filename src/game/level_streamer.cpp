@@ -0,0 +1,111 @@
+#include "level_streamer.hpp"
+
+#include <algorithm>
+#include <utility>
+
+LevelStreamer::LevelStreamer(level::LevelView level)
+  : m_level(level)
+{
+}
+
+LevelStreamer::~LevelStreamer()
+{
+  {
+    std::lock_guard lock(m_mutex);
+    m_isStopping = true;
+  }
+  m_wakeUp.notify_one();
+  if (m_thread.joinable()) {
+    m_thread.join();
+  }
+}
+
+void
+LevelStreamer::request(SDL_Point coord)
+{
+  {
+    std::lock_guard lock(m_mutex);
+    m_requests.push_back(coord);
+  }
+  if (!m_thread.joinable()) {
+    m_thread = std::thread([this]() { run(); });
+  }
+  m_wakeUp.notify_one();
+}
+
+std::vector<LevelStreamer::Chunk>
+LevelStreamer::takeLoaded()
+{
+  std::lock_guard lock(m_mutex);
+  return std::exchange(m_loaded, {});
+}
+
+LevelStreamer::Chunk
+LevelStreamer::load(SDL_Point coord) const
+{
+  Chunk chunk;
+  chunk.coord = coord;
+
+  const auto firstColumn = coord.x * chunkSize;
+  const auto firstRow = coord.y * chunkSize;
+  const auto lastColumn =
+    std::min<int>(firstColumn + chunkSize, m_level.columns);
+  const auto lastRow = std::min<int>(firstRow + chunkSize, m_level.rows);
+
+  for (int y = firstRow; y < lastRow; y++) {
+    for (int x = firstColumn; x < lastColumn; x++) {
+      const auto& record = m_level.tiles[y * m_level.columns + x];
+      if (record.lifes == 0) {
+        continue;
+      }
+
+      auto tile = Tile::atCell(SDL_Point{ x, y });
+      tile.lifes = record.lifes;
+
+      // note: records are not validated on load, fall back on bad index
+      if (record.color < m_level.palette.size()) {
+        const auto& entry = m_level.palette[record.color];
+        tile.color = SDL_Color{ entry.r, entry.g, entry.b, entry.a };
+      }
+
+      if (record.pickup > 0 && record.pickup <= Pickup::Type::size) {
+        tile.drop = static_cast<Pickup::Type>(record.pickup - 1);
+      }
+
+      chunk.tiles.push_back(tile);
+    }
+  }
+
+  return chunk;
+}
+
+SDL_Point
+LevelStreamer::getChunkCount() const
+{
+  return SDL_Point{
+    static_cast<int>((m_level.columns + chunkSize - 1) / chunkSize),
+    static_cast<int>((m_level.rows + chunkSize - 1) / chunkSize)
+  };
+}
+
+void
+LevelStreamer::run()
+{
+  std::unique_lock lock(m_mutex);
+  while (true) {
+    m_wakeUp.wait(
+      lock, [this]() { return m_isStopping || !m_requests.empty(); });
+    if (m_isStopping) {
+      return;
+    }
+
+    const auto coord = m_requests.front();
+    m_requests.pop_front();
+
+    lock.unlock();
+    auto chunk = load(coord);
+    lock.lock();
+
+    m_loaded.push_back(std::move(chunk));
+  }
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <SDL.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "entities.hpp"
+#include "level.hpp"
+
+/**
+ * @brief Loads chunks of level tiles on a background thread
+ *
+ * Reading records of a mapped level may fault pages in, thus it is done
+ * away from the game thread. Loaded chunks are handed over by takeLoaded().
+ * The thread is started by the first request, streamer used only by load()
+ * (deterministic world) does not own any.
+ */
+class LevelStreamer
+{
+public:
+  //! Square chunk size (in tiles)
+  static constexpr int chunkSize = 16;
+
+  struct Chunk
+  {
+    //! Position in grid of chunks
+    SDL_Point coord;
+
+    //! Alive tiles of chunk (without IDs, these are assigned by world)
+    std::vector<Tile> tiles;
+  };
+
+  //! Note: level data must outlive the streamer
+  explicit LevelStreamer(level::LevelView level);
+  ~LevelStreamer();
+
+  LevelStreamer(const LevelStreamer&) = delete;
+  LevelStreamer& operator=(const LevelStreamer&) = delete;
+
+  //! Queue chunk for loading in background (starts background thread)
+  void request(SDL_Point coord);
+
+  //! Take chunks loaded since the last call
+  std::vector<Chunk> takeLoaded();
+
+  //! Load chunk on calling thread
+  Chunk load(SDL_Point coord) const;
+
+  //! Count of chunks in each direction
+  SDL_Point getChunkCount() const;
+
+protected:
+  void run();
+
+private:
+  level::LevelView m_level;
+
+  std::mutex m_mutex;
+  std::condition_variable m_wakeUp;
+  std::deque<SDL_Point> m_requests;
+  std::vector<Chunk> m_loaded;
+  bool m_isStopping = { false };
+
+  //! Note: must be the last member, it uses all the members above (not
+  //! joinable until the first request)
+  std::thread m_thread;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+
+/**
+ * @brief Bounded lock-free queue: many producer threads, single consumer
+ *
+ * Ring of cells, each with sequence number telling whether it is free for
+ * position (sequence == position) or holds value of position (sequence ==
+ * position + 1). Producers claim positions by CAS, thus values are consumed
+ * in order of claiming, which is consistent with order of push() calls of
+ * each producer. Consumer never waits: value being written by producer (and
+ * all values after it) is consumed by the next pop().
+ */
+template<typename T>
+class MpscQueue
+{
+public:
+  //! Capacity is rounded up to power of two
+  explicit MpscQueue(std::size_t capacity)
+  {
+    if (capacity == 0) {
+      throw std::runtime_error("Queue must have non-zero capacity");
+    }
+    std::size_t size = 1;
+    while (size < capacity) {
+      size *= 2;
+    }
+
+    m_mask = size - 1;
+    m_cells = std::make_unique<Cell[]>(size);
+    for (std::size_t i = 0; i < size; i++) {
+      m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  MpscQueue(const MpscQueue&) = delete;
+  MpscQueue& operator=(const MpscQueue&) = delete;
+
+  //! Any thread, returns false if queue is full (value is not queued)
+  bool push(const T& value)
+  {
+    auto position = m_pushPosition.load(std::memory_order_relaxed);
+    while (true) {
+      auto& cell = m_cells[position & m_mask];
+      const auto sequence = cell.sequence.load(std::memory_order_acquire);
+      const auto difference = static_cast<std::intptr_t>(sequence) -
+                              static_cast<std::intptr_t>(position);
+      if (difference == 0) {
+        // note: on failure, position is updated to the current one
+        if (m_pushPosition.compare_exchange_weak(
+              position, position + 1, std::memory_order_relaxed)) {
+          cell.value = value;
+          cell.sequence.store(position + 1, std::memory_order_release);
+          return true;
+        }
+      } else if (difference < 0) {
+        // cell still holds value of previous round, consumer is behind
+        return false;
+      } else {
+        position = m_pushPosition.load(std::memory_order_relaxed);
+      }
+    }
+  }
+
+  //! Consumer thread only, none if there is no (completely written) value
+  std::optional<T> pop()
+  {
+    auto& cell = m_cells[m_popPosition & m_mask];
+    if (cell.sequence.load(std::memory_order_acquire) != m_popPosition + 1) {
+      return std::nullopt;
+    }
+
+    std::optional<T> value(std::move(cell.value));
+    cell.sequence.store(m_popPosition + m_mask + 1, std::memory_order_release);
+    m_popPosition++;
+    return value;
+  }
+
+  std::size_t getCapacity() const { return m_mask + 1; }
+
+private:
+  // note: cells & positions on separate cache lines, producers & consumer
+  // do not invalidate each other's lines more than necessary
+  static constexpr std::size_t cacheLineSize = 64;
+
+  struct alignas(cacheLineSize) Cell
+  {
+    std::atomic<std::size_t> sequence;
+    T value;
+  };
+
+  std::unique_ptr<Cell[]> m_cells;
+  std::size_t m_mask = { 0 };
+
+  alignas(cacheLineSize) std::atomic<std::size_t> m_pushPosition = { 0 };
+  alignas(cacheLineSize) std::size_t m_popPosition = { 0 };
+};
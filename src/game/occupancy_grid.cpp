@@ -0,0 +1,151 @@
+#include "occupancy_grid.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#include "raster.hpp"
+
+namespace {
+//! Part of cell covered by interval
+inline float
+getCoverage(float begin, float end, int cell)
+{
+  return std::min(end, cell + 1.0f) - std::max(begin, static_cast<float>(cell));
+}
+
+inline void
+raiseCell(std::uint8_t& cell, float value)
+{
+  const auto rounded = static_cast<std::uint8_t>(value + 0.5f);
+  cell = std::max(cell, rounded);
+}
+} // namespace
+
+OccupancyGrid::OccupancyGrid(std::span<std::uint8_t> cells,
+                             int width,
+                             int height)
+  : m_cells(cells)
+  , m_width(width)
+  , m_height(height)
+{
+  assert(cells.size() == getSize(width, height));
+  setView({ 0, 0, static_cast<float>(width), static_cast<float>(height) });
+}
+
+void
+OccupancyGrid::setView(const GridRect& view)
+{
+  m_view = view;
+  m_scaleX = m_width / view.w;
+  m_scaleY = m_height / view.h;
+}
+
+void
+OccupancyGrid::clear()
+{
+  std::memset(m_cells.data(), 0, m_cells.size());
+}
+
+void
+OccupancyGrid::addRect(GridChannel channel,
+                       const GridRect& rect,
+                       std::uint8_t value)
+{
+  const auto bounds = toGrid(rect);
+  if (bounds.left >= bounds.right || bounds.top >= bounds.bottom) {
+    return;
+  }
+
+  const auto firstColumn = static_cast<int>(bounds.left);
+  const auto lastColumn = static_cast<int>(std::ceil(bounds.right)) - 1;
+  const auto firstRow = static_cast<int>(bounds.top);
+  const auto lastRow = static_cast<int>(std::ceil(bounds.bottom)) - 1;
+
+  const auto leftCoverage =
+    getCoverage(bounds.left, bounds.right, firstColumn);
+  const auto rightCoverage =
+    getCoverage(bounds.left, bounds.right, lastColumn);
+
+  for (int row = firstRow; row <= lastRow; row++) {
+    const auto rowValue =
+      value * getCoverage(bounds.top, bounds.bottom, row);
+    auto* cells = getRow(channel, row);
+
+    // partially covered columns at edges, fully covered span between them
+    raiseCell(cells[firstColumn], rowValue * leftCoverage);
+    if (lastColumn > firstColumn) {
+      raiseCell(cells[lastColumn], rowValue * rightCoverage);
+      raster::maxSpan(cells + firstColumn + 1,
+                      static_cast<std::uint8_t>(rowValue + 0.5f),
+                      lastColumn - firstColumn - 1);
+    }
+  }
+}
+
+void
+OccupancyGrid::setRect(GridChannel channel,
+                       const GridRect& rect,
+                       std::uint8_t value)
+{
+  const auto bounds = toGrid(rect);
+  if (bounds.left >= bounds.right || bounds.top >= bounds.bottom) {
+    return;
+  }
+
+  const auto firstColumn = static_cast<int>(bounds.left);
+  const auto lastColumn = static_cast<int>(std::ceil(bounds.right)) - 1;
+  for (int row = static_cast<int>(bounds.top);
+       row < static_cast<int>(std::ceil(bounds.bottom));
+       row++) {
+    std::memset(
+      getRow(channel, row) + firstColumn, value, lastColumn - firstColumn + 1);
+  }
+}
+
+std::span<const std::uint8_t>
+OccupancyGrid::getChannel(GridChannel channel) const
+{
+  const auto planeSize = static_cast<std::size_t>(m_width) * m_height;
+  return m_cells.subspan(static_cast<std::size_t>(channel) * planeSize,
+                         planeSize);
+}
+
+int
+OccupancyGrid::getWidth() const
+{
+  return m_width;
+}
+
+int
+OccupancyGrid::getHeight() const
+{
+  return m_height;
+}
+
+std::uint8_t
+OccupancyGrid::toSigned(float value)
+{
+  const auto clamped = std::clamp(value, -1.0f, 1.0f);
+  return static_cast<std::uint8_t>(std::lround(128.0f + clamped * 127.0f));
+}
+
+OccupancyGrid::Bounds
+OccupancyGrid::toGrid(const GridRect& rect) const
+{
+  return Bounds{
+    std::clamp((rect.x - m_view.x) * m_scaleX, 0.0f, float(m_width)),
+    std::clamp((rect.y - m_view.y) * m_scaleY, 0.0f, float(m_height)),
+    std::clamp((rect.x + rect.w - m_view.x) * m_scaleX, 0.0f, float(m_width)),
+    std::clamp((rect.y + rect.h - m_view.y) * m_scaleY, 0.0f, float(m_height))
+  };
+}
+
+std::uint8_t*
+OccupancyGrid::getRow(GridChannel channel, int row)
+{
+  const auto planeSize = static_cast<std::size_t>(m_width) * m_height;
+  return m_cells.data() + static_cast<std::size_t>(channel) * planeSize +
+         static_cast<std::size_t>(row) * m_width;
+}
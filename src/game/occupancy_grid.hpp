@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+//! Planes of occupancy grid (see OccupancyGrid)
+enum class GridChannel : std::uint8_t
+{
+  //! Tiles, brighter for more lifes
+  tiles,
+  paddle,
+  ball,
+
+  //! Ball's speed over its cells, 128 is still (see OccupancyGrid::toSigned)
+  ballSpeedX,
+  ballSpeedY,
+
+  //! One plane per Pickup::Type (in the same order)
+  pickupSpeedup,
+  pickupSlowdown,
+  pickupBallSize,
+  pickupPaddleSize,
+  count
+};
+
+//! Rectangle in world units (mirrors SDL_FRect, thus grid does not need SDL)
+struct GridRect
+{
+  float x, y, w, h;
+};
+
+/**
+ * @brief Compact observation of world: downsampled multi-channel uint8 grid
+ *
+ * Writes into caller's buffer of planes [channel][row][column]. Rectangles
+ * (in world units) are mapped from view onto the grid, cells partially
+ * covered by rectangle get proportional value and overlapping rectangles
+ * keep the higher value. Spans are filled by SIMD kernels (no SDL calls).
+ */
+class OccupancyGrid
+{
+public:
+  static constexpr std::size_t channelCount =
+    static_cast<std::size_t>(GridChannel::count);
+
+  //! Bytes of grid with given resolution
+  static constexpr std::size_t getSize(int width, int height)
+  {
+    return channelCount * static_cast<std::size_t>(width) * height;
+  }
+
+  //! Grid over cells (getSize(width, height) bytes)
+  OccupancyGrid(std::span<std::uint8_t> cells, int width, int height);
+
+  //! Area of world (in world units) mapped onto grid
+  void setView(const GridRect& view);
+
+  //! Zero all channels
+  void clear();
+
+  //! Cover rectangle by value (weighted by coverage of cells)
+  void addRect(GridChannel channel, const GridRect& rect, std::uint8_t value);
+
+  //! Overwrite cells touched by rectangle by value (without weighting)
+  void setRect(GridChannel channel, const GridRect& rect, std::uint8_t value);
+
+  std::span<const std::uint8_t> getChannel(GridChannel channel) const;
+
+  int getWidth() const;
+  int getHeight() const;
+
+  //! Encode value in -1..1 as byte (0 = -1, 128 = 0, 255 = 1)
+  static std::uint8_t toSigned(float value);
+
+protected:
+  //! Rectangle in grid cells, clipped to grid (empty if outside)
+  struct Bounds
+  {
+    float left, top, right, bottom;
+  };
+
+  Bounds toGrid(const GridRect& rect) const;
+
+  std::uint8_t* getRow(GridChannel channel, int row);
+
+private:
+  std::span<std::uint8_t> m_cells;
+  int m_width;
+  int m_height;
+  GridRect m_view = { 0, 0, 1, 1 };
+
+  //! Cells per world unit
+  float m_scaleX = { 1 };
+  float m_scaleY = { 1 };
+};
@@ -0,0 +1,236 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+thread_local Profiler* currentProfiler = nullptr;
+
+std::size_t
+toIndex(ProfilePhase phase)
+{
+  return static_cast<std::size_t>(phase);
+}
+} // namespace
+
+const char*
+getPhaseName(ProfilePhase phase)
+{
+  switch (phase) {
+    case ProfilePhase::events:
+      return "events";
+    case ProfilePhase::pickups:
+      return "pickups";
+    case ProfilePhase::dynamics:
+      return "dynamics";
+    case ProfilePhase::collisionDryRun:
+      return "collision dry run";
+    case ProfilePhase::microstepping:
+      return "microstepping";
+    case ProfilePhase::renderEntities:
+      return "render entities";
+    case ProfilePhase::renderHUD:
+      return "render HUD";
+    case ProfilePhase::present:
+      return "present";
+    case ProfilePhase::sleep:
+      return "sleep";
+    default:
+      return "unknown";
+  }
+}
+
+Profiler::Profiler()
+  : m_start(Clock::now())
+  , m_samples(sampleCapacity)
+  , m_frames(frameCapacity)
+{
+}
+
+Profiler*
+Profiler::getCurrent()
+{
+  return currentProfiler;
+}
+
+void
+Profiler::setCurrent(Profiler* profiler)
+{
+  currentProfiler = profiler;
+}
+
+void
+Profiler::beginFrame()
+{
+  const auto now = toNanoseconds(Clock::now());
+  if (m_hasFrame) {
+    const auto elapsedNs = now - m_current.beginNs;
+    const auto sleepNs = std::min<std::uint64_t>(
+      elapsedNs, m_current.phaseNs[toIndex(ProfilePhase::sleep)]);
+    m_current.busyUs =
+      static_cast<std::uint32_t>((elapsedNs - sleepNs) / 1000);
+
+    // note: readers see the frame once the count is published
+    const auto frame = m_frameCount.load(std::memory_order_relaxed);
+    m_frames[frame % frameCapacity] = m_current;
+    m_frameCount.store(frame + 1, std::memory_order_release);
+  }
+
+  m_current = ProfileFrame{};
+  m_current.beginNs = now;
+  m_hasFrame = true;
+}
+
+void
+Profiler::record(ProfilePhase phase,
+                 Clock::time_point begin,
+                 Clock::time_point end)
+{
+  const auto beginNs = toNanoseconds(begin);
+  // note: 64 bits, scopes may last seconds (idle wait, debugger)
+  const auto durationNs = toNanoseconds(end) - beginNs;
+
+  const auto index = m_sampleCount.load(std::memory_order_relaxed);
+  m_samples[index % sampleCapacity] = ProfileSample{
+    beginNs,
+    durationNs,
+    static_cast<std::uint32_t>(m_frameCount.load(std::memory_order_relaxed)),
+    phase
+  };
+  m_sampleCount.store(index + 1, std::memory_order_release);
+
+  m_current.phaseNs[toIndex(phase)] += durationNs;
+}
+
+void
+Profiler::recordEventQueueDepth(std::size_t depth)
+{
+  m_current.eventQueueDepth =
+    std::max(m_current.eventQueueDepth, static_cast<std::uint32_t>(depth));
+}
+
+void
+Profiler::recordTimerLateness(std::chrono::microseconds lateness)
+{
+  const auto latenessUs = std::max<std::int64_t>(0, lateness.count());
+  m_current.maxLatenessUs = std::max(m_current.maxLatenessUs,
+                                     static_cast<std::uint32_t>(latenessUs));
+}
+
+std::uint64_t
+Profiler::getFrameCount() const
+{
+  return m_frameCount.load(std::memory_order_acquire);
+}
+
+std::vector<ProfileFrame>
+Profiler::getFrames() const
+{
+  const auto count = m_frameCount.load(std::memory_order_acquire);
+  const auto available = std::min<std::uint64_t>(count, frameCapacity);
+
+  std::vector<ProfileFrame> frames;
+  frames.reserve(available);
+  for (auto i = count - available; i < count; i++) {
+    frames.push_back(m_frames[i % frameCapacity]);
+  }
+  return frames;
+}
+
+std::optional<ProfileFrame>
+Profiler::getLastFrame() const
+{
+  const auto count = m_frameCount.load(std::memory_order_acquire);
+  if (count == 0) {
+    return std::nullopt;
+  }
+  return m_frames[(count - 1) % frameCapacity];
+}
+
+std::uint32_t
+Profiler::getBusyPercentile(double percentile) const
+{
+  std::vector<std::uint32_t> busy;
+  for (const auto& frame : getFrames()) {
+    busy.push_back(frame.busyUs);
+  }
+  if (busy.empty()) {
+    return 0;
+  }
+
+  const auto rank = static_cast<std::size_t>(percentile / 100.0 *
+                                             (busy.size() - 1));
+  std::nth_element(busy.begin(), busy.begin() + rank, busy.end());
+  return busy[rank];
+}
+
+void
+Profiler::exportChromeTrace(const std::string& path) const
+{
+  std::ofstream file(path);
+  if (!file) {
+    throw std::runtime_error("Failed to open trace file: " + path);
+  }
+
+  // note: timestamps of trace events are in microseconds
+  file << "{\"traceEvents\":[\n";
+  bool isFirst = true;
+  const auto separator = [&isFirst]() {
+    return std::exchange(isFirst, false) ? "" : ",\n";
+  };
+
+  const auto count = m_sampleCount.load(std::memory_order_acquire);
+  const auto available = std::min<std::uint64_t>(count, sampleCapacity);
+  for (auto i = count - available; i < count; i++) {
+    const auto& sample = m_samples[i % sampleCapacity];
+    file << separator()
+         << std::format("{{\"name\":\"{}\",\"ph\":\"X\",\"ts\":{:.3f},"
+                        "\"dur\":{:.3f},\"pid\":1,\"tid\":1,"
+                        "\"args\":{{\"frame\":{}}}}}",
+                        getPhaseName(sample.phase),
+                        sample.beginNs / 1000.0,
+                        sample.durationNs / 1000.0,
+                        sample.frame);
+  }
+
+  for (const auto& frame : getFrames()) {
+    file << separator()
+         << std::format("{{\"name\":\"events\",\"ph\":\"C\",\"ts\":{:.3f},"
+                        "\"pid\":1,\"args\":{{\"queue depth\":{},"
+                        "\"lateness [us]\":{}}}}}",
+                        frame.beginNs / 1000.0,
+                        frame.eventQueueDepth,
+                        frame.maxLatenessUs);
+  }
+  file << "\n]}\n";
+
+  if (!file) {
+    throw std::runtime_error("Failed to write trace file: " + path);
+  }
+}
+
+std::uint64_t
+Profiler::toNanoseconds(Clock::time_point time) const
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(time - m_start)
+    .count();
+}
+
+ProfileScope::ProfileScope(ProfilePhase phase)
+  : m_profiler(Profiler::getCurrent())
+  , m_phase(phase)
+{
+  if (m_profiler != nullptr) {
+    m_begin = Profiler::Clock::now();
+  }
+}
+
+ProfileScope::~ProfileScope()
+{
+  if (m_profiler != nullptr) {
+    m_profiler->record(m_phase, m_begin, Profiler::Clock::now());
+  }
+}
@@ -0,0 +1,137 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+//! Measured parts of frame
+enum class ProfilePhase : std::uint8_t
+{
+  events,
+  pickups,
+  dynamics,
+  collisionDryRun,
+  microstepping,
+  renderEntities,
+  renderHUD,
+  present,
+  sleep,
+  count
+};
+
+const char*
+getPhaseName(ProfilePhase phase);
+
+//! Single measured scope
+struct ProfileSample
+{
+  //! Since profiler was created
+  std::uint64_t beginNs;
+  std::uint64_t durationNs;
+  std::uint32_t frame;
+  ProfilePhase phase;
+};
+
+//! Summary of single frame
+struct ProfileFrame
+{
+  //! Since profiler was created
+  std::uint64_t beginNs{ 0 };
+
+  std::array<std::uint64_t, static_cast<std::size_t>(ProfilePhase::count)>
+    phaseNs{};
+
+  //! Duration of frame (without sleep)
+  std::uint32_t busyUs{ 0 };
+
+  //! The deepest event queue seen during frame
+  std::uint32_t eventQueueDepth{ 0 };
+
+  //! The latest timer of frame (fire time - deadline)
+  std::uint32_t maxLatenessUs{ 0 };
+};
+
+/**
+ * @brief Collects phase timers of frames
+ *
+ * Samples are written by thread owning profiler into lock-free ring buffer
+ * (the oldest are overwritten). Profiler is installed per thread (see
+ * setCurrent()), scopes on threads without profiler cost only a check.
+ */
+class Profiler
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  static constexpr std::size_t sampleCapacity = 1 << 16;
+  static constexpr std::size_t frameCapacity = 256;
+
+  Profiler();
+
+  //! Profiler used by ProfileScope on calling thread (may be null)
+  static Profiler* getCurrent();
+  static void setCurrent(Profiler* profiler);
+
+  //! Close the previous frame and start a new one
+  void beginFrame();
+
+  void record(ProfilePhase phase, Clock::time_point begin, Clock::time_point end);
+
+  void recordEventQueueDepth(std::size_t depth);
+  void recordTimerLateness(std::chrono::microseconds lateness);
+
+  //! Count of frames ever finished
+  std::uint64_t getFrameCount() const;
+
+  //! Finished frames (the oldest first, at most frameCapacity)
+  std::vector<ProfileFrame> getFrames() const;
+
+  //! The latest finished frame (none before the first one)
+  std::optional<ProfileFrame> getLastFrame() const;
+
+  //! Percentile (0-100) of busy time over finished frames
+  std::uint32_t getBusyPercentile(double percentile) const;
+
+  //! Write samples in the buffer as Chrome's trace events (chrome://tracing,
+  //! Perfetto). Throws std::runtime_error if file can not be written.
+  void exportChromeTrace(const std::string& path) const;
+
+protected:
+  std::uint64_t toNanoseconds(Clock::time_point time) const;
+
+private:
+  Clock::time_point m_start;
+
+  std::vector<ProfileSample> m_samples;
+
+  //! Count of samples ever written (index of the next one modulo capacity)
+  std::atomic<std::uint64_t> m_sampleCount = { 0 };
+
+  std::vector<ProfileFrame> m_frames;
+  std::atomic<std::uint64_t> m_frameCount = { 0 };
+
+  //! Frame being measured
+  ProfileFrame m_current;
+  bool m_hasFrame = { false };
+};
+
+//! Measures its lifetime as phase of current profiler (if any)
+class ProfileScope
+{
+public:
+  explicit ProfileScope(ProfilePhase phase);
+  ~ProfileScope();
+
+  ProfileScope(const ProfileScope&) = delete;
+  ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+  Profiler* m_profiler;
+  ProfilePhase m_phase;
+  Profiler::Clock::time_point m_begin;
+};
@@ -0,0 +1,112 @@
+#include "qoi.hpp"
+
+#include <array>
+
+namespace {
+constexpr std::uint8_t opIndex = 0x00;
+constexpr std::uint8_t opDiff = 0x40;
+constexpr std::uint8_t opLuma = 0x80;
+constexpr std::uint8_t opRun = 0xC0;
+constexpr std::uint8_t opRgb = 0xFE;
+
+constexpr int maxRunLength = 62;
+
+constexpr std::uint8_t channelsRgb = 3;
+constexpr std::uint8_t colorspaceSrgb = 0;
+
+constexpr std::array<std::uint8_t, 8> endMarker = { 0, 0, 0, 0, 0, 0, 0, 1 };
+
+void
+writeBigEndian(std::vector<std::uint8_t>& output, std::uint32_t value)
+{
+  output.push_back(value >> 24);
+  output.push_back(value >> 16);
+  output.push_back(value >> 8);
+  output.push_back(value);
+}
+
+struct Rgba
+{
+  std::uint8_t r, g, b, a;
+
+  bool operator==(const Rgba&) const = default;
+
+  int hash() const { return (r * 3 + g * 5 + b * 7 + a * 11) % 64; }
+};
+} // namespace
+
+namespace qoi {
+void
+encode(const std::uint32_t* pixels,
+       int width,
+       int height,
+       int pitch,
+       std::vector<std::uint8_t>& output)
+{
+  output.insert(output.end(), { 'q', 'o', 'i', 'f' });
+  writeBigEndian(output, width);
+  writeBigEndian(output, height);
+  output.push_back(channelsRgb);
+  output.push_back(colorspaceSrgb);
+
+  // note: image is stored as RGB, alpha of decoder's state stays 255
+  std::array<Rgba, 64> seen{};
+  Rgba previous{ 0, 0, 0, 0xFF };
+  int run = 0;
+
+  for (int y = 0; y < height; y++) {
+    const auto* row = reinterpret_cast<const std::uint32_t*>(
+      reinterpret_cast<const std::uint8_t*>(pixels) + y * pitch);
+    for (int x = 0; x < width; x++) {
+      const Rgba color{ std::uint8_t(row[x] >> 16),
+                        std::uint8_t(row[x] >> 8),
+                        std::uint8_t(row[x]),
+                        0xFF };
+
+      if (color == previous) {
+        if (++run == maxRunLength) {
+          output.push_back(opRun | (run - 1));
+          run = 0;
+        }
+        continue;
+      }
+
+      if (run > 0) {
+        output.push_back(opRun | (run - 1));
+        run = 0;
+      }
+
+      const auto index = color.hash();
+      if (seen[index] == color) {
+        output.push_back(opIndex | index);
+      } else {
+        seen[index] = color;
+
+        // note: differences wrap around (as in decoder)
+        const auto dr = std::int8_t(color.r - previous.r);
+        const auto dg = std::int8_t(color.g - previous.g);
+        const auto db = std::int8_t(color.b - previous.b);
+        const auto drg = std::int8_t(dr - dg);
+        const auto dbg = std::int8_t(db - dg);
+
+        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 &&
+            db <= 1) {
+          output.push_back(opDiff | (dr + 2) << 4 | (dg + 2) << 2 | (db + 2));
+        } else if (dg >= -32 && dg <= 31 && drg >= -8 && drg <= 7 &&
+                   dbg >= -8 && dbg <= 7) {
+          output.push_back(opLuma | (dg + 32));
+          output.push_back((drg + 8) << 4 | (dbg + 8));
+        } else {
+          output.insert(output.end(), { opRgb, color.r, color.g, color.b });
+        }
+      }
+      previous = color;
+    }
+  }
+
+  if (run > 0) {
+    output.push_back(opRun | (run - 1));
+  }
+  output.insert(output.end(), endMarker.begin(), endMarker.end());
+}
+} // namespace qoi
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Encoder of QOI images ("Quite OK Image Format", see qoiformat.org)
+ *
+ * Lossless & fast enough to encode captured frames in real time.
+ */
+namespace qoi {
+//! Encode ARGB8888 pixels (pitch in bytes) as RGB image, appending to output
+void
+encode(const std::uint32_t* pixels,
+       int width,
+       int height,
+       int pitch,
+       std::vector<std::uint8_t>& output);
+} // namespace qoi
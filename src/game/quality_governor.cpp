@@ -0,0 +1,153 @@
+#include "quality_governor.hpp"
+
+#include <algorithm>
+#include <array>
+#include <initializer_list>
+
+namespace {
+//! Weight of the newest frame in smoothed costs
+constexpr float costSmoothing = 0.1f;
+
+//! Ball microsteps from full quality to the coarsest one
+constexpr std::array<unsigned, 3> microstepLevels = {
+  Constants::ballMicrosteps,
+  Constants::ballMicrosteps / 2,
+  Constants::minBallMicrosteps
+};
+static_assert(microstepLevels[1] > microstepLevels[2]);
+
+std::size_t
+findMicrostepLevel(unsigned microsteps)
+{
+  const auto it = std::find_if(
+    microstepLevels.begin(), microstepLevels.end(), [&](unsigned level) {
+      return level <= microsteps;
+    });
+  return it == microstepLevels.end() ? microstepLevels.size() - 1
+                                     : it - microstepLevels.begin();
+}
+
+std::chrono::microseconds
+sumPhases(const ProfileFrame& frame,
+          std::initializer_list<ProfilePhase> phases)
+{
+  std::uint64_t ns = 0;
+  for (const auto phase : phases) {
+    ns += frame.phaseNs[static_cast<std::size_t>(phase)];
+  }
+  return std::chrono::microseconds(ns / 1000);
+}
+} // namespace
+
+QualityGovernor::QualityGovernor(const Settings& settings)
+  : m_settings(settings)
+{
+}
+
+QualityGovernor::QualityGovernor()
+  : QualityGovernor(Settings{})
+{
+}
+
+bool
+QualityGovernor::onFrame(std::chrono::microseconds updateTime,
+                         std::chrono::microseconds renderTime)
+{
+  const auto updateUs = static_cast<float>(updateTime.count());
+  const auto renderUs = static_cast<float>(renderTime.count());
+  if (m_hasCost) {
+    m_updateUs += (updateUs - m_updateUs) * costSmoothing;
+    m_renderUs += (renderUs - m_renderUs) * costSmoothing;
+  } else {
+    m_updateUs = updateUs;
+    m_renderUs = renderUs;
+    m_hasCost = true;
+  }
+
+  const auto costUs = m_updateUs + m_renderUs;
+  const auto targetUs = static_cast<float>(m_settings.targetFrameTime.count());
+  if (costUs > targetUs * m_settings.degradeRatio) {
+    m_headroomFrames = 0;
+    if (++m_overBudgetFrames < m_settings.degradeFrames) {
+      return false;
+    }
+    m_overBudgetFrames = 0;
+    return degrade();
+  }
+
+  m_overBudgetFrames = 0;
+  if (costUs < targetUs * m_settings.restoreRatio) {
+    if (++m_headroomFrames < m_settings.restoreFrames) {
+      return false;
+    }
+    m_headroomFrames = 0;
+    return restore();
+  }
+  m_headroomFrames = 0;
+  return false;
+}
+
+bool
+QualityGovernor::onFrame(const ProfileFrame& frame)
+{
+  // note: present is left out, with vsync it waits for vblank (most of
+  // frame), thus only work done by game itself is counted
+  return onFrame(sumPhases(frame,
+                           { ProfilePhase::events,
+                             ProfilePhase::pickups,
+                             ProfilePhase::dynamics,
+                             ProfilePhase::collisionDryRun,
+                             ProfilePhase::microstepping }),
+                 sumPhases(frame,
+                           { ProfilePhase::renderEntities,
+                             ProfilePhase::renderHUD }));
+}
+
+const QualitySettings&
+QualityGovernor::getQuality() const
+{
+  return m_quality;
+}
+
+unsigned
+QualityGovernor::getLevel() const
+{
+  return static_cast<unsigned>(findMicrostepLevel(m_quality.ballMicrosteps)) +
+         (m_quality.hasTileOverlay ? 0 : 1);
+}
+
+bool
+QualityGovernor::degrade()
+{
+  const auto microstepLevel = findMicrostepLevel(m_quality.ballMicrosteps);
+  const bool canReduceUpdate = microstepLevel + 1 < microstepLevels.size();
+
+  // note: reduce the part which costs more, the other one when it is at
+  // its lowest quality already
+  if (m_quality.hasTileOverlay &&
+      (m_renderUs >= m_updateUs || !canReduceUpdate)) {
+    m_quality.hasTileOverlay = false;
+    return true;
+  }
+  if (canReduceUpdate) {
+    m_quality.ballMicrosteps = microstepLevels[microstepLevel + 1];
+    return true;
+  }
+  return false;
+}
+
+bool
+QualityGovernor::restore()
+{
+  // note: collision accuracy is felt by player more than tile textures
+  const auto microstepLevel = findMicrostepLevel(m_quality.ballMicrosteps);
+  if (microstepLevel > 0) {
+    m_quality.ballMicrosteps = microstepLevels[microstepLevel - 1];
+    return true;
+  }
+  if (!m_quality.hasTileOverlay) {
+    m_quality.hasTileOverlay = true;
+    return true;
+  }
+  return false;
+}
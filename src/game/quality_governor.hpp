@@ -0,0 +1,80 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include "constants.hpp"
+#include "profiler.hpp"
+
+//! Optional work of frame, reduced when frames do not fit their budget
+struct QualitySettings
+{
+  //! Draw tile texture over tile colors
+  bool hasTileOverlay{ true };
+
+  //! Ball steps of update with potential collision (fewer steps: coarser
+  //! collision response, never tunneling as delta is clamped)
+  unsigned ballMicrosteps{ Constants::ballMicrosteps };
+
+  bool operator==(const QualitySettings& other) const = default;
+};
+
+/**
+ * @brief Keeps frames within budget by trading optional work
+ *
+ * Update & render costs of finished frames are smoothed (exponential moving
+ * average). When their sum stays over budget, the more expensive part is
+ * reduced by one level: render by dropping tile overlay, update by fewer ball
+ * microsteps. Quality is restored (microsteps first) only after a longer run
+ * of frames with headroom, thus it does not oscillate around the budget.
+ */
+class QualityGovernor
+{
+public:
+  struct Settings
+  {
+    std::chrono::microseconds targetFrameTime{ 16'667 };
+
+    //! Degrade when cost is over this part of target
+    float degradeRatio{ 0.9f };
+
+    //! Restore when cost is under this part of target
+    float restoreRatio{ 0.5f };
+
+    //! Consecutive frames over budget (resp. with headroom) needed to change
+    unsigned degradeFrames{ 15 };
+    unsigned restoreFrames{ 180 };
+  };
+
+  explicit QualityGovernor(const Settings& settings);
+  QualityGovernor();
+
+  //! Account cost of finished frame, returns true if quality changed
+  bool onFrame(std::chrono::microseconds updateTime,
+               std::chrono::microseconds renderTime);
+
+  //! Account frame measured by profiler (update & render phases, without
+  //! present)
+  bool onFrame(const ProfileFrame& frame);
+
+  const QualitySettings& getQuality() const;
+
+  //! Count of degradations in effect (zero: full quality)
+  unsigned getLevel() const;
+
+protected:
+  bool degrade();
+  bool restore();
+
+private:
+  Settings m_settings;
+  QualitySettings m_quality;
+
+  //! Smoothed costs (in microseconds)
+  float m_updateUs{ 0.0f };
+  float m_renderUs{ 0.0f };
+  bool m_hasCost{ false };
+
+  unsigned m_overBudgetFrames{ 0 };
+  unsigned m_headroomFrames{ 0 };
+};
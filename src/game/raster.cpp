@@ -0,0 +1,415 @@
+#include "raster.hpp"
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) ||            \
+  defined(_M_IX86)
+#define RASTER_X86
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+// note: kernels are compiled for their instruction set regardless of global
+// compiler flags, they are used only when CPU supports them
+#if defined(__GNUC__) || defined(__clang__)
+#define RASTER_TARGET(isa) __attribute__((target(isa)))
+#else
+#define RASTER_TARGET(isa)
+#endif
+
+namespace {
+constexpr std::uint32_t alphaMask = 0xFF000000;
+
+//! Exactly rounded x / 255 for x <= 255 * 255
+inline std::uint32_t
+div255(std::uint32_t x)
+{
+  x += 128;
+  return (x + (x >> 8)) >> 8;
+}
+
+inline std::uint32_t
+blendPixel(std::uint32_t destination, std::uint32_t source)
+{
+  const auto alpha = source >> 24;
+  if (alpha == 255) {
+    return source;
+  }
+  if (alpha == 0) {
+    return destination;
+  }
+
+  // note: source alpha is taken as 255 to get dstA = srcA + dstA * (1-srcA)
+  const auto opaqueSource = source | alphaMask;
+  const auto inverseAlpha = 255 - alpha;
+
+  std::uint32_t result = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    const auto s = (opaqueSource >> shift) & 0xFF;
+    const auto d = (destination >> shift) & 0xFF;
+    result |= div255(s * alpha + d * inverseAlpha) << shift;
+  }
+  return result;
+}
+
+void
+fillSpanScalar(std::uint32_t* destination, std::uint32_t color, int count)
+{
+  for (int i = 0; i < count; i++) {
+    destination[i] = color;
+  }
+}
+
+void
+blendSpanScalar(std::uint32_t* destination,
+                const std::uint32_t* source,
+                int count)
+{
+  for (int i = 0; i < count; i++) {
+    destination[i] = blendPixel(destination[i], source[i]);
+  }
+}
+
+void
+blendColorSpanScalar(std::uint32_t* destination, std::uint32_t color, int count)
+{
+  for (int i = 0; i < count; i++) {
+    destination[i] = blendPixel(destination[i], color);
+  }
+}
+
+void
+maxSpanScalar(std::uint8_t* destination, std::uint8_t value, int count)
+{
+  for (int i = 0; i < count; i++) {
+    destination[i] = destination[i] < value ? value : destination[i];
+  }
+}
+
+#ifdef RASTER_X86
+//! Blend 8-bit channels widened to 16-bit lanes
+RASTER_TARGET("sse2")
+inline __m128i
+blendChannels(__m128i source, __m128i destination, __m128i alpha)
+{
+  const auto inverseAlpha = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+  auto x = _mm_add_epi16(_mm_mullo_epi16(source, alpha),
+                         _mm_mullo_epi16(destination, inverseAlpha));
+  x = _mm_add_epi16(x, _mm_set1_epi16(128));
+  return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+//! Broadcast alpha of each pixel (lane 3 & 7) to its channels
+RASTER_TARGET("sse2")
+inline __m128i
+broadcastAlpha(__m128i pixels)
+{
+  return _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels, 0xFF), 0xFF);
+}
+
+RASTER_TARGET("sse2")
+inline __m128i
+blend4(__m128i destination, __m128i source)
+{
+  const auto zero = _mm_setzero_si128();
+  const auto opaqueSource = _mm_or_si128(source, _mm_set1_epi32(alphaMask));
+
+  const auto low = blendChannels(
+    _mm_unpacklo_epi8(opaqueSource, zero),
+    _mm_unpacklo_epi8(destination, zero),
+    broadcastAlpha(_mm_unpacklo_epi8(source, zero)));
+  const auto high = blendChannels(
+    _mm_unpackhi_epi8(opaqueSource, zero),
+    _mm_unpackhi_epi8(destination, zero),
+    broadcastAlpha(_mm_unpackhi_epi8(source, zero)));
+  return _mm_packus_epi16(low, high);
+}
+
+RASTER_TARGET("sse2")
+void
+fillSpanSse2(std::uint32_t* destination, std::uint32_t color, int count)
+{
+  const auto pixels = _mm_set1_epi32(color);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + i), pixels);
+  }
+  fillSpanScalar(destination + i, color, count - i);
+}
+
+RASTER_TARGET("sse2")
+void
+blendSpanSse2(std::uint32_t* destination, const std::uint32_t* source, int count)
+{
+  const auto mask = _mm_set1_epi32(alphaMask);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto* target = reinterpret_cast<__m128i*>(destination + i);
+    const auto s =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i));
+    const auto alpha = _mm_and_si128(s, mask);
+
+    // sprites are mostly fully opaque or fully transparent
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, mask)) == 0xFFFF) {
+      _mm_storeu_si128(target, s);
+      continue;
+    }
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(alpha, _mm_setzero_si128())) ==
+        0xFFFF) {
+      continue;
+    }
+
+    _mm_storeu_si128(target, blend4(_mm_loadu_si128(target), s));
+  }
+  blendSpanScalar(destination + i, source + i, count - i);
+}
+
+RASTER_TARGET("sse2")
+void
+blendColorSpanSse2(std::uint32_t* destination, std::uint32_t color, int count)
+{
+  const auto s = _mm_set1_epi32(color);
+  int i = 0;
+  for (; i + 4 <= count; i += 4) {
+    auto* target = reinterpret_cast<__m128i*>(destination + i);
+    _mm_storeu_si128(target, blend4(_mm_loadu_si128(target), s));
+  }
+  blendColorSpanScalar(destination + i, color, count - i);
+}
+
+RASTER_TARGET("sse2")
+void
+maxSpanSse2(std::uint8_t* destination, std::uint8_t value, int count)
+{
+  const auto values = _mm_set1_epi8(static_cast<char>(value));
+  int i = 0;
+  for (; i + 16 <= count; i += 16) {
+    auto* target = reinterpret_cast<__m128i*>(destination + i);
+    _mm_storeu_si128(target, _mm_max_epu8(_mm_loadu_si128(target), values));
+  }
+  maxSpanScalar(destination + i, value, count - i);
+}
+
+RASTER_TARGET("avx2")
+inline __m256i
+blendChannelsAvx2(__m256i source, __m256i destination, __m256i alpha)
+{
+  const auto inverseAlpha = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+  auto x = _mm256_add_epi16(_mm256_mullo_epi16(source, alpha),
+                            _mm256_mullo_epi16(destination, inverseAlpha));
+  x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+  return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+RASTER_TARGET("avx2")
+inline __m256i
+broadcastAlphaAvx2(__m256i pixels)
+{
+  return _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels, 0xFF), 0xFF);
+}
+
+//! Note: unpack & pack work within 128-bit lanes, the order is preserved
+RASTER_TARGET("avx2")
+inline __m256i
+blend8(__m256i destination, __m256i source)
+{
+  const auto zero = _mm256_setzero_si256();
+  const auto opaqueSource =
+    _mm256_or_si256(source, _mm256_set1_epi32(alphaMask));
+
+  const auto low = blendChannelsAvx2(
+    _mm256_unpacklo_epi8(opaqueSource, zero),
+    _mm256_unpacklo_epi8(destination, zero),
+    broadcastAlphaAvx2(_mm256_unpacklo_epi8(source, zero)));
+  const auto high = blendChannelsAvx2(
+    _mm256_unpackhi_epi8(opaqueSource, zero),
+    _mm256_unpackhi_epi8(destination, zero),
+    broadcastAlphaAvx2(_mm256_unpackhi_epi8(source, zero)));
+  return _mm256_packus_epi16(low, high);
+}
+
+RASTER_TARGET("avx2")
+void
+fillSpanAvx2(std::uint32_t* destination, std::uint32_t color, int count)
+{
+  const auto pixels = _mm256_set1_epi32(color);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(destination + i), pixels);
+  }
+  fillSpanScalar(destination + i, color, count - i);
+}
+
+RASTER_TARGET("avx2")
+void
+blendSpanAvx2(std::uint32_t* destination, const std::uint32_t* source, int count)
+{
+  const auto mask = _mm256_set1_epi32(alphaMask);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    auto* target = reinterpret_cast<__m256i*>(destination + i);
+    const auto s =
+      _mm256_loadu_si256(reinterpret_cast<const __m256i*>(source + i));
+    const auto alpha = _mm256_and_si256(s, mask);
+
+    // sprites are mostly fully opaque or fully transparent
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(alpha, mask)) == -1) {
+      _mm256_storeu_si256(target, s);
+      continue;
+    }
+    if (_mm256_movemask_epi8(
+          _mm256_cmpeq_epi32(alpha, _mm256_setzero_si256())) == -1) {
+      continue;
+    }
+
+    _mm256_storeu_si256(target, blend8(_mm256_loadu_si256(target), s));
+  }
+  blendSpanScalar(destination + i, source + i, count - i);
+}
+
+RASTER_TARGET("avx2")
+void
+blendColorSpanAvx2(std::uint32_t* destination, std::uint32_t color, int count)
+{
+  const auto s = _mm256_set1_epi32(color);
+  int i = 0;
+  for (; i + 8 <= count; i += 8) {
+    auto* target = reinterpret_cast<__m256i*>(destination + i);
+    _mm256_storeu_si256(target, blend8(_mm256_loadu_si256(target), s));
+  }
+  blendColorSpanScalar(destination + i, color, count - i);
+}
+
+RASTER_TARGET("avx2")
+void
+maxSpanAvx2(std::uint8_t* destination, std::uint8_t value, int count)
+{
+  const auto values = _mm256_set1_epi8(static_cast<char>(value));
+  int i = 0;
+  for (; i + 32 <= count; i += 32) {
+    auto* target = reinterpret_cast<__m256i*>(destination + i);
+    _mm256_storeu_si256(target,
+                        _mm256_max_epu8(_mm256_loadu_si256(target), values));
+  }
+  maxSpanScalar(destination + i, value, count - i);
+}
+
+bool
+hasSse2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("sse2");
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 1);
+  return info[3] & (1 << 26);
+#else
+  return false;
+#endif
+}
+
+bool
+hasAvx2()
+{
+#if defined(__GNUC__) || defined(__clang__)
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx2");
+#elif defined(_MSC_VER)
+  int info[4];
+  __cpuid(info, 0);
+  if (info[0] < 7) {
+    return false;
+  }
+
+  // note: OS must save AVX registers on context switch
+  __cpuid(info, 1);
+  const bool hasOsxsave = info[2] & (1 << 27);
+  const bool hasAvx = info[2] & (1 << 28);
+  if (!hasOsxsave || !hasAvx || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+
+  __cpuidex(info, 7, 0);
+  return info[1] & (1 << 5);
+#else
+  return false;
+#endif
+}
+#endif
+
+struct Kernels
+{
+  void (*fillSpan)(std::uint32_t*, std::uint32_t, int);
+  void (*blendSpan)(std::uint32_t*, const std::uint32_t*, int);
+  void (*blendColorSpan)(std::uint32_t*, std::uint32_t, int);
+  void (*maxSpan)(std::uint8_t*, std::uint8_t, int);
+  const char* name;
+};
+
+Kernels
+selectKernels()
+{
+#ifdef RASTER_X86
+  if (hasAvx2()) {
+    return Kernels{
+      fillSpanAvx2, blendSpanAvx2, blendColorSpanAvx2, maxSpanAvx2, "avx2"
+    };
+  }
+  if (hasSse2()) {
+    return Kernels{
+      fillSpanSse2, blendSpanSse2, blendColorSpanSse2, maxSpanSse2, "sse2"
+    };
+  }
+#endif
+  return Kernels{ fillSpanScalar,
+                  blendSpanScalar,
+                  blendColorSpanScalar,
+                  maxSpanScalar,
+                  "scalar" };
+}
+
+const Kernels&
+getKernels()
+{
+  static const Kernels kernels = selectKernels();
+  return kernels;
+}
+} // namespace
+
+namespace raster {
+void
+fillSpan(std::uint32_t* destination, std::uint32_t color, int count)
+{
+  getKernels().fillSpan(destination, color, count);
+}
+
+void
+blendSpan(std::uint32_t* destination, const std::uint32_t* source, int count)
+{
+  getKernels().blendSpan(destination, source, count);
+}
+
+void
+blendColorSpan(std::uint32_t* destination, std::uint32_t color, int count)
+{
+  const auto alpha = color >> 24;
+  if (alpha == 255) {
+    getKernels().fillSpan(destination, color, count);
+  } else if (alpha > 0) {
+    getKernels().blendColorSpan(destination, color, count);
+  }
+}
+
+void
+maxSpan(std::uint8_t* destination, std::uint8_t value, int count)
+{
+  getKernels().maxSpan(destination, value, count);
+}
+
+const char*
+getKernelName()
+{
+  return getKernels().name;
+}
+} // namespace raster
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Span kernels of software rasterizer, working on ARGB8888 pixels
+ * (and on 8-bit cells of occupancy grids)
+ *
+ * Kernels are vectorized by AVX2 or SSE2 (chosen once by CPU features) with
+ * scalar fallback. Blending follows SDL_BLENDMODE_BLEND with non-premultiplied
+ * alpha: dstRGB = srcRGB * srcA + dstRGB * (1 - srcA),
+ *        dstA = srcA + dstA * (1 - srcA).
+ */
+namespace raster {
+//! Overwrite pixels by color
+void
+fillSpan(std::uint32_t* destination, std::uint32_t color, int count);
+
+//! Blend pixels of source over destination
+void
+blendSpan(std::uint32_t* destination, const std::uint32_t* source, int count);
+
+//! Blend single color over destination
+void
+blendColorSpan(std::uint32_t* destination, std::uint32_t color, int count);
+
+//! Raise cells below value to value (keeps the higher one)
+void
+maxSpan(std::uint8_t* destination, std::uint8_t value, int count);
+
+//! Instruction set used by kernels ("avx2", "sse2" or "scalar")
+const char*
+getKernelName();
+
+//! Pack color into ARGB8888 pixel
+constexpr std::uint32_t
+toPixel(std::uint8_t r, std::uint8_t g, std::uint8_t b, std::uint8_t a)
+{
+  return (std::uint32_t(a) << 24) | (std::uint32_t(r) << 16) |
+         (std::uint32_t(g) << 8) | std::uint32_t(b);
+}
+} // namespace raster
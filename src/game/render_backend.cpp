@@ -0,0 +1,16 @@
+#include "render_backend.hpp"
+
+#include "sdl_render_backend.hpp"
+#include "software_render_backend.hpp"
+
+std::unique_ptr<RenderBackend>
+createRenderBackend(RenderBackendType type, SDL_Window* window, bool isHeadless)
+{
+  switch (type) {
+    case RenderBackendType::software:
+      return std::make_unique<SoftwareRenderBackend>(window);
+    case RenderBackendType::sdl:
+    default:
+      return std::make_unique<SdlRenderBackend>(window, isHeadless);
+  }
+}
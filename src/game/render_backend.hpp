@@ -0,0 +1,78 @@
+#pragma once
+
+#include <SDL.h>
+#include <memory>
+
+//! Image owned by render backend (opaque, its content depends on backend)
+struct Texture;
+
+enum class RenderBackendType
+{
+  //! SDL's 2D renderer (GPU accelerated if available)
+  sdl,
+
+  //! Own rasterizer writing into window's framebuffer (CPU only)
+  software
+};
+
+/**
+ * @brief Draws primitives of the game into window
+ *
+ * All draws are given in fixed logical resolution (Constants::screenWidth x
+ * Constants::screenHeight), backend scales them by whole multiples into
+ * window and letterboxes the rest.
+ */
+class RenderBackend
+{
+public:
+  virtual ~RenderBackend() = default;
+
+  //! Create texture from pixels of surface (any format), nullptr on failure
+  virtual Texture* createTexture(SDL_Surface* surface) = 0;
+
+  //! Overwrite part of texture by pixels of surface (of the same size)
+  virtual void updateTexture(Texture* texture,
+                             const SDL_Rect& rect,
+                             SDL_Surface* surface) = 0;
+
+  //! Note: textures left are destroyed together with backend
+  virtual void destroyTexture(Texture* texture) = 0;
+
+  virtual SDL_Point getTextureSize(Texture* texture) const = 0;
+
+  //! Largest texture that can be created
+  virtual SDL_Point getMaxTextureSize() const = 0;
+
+  //! Size of window's drawable area in physical pixels
+  virtual SDL_Point getOutputSize() const = 0;
+
+  //! Start frame by clearing whole window
+  virtual void beginFrame(SDL_Color clearColor) = 0;
+
+  //! Restrict drawing to rectangle (whole target if null), following draws
+  //! are relative to it
+  virtual void setViewport(const SDL_Rect* viewport) = 0;
+
+  virtual void fillRect(const SDL_Rect& rect,
+                        SDL_Color color,
+                        SDL_BlendMode blendMode) = 0;
+
+  //! Copy part of texture (whole if source is null) to destination (whole
+  //! viewport if null), blending it by its alpha
+  virtual void copy(Texture* texture,
+                    const SDL_Rect* source,
+                    const SDL_Rect* destination) = 0;
+
+  //! Finish & present frame
+  virtual void endFrame() = 0;
+
+  //! Read pixels drawn so far in this frame (in logical resolution) into
+  //! ARGB8888 surface of logical size, returns false on failure
+  virtual bool readPixels(SDL_Surface* target) = 0;
+};
+
+//! Create backend of given type for window (throws std::runtime_error)
+std::unique_ptr<RenderBackend>
+createRenderBackend(RenderBackendType type,
+                    SDL_Window* window,
+                    bool isHeadless);
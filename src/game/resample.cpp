@@ -0,0 +1,143 @@
+#include "resample.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+namespace {
+//! Source pixel contributing to target pixel
+struct Weight
+{
+  int index;
+  float weight;
+};
+
+//! Color with premultiplied alpha (channels in 0..255)
+struct Premultiplied
+{
+  float a = { 0 };
+  float r = { 0 };
+  float g = { 0 };
+  float b = { 0 };
+
+  void add(const Premultiplied& other, float weight)
+  {
+    a += other.a * weight;
+    r += other.r * weight;
+    g += other.g * weight;
+    b += other.b * weight;
+  }
+};
+
+//! Source pixels covered by each target pixel of axis, weighted by coverage
+std::vector<std::vector<Weight>>
+computeWeights(int sourceSize, int targetSize)
+{
+  const float scale = static_cast<float>(sourceSize) / targetSize;
+
+  std::vector<std::vector<Weight>> weights(targetSize);
+  for (int i = 0; i < targetSize; i++) {
+    const float begin = i * scale;
+    const float end = (i + 1) * scale;
+
+    float total = 0;
+    const auto last = std::min(static_cast<int>(std::ceil(end)), sourceSize);
+    for (int s = static_cast<int>(begin); s < last; s++) {
+      const float coverage =
+        std::min(end, s + 1.0f) - std::max(begin, static_cast<float>(s));
+      if (coverage > 0) {
+        weights[i].push_back(Weight{ s, coverage });
+        total += coverage;
+      }
+    }
+
+    for (auto& weight : weights[i]) {
+      weight.weight /= total;
+    }
+  }
+  return weights;
+}
+
+Premultiplied
+toPremultiplied(std::uint32_t pixel)
+{
+  const float alpha = (pixel >> 24) / 255.0f;
+  return Premultiplied{ alpha * 255.0f,
+                        ((pixel >> 16) & 0xFF) * alpha,
+                        ((pixel >> 8) & 0xFF) * alpha,
+                        (pixel & 0xFF) * alpha };
+}
+
+std::uint32_t
+toPixel(const Premultiplied& color)
+{
+  if (color.a <= 0) {
+    return 0;
+  }
+
+  const float unpremultiply = 255.0f / color.a;
+  const auto channel = [](float value) {
+    return static_cast<std::uint32_t>(std::clamp(value + 0.5f, 0.0f, 255.0f));
+  };
+  return channel(color.a) << 24 | channel(color.r * unpremultiply) << 16 |
+         channel(color.g * unpremultiply) << 8 |
+         channel(color.b * unpremultiply);
+}
+
+std::uint32_t*
+getRow(SDL_Surface* surface, int y)
+{
+  return reinterpret_cast<std::uint32_t*>(
+    static_cast<std::uint8_t*>(surface->pixels) + y * surface->pitch);
+}
+} // namespace
+
+namespace resample {
+utils::RaiiOwnership<SDL_Surface>
+scaleAreaAverage(SDL_Surface* source, SDL_Point size)
+{
+  const auto freeSurface = [](SDL_Surface* surface) {
+    SDL_FreeSurface(surface);
+  };
+  const auto converted = utils::make_raii_deleter<SDL_Surface>(
+    utils::throw_if_null(
+      SDL_ConvertSurfaceFormat(source, SDL_PIXELFORMAT_ARGB8888, 0),
+      "Failed to convert image for scaling"),
+    freeSurface);
+  auto target = utils::make_raii_deleter<SDL_Surface>(
+    utils::throw_if_null(
+      SDL_CreateRGBSurfaceWithFormat(
+        0, size.x, size.y, 32, SDL_PIXELFORMAT_ARGB8888),
+      "Failed to allocate scaled image"),
+    freeSurface);
+
+  const auto columns = computeWeights(converted->w, size.x);
+  const auto rows = computeWeights(converted->h, size.y);
+
+  // horizontal pass: each source row scaled to target width
+  std::vector<Premultiplied> scaledRows(converted->h * size.x);
+  for (int y = 0; y < converted->h; y++) {
+    const auto* row = getRow(converted.get(), y);
+    for (int x = 0; x < size.x; x++) {
+      auto& color = scaledRows[y * size.x + x];
+      for (const auto& column : columns[x]) {
+        color.add(toPremultiplied(row[column.index]), column.weight);
+      }
+    }
+  }
+
+  // vertical pass
+  for (int y = 0; y < size.y; y++) {
+    auto* row = getRow(target.get(), y);
+    for (int x = 0; x < size.x; x++) {
+      Premultiplied color;
+      for (const auto& sourceRow : rows[y]) {
+        color.add(scaledRows[sourceRow.index * size.x + x], sourceRow.weight);
+      }
+      row[x] = toPixel(color);
+    }
+  }
+  return target;
+}
+} // namespace resample
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <SDL.h>
+
+#include "utils.hpp"
+
+/**
+ * @brief Scaling of images with filtering (done once, not per frame)
+ */
+namespace resample {
+//! Scale image (any format) to given size as ARGB8888 surface. Each target
+//! pixel averages the source area it covers (weighted by alpha, so that
+//! transparent pixels do not darken edges). Throws std::runtime_error.
+utils::RaiiOwnership<SDL_Surface>
+scaleAreaAverage(SDL_Surface* source, SDL_Point size);
+} // namespace resample
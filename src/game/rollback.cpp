@@ -0,0 +1,267 @@
+#include "rollback.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+constexpr std::array<char, 4> packetMagic = { 'A', 'R', 'K', 'R' };
+
+//! Inputs of single datagram (count is stored in a byte)
+constexpr std::uint64_t maxPacketInputs = 255;
+} // namespace
+
+RollbackSession::RollbackSession(Transport& transport,
+                                 const Settings& settings)
+  : m_transport(transport)
+  , m_settings(settings)
+  , m_localInputs(historySize, AgentAction::none)
+  , m_remoteInputs(historySize, AgentAction::none)
+  , m_usedRemoteInputs(historySize, AgentAction::none)
+  , m_localChecksums(historySize, 0)
+  , m_remoteChecksums(historySize, 0)
+  , m_remoteStates(settings.maxRollbackFrames + 1)
+{
+  if (settings.localPlayer >= playerCount) {
+    throw std::runtime_error("Invalid local player");
+  }
+  if (settings.maxRollbackFrames == 0 ||
+      settings.maxRollbackFrames >= maxPacketInputs / 2) {
+    throw std::runtime_error("Invalid count of rollback frames");
+  }
+
+  // both players start the same level, with the same random sequence
+  for (auto& world : m_worlds) {
+    world.setRandomSeed(settings.seed);
+    world.setDeterministic(true);
+    world.restartLevel();
+  }
+}
+
+bool
+RollbackSession::advanceFrame(AgentAction localInput)
+{
+  receiveInputs();
+  if (m_mispredictedFrame) {
+    rollback(*std::exchange(m_mispredictedFrame, std::nullopt));
+  }
+  verifyChecksum();
+
+  // note: peer keeps unacknowledged inputs only for a limited history
+  if (m_frame >= m_confirmedFrame + m_settings.maxRollbackFrames ||
+      m_frame >= m_ackedFrame + maxPacketInputs) {
+    m_stats.stalledFrames++;
+    sendInputs();
+    return false;
+  }
+
+  m_localInputs[m_frame % historySize] = localInput;
+  auto& localWorld = getLocalWorld();
+  localWorld.applyAction(localInput);
+  localWorld.update(frameDelta);
+  m_localChecksums[m_frame % historySize] = localWorld.getStateChecksum();
+
+  simulateRemoteFrame(m_frame);
+  m_frame++;
+
+  sendInputs();
+  return true;
+}
+
+std::uint64_t
+RollbackSession::getFrame() const
+{
+  return m_frame;
+}
+
+std::uint64_t
+RollbackSession::getConfirmedFrame() const
+{
+  return m_confirmedFrame;
+}
+
+World&
+RollbackSession::getWorld(unsigned player)
+{
+  return m_worlds.at(player);
+}
+
+unsigned
+RollbackSession::getLocalPlayer() const
+{
+  return m_settings.localPlayer;
+}
+
+bool
+RollbackSession::isDesynced() const
+{
+  return m_isDesynced;
+}
+
+const RollbackSession::Stats&
+RollbackSession::getStats() const
+{
+  return m_stats;
+}
+
+void
+RollbackSession::receiveInputs()
+{
+  while (const auto datagram = m_transport.receive()) {
+    PacketHeader header;
+    if (datagram->size() < sizeof(header)) {
+      continue;
+    }
+    std::memcpy(&header, datagram->data(), sizeof(header));
+    if (header.magic != packetMagic ||
+        datagram->size() != sizeof(header) + header.inputCount) {
+      continue;
+    }
+
+    m_ackedFrame = std::max<std::uint64_t>(m_ackedFrame, header.ackFrame);
+    const auto isNewerChecksum =
+      !m_pendingChecksum || m_pendingChecksum->first < header.checksumFrame;
+    if (header.hasChecksum && isNewerChecksum) {
+      m_pendingChecksum = { header.checksumFrame, header.checksum };
+    }
+
+    // note: inputs must be contiguous, older ones are duplicates
+    const auto* inputs = datagram->data() + sizeof(header);
+    for (std::uint64_t i = 0; i < header.inputCount; i++) {
+      const auto frame = header.firstFrame + i;
+      if (frame < m_confirmedFrame) {
+        continue;
+      }
+      if (frame > m_confirmedFrame ||
+          static_cast<unsigned>(inputs[i]) >
+            static_cast<unsigned>(AgentAction::release)) {
+        break;
+      }
+
+      const auto input = static_cast<AgentAction>(inputs[i]);
+      m_remoteInputs[frame % historySize] = input;
+      if (frame < m_frame &&
+          m_usedRemoteInputs[frame % historySize] != input) {
+        m_mispredictedFrame =
+          std::min(m_mispredictedFrame.value_or(frame), frame);
+      }
+      m_confirmedFrame++;
+    }
+  }
+}
+
+void
+RollbackSession::sendInputs()
+{
+  // all inputs which peer has not acknowledged yet
+  const auto firstFrame =
+    std::max(m_ackedFrame, m_frame - std::min(m_frame, maxPacketInputs));
+  const auto inputCount = m_frame - firstFrame;
+
+  PacketHeader header{};
+  header.magic = packetMagic;
+  header.firstFrame = static_cast<std::uint32_t>(firstFrame);
+  header.ackFrame = static_cast<std::uint32_t>(m_confirmedFrame);
+  header.inputCount = static_cast<std::uint8_t>(inputCount);
+
+  // world after the last frame whose input peer has (its replica is final)
+  const auto checksumFrame = std::min(m_ackedFrame, m_frame);
+  if (checksumFrame > 0 && m_frame - checksumFrame < historySize) {
+    header.hasChecksum = 1;
+    header.checksumFrame = static_cast<std::uint32_t>(checksumFrame - 1);
+    header.checksum = m_localChecksums[(checksumFrame - 1) % historySize];
+  }
+
+  Datagram datagram(sizeof(header) + inputCount);
+  std::memcpy(datagram.data(), &header, sizeof(header));
+  for (std::uint64_t i = 0; i < inputCount; i++) {
+    datagram[sizeof(header) + i] = static_cast<std::byte>(
+      m_localInputs[(firstFrame + i) % historySize]);
+  }
+  m_transport.send(datagram);
+}
+
+void
+RollbackSession::rollback(std::uint64_t frame)
+{
+  const auto beginning = std::chrono::steady_clock::now();
+  const auto depth = static_cast<unsigned>(m_frame - frame);
+
+  getRemoteWorld().restoreState(
+    m_remoteStates[frame % m_remoteStates.size()]);
+  for (auto resimulated = frame; resimulated < m_frame; resimulated++) {
+    simulateRemoteFrame(resimulated);
+  }
+
+  m_stats.rollbacks++;
+  m_stats.resimulatedFrames += depth;
+  m_stats.maxRollbackDepth = std::max(m_stats.maxRollbackDepth, depth);
+  m_stats.maxRollbackTime = std::max(
+    m_stats.maxRollbackTime,
+    std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - beginning));
+}
+
+void
+RollbackSession::verifyChecksum()
+{
+  if (!m_pendingChecksum) {
+    return;
+  }
+
+  // note: only frames simulated with received inputs can be compared
+  const auto [frame, checksum] = *m_pendingChecksum;
+  if (frame >= m_frame || frame >= m_confirmedFrame) {
+    return;
+  }
+  m_pendingChecksum.reset();
+  if (m_frame - frame > historySize) {
+    return;
+  }
+
+  m_stats.verifiedChecksums++;
+  if (m_remoteChecksums[frame % historySize] != checksum) {
+    m_isDesynced = true;
+  }
+}
+
+void
+RollbackSession::simulateRemoteFrame(std::uint64_t frame)
+{
+  auto& world = getRemoteWorld();
+  world.saveState(m_remoteStates[frame % m_remoteStates.size()]);
+
+  const auto input = getRemoteInput(frame);
+  m_usedRemoteInputs[frame % historySize] = input;
+  world.applyAction(input);
+  world.update(frameDelta);
+  m_remoteChecksums[frame % historySize] = world.getStateChecksum();
+}
+
+AgentAction
+RollbackSession::getRemoteInput(std::uint64_t frame) const
+{
+  if (frame < m_confirmedFrame) {
+    return m_remoteInputs[frame % historySize];
+  }
+  if (m_confirmedFrame == 0) {
+    return AgentAction::none;
+  }
+
+  // predict: player keeps moving, but does not release the ball again
+  const auto last = m_remoteInputs[(m_confirmedFrame - 1) % historySize];
+  return last == AgentAction::release ? AgentAction::none : last;
+}
+
+World&
+RollbackSession::getLocalWorld()
+{
+  return m_worlds[m_settings.localPlayer];
+}
+
+World&
+RollbackSession::getRemoteWorld()
+{
+  return m_worlds[1 - m_settings.localPlayer];
+}
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+#include "transport.hpp"
+#include "world.hpp"
+
+/**
+ * @brief Two-player versus kept in sync by rollback, peers exchange inputs
+ *
+ * Each peer simulates both players' worlds (seeded equally) in fixed frames.
+ * Local input is applied immediately, input of remote player is predicted
+ * (repeated) until it arrives. When it turns out to be mispredicted, remote
+ * world is restored to the state saved before that frame and re-simulated
+ * up to the present within the same call.
+ *
+ * Datagrams carry all local inputs not yet acknowledged by peer, thus lost
+ * datagrams are recovered by the next ones. Session stalls instead of
+ * running more than maxRollbackFrames ahead of confirmed remote input.
+ * Checksums of worlds are exchanged to detect diverged simulations.
+ */
+class RollbackSession
+{
+public:
+  //! Simulated time of single frame
+  static constexpr auto frameDelta = std::chrono::microseconds(16'667);
+
+  static constexpr unsigned playerCount = 2;
+
+  struct Settings
+  {
+    //! Index of player controlled by this peer (0 or 1)
+    unsigned localPlayer = { 0 };
+
+    //! Must be the same on both peers
+    unsigned seed = { 1 };
+
+    //! How many frames may be predicted (and re-simulated at once)
+    unsigned maxRollbackFrames = { 8 };
+  };
+
+  struct Stats
+  {
+    std::uint64_t rollbacks = { 0 };
+    std::uint64_t resimulatedFrames = { 0 };
+    std::uint64_t stalledFrames = { 0 };
+    std::uint64_t verifiedChecksums = { 0 };
+    unsigned maxRollbackDepth = { 0 };
+
+    //! Real time of the longest rollback (restore & re-simulation)
+    std::chrono::microseconds maxRollbackTime{ 0 };
+  };
+
+  //! Transport must outlive session
+  RollbackSession(Transport& transport, const Settings& settings);
+
+  RollbackSession(const RollbackSession&) = delete;
+  RollbackSession& operator=(const RollbackSession&) = delete;
+
+  //! Receive remote inputs (rolling back when mispredicted) and simulate the
+  //! next frame with local input. Returns false if session is stalled,
+  //! waiting for remote inputs (frame is not simulated then).
+  bool advanceFrame(AgentAction localInput);
+
+  //! Count of simulated frames
+  std::uint64_t getFrame() const;
+
+  //! Count of frames with received remote input
+  std::uint64_t getConfirmedFrame() const;
+
+  World& getWorld(unsigned player);
+  unsigned getLocalPlayer() const;
+
+  //! Checksum of remote world differs from one computed by peer
+  bool isDesynced() const;
+
+  const Stats& getStats() const;
+
+protected:
+  //! Wire format of datagram (little-endian), followed by inputs
+  struct PacketHeader
+  {
+    std::array<char, 4> magic;
+
+    //! Frame of the first input
+    std::uint32_t firstFrame;
+
+    //! Count of frames with received input of receiver
+    std::uint32_t ackFrame;
+
+    //! Checksum of sender's world after frame (if hasChecksum)
+    std::uint32_t checksumFrame;
+    std::uint64_t checksum;
+
+    std::uint8_t inputCount;
+    std::uint8_t hasChecksum;
+    std::uint16_t reserved;
+  };
+  static_assert(sizeof(PacketHeader) == 32);
+
+  void receiveInputs();
+  void sendInputs();
+
+  //! Restore remote world before mispredicted frame, re-simulate to present
+  void rollback(std::uint64_t frame);
+
+  //! Compare received checksum with checksum of re-simulated remote world
+  void verifyChecksum();
+
+  //! Step remote world by one frame (state before it is saved)
+  void simulateRemoteFrame(std::uint64_t frame);
+
+  //! Received input of remote player, or prediction if not received yet
+  AgentAction getRemoteInput(std::uint64_t frame) const;
+
+  World& getLocalWorld();
+  World& getRemoteWorld();
+
+private:
+  //! Capacity of input & checksum history (in frames)
+  static constexpr std::size_t historySize = 256;
+
+  Transport& m_transport;
+  Settings m_settings;
+  std::array<World, playerCount> m_worlds;
+
+  std::uint64_t m_frame = { 0 };
+
+  //! Inputs & checksums of frames (ring buffers of historySize)
+  std::vector<AgentAction> m_localInputs;
+  std::vector<AgentAction> m_remoteInputs;
+  std::vector<AgentAction> m_usedRemoteInputs;
+  std::vector<std::uint64_t> m_localChecksums;
+  std::vector<std::uint64_t> m_remoteChecksums;
+
+  //! States of remote world before frames (ring of maxRollbackFrames + 1)
+  std::vector<WorldSnapshot> m_remoteStates;
+
+  //! Count of frames with received remote input
+  std::uint64_t m_confirmedFrame = { 0 };
+
+  //! Count of frames with local input received by peer
+  std::uint64_t m_ackedFrame = { 0 };
+
+  //! The first mispredicted frame (since the last rollback)
+  std::optional<std::uint64_t> m_mispredictedFrame;
+
+  //! Received checksum of peer's world waiting for verification
+  std::optional<std::pair<std::uint64_t, std::uint64_t>> m_pendingChecksum;
+
+  bool m_isDesynced = { false };
+  Stats m_stats;
+};
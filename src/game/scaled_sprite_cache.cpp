@@ -0,0 +1,148 @@
+#include "scaled_sprite_cache.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+ScaledSpriteCache::ScaledSpriteCache(SDL_Point atlasSize)
+  : m_allocator(atlasSize)
+{
+  // note: sizes of sprites are packed into keys by 16 bits
+  assert(atlasSize.x <= 0xFFFF && atlasSize.y <= 0xFFFF);
+}
+
+const SDL_Rect*
+ScaledSpriteCache::find(SpriteHandle handle, SDL_Point size)
+{
+  if (!canFit(size)) {
+    return nullptr;
+  }
+
+  const auto it = m_entries.find(makeKey(handle, size));
+  if (it == m_entries.end()) {
+    return nullptr;
+  }
+  it->second.lastUsedFrame = m_frame;
+  return &it->second.rect;
+}
+
+std::optional<SDL_Rect>
+ScaledSpriteCache::insert(SpriteHandle handle, SDL_Point size)
+{
+  if (!canFit(size) || m_isFull) {
+    return std::nullopt;
+  }
+
+  // fresh space first, then space of evicted sprites
+  auto rect = m_allocator.allocate(size);
+  while (!rect) {
+    rect = takeFreeRect(size);
+    if (!rect && !evictLeastRecentlyUsed()) {
+      // note: only sprites of this frame are left (or free space is
+      // fragmented), atlas can not be freed until the frame ends
+      m_isFull = true;
+      return std::nullopt;
+    }
+  }
+
+  m_entries[makeKey(handle, size)] = Entry{ *rect, m_frame };
+  return rect;
+}
+
+void
+ScaledSpriteCache::beginFrame()
+{
+  m_frame++;
+  if (m_isFull) {
+    clear();
+  }
+}
+
+void
+ScaledSpriteCache::evictUnused(unsigned maxUnusedFrames)
+{
+  std::erase_if(m_entries, [&](const auto& item) {
+    const auto& entry = item.second;
+    if (entry.lastUsedFrame + maxUnusedFrames >= m_frame) {
+      return false;
+    }
+    m_freeRects.push_back(entry.rect);
+    return true;
+  });
+}
+
+void
+ScaledSpriteCache::clear()
+{
+  m_entries.clear();
+  m_freeRects.clear();
+  m_allocator.clear();
+  m_isFull = false;
+}
+
+SDL_Point
+ScaledSpriteCache::getAtlasSize() const
+{
+  return m_allocator.getSize();
+}
+
+std::size_t
+ScaledSpriteCache::getCount() const
+{
+  return m_entries.size();
+}
+
+ScaledSpriteCache::Key
+ScaledSpriteCache::makeKey(SpriteHandle handle, SDL_Point size)
+{
+  return static_cast<Key>(handle.index) << 32 |
+         static_cast<Key>(size.x & 0xFFFF) << 16 |
+         static_cast<Key>(size.y & 0xFFFF);
+}
+
+bool
+ScaledSpriteCache::canFit(SDL_Point size) const
+{
+  const auto atlasSize = m_allocator.getSize();
+  return size.x > 0 && size.y > 0 && size.x < atlasSize.x &&
+         size.y < atlasSize.y;
+}
+
+std::optional<SDL_Rect>
+ScaledSpriteCache::takeFreeRect(SDL_Point size)
+{
+  auto best = m_freeRects.end();
+  for (auto it = m_freeRects.begin(); it != m_freeRects.end(); it++) {
+    if (it->w >= size.x && it->h >= size.y &&
+        (best == m_freeRects.end() || it->w * it->h < best->w * best->h)) {
+      best = it;
+    }
+  }
+  if (best == m_freeRects.end()) {
+    return std::nullopt;
+  }
+
+  // note: rest of freed rectangle stays unused until atlas is freed
+  const auto rect = SDL_Rect{ best->x, best->y, size.x, size.y };
+  m_freeRects.erase(best);
+  return rect;
+}
+
+bool
+ScaledSpriteCache::evictLeastRecentlyUsed()
+{
+  auto oldest = m_entries.end();
+  for (auto it = m_entries.begin(); it != m_entries.end(); it++) {
+    if (it->second.lastUsedFrame != m_frame &&
+        (oldest == m_entries.end() ||
+         it->second.lastUsedFrame < oldest->second.lastUsedFrame)) {
+      oldest = it;
+    }
+  }
+  if (oldest == m_entries.end()) {
+    return false;
+  }
+
+  m_freeRects.push_back(oldest->second.rect);
+  m_entries.erase(oldest);
+  return true;
+}
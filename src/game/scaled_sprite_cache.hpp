@@ -0,0 +1,80 @@
+#pragma once
+
+#include <SDL.h>
+#include <cstdint>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include "atlas.hpp"
+
+/**
+ * @brief Placements of sprites scaled at runtime within single atlas texture
+ *
+ * Only bookkeeping, owner of atlas uploads pixels into returned rectangles.
+ * When atlas has no free space, rectangles of the least recently used
+ * sprites are reused. Sprites used during current frame are never evicted
+ * (they may still be referenced by recorded draws); if space can not be
+ * found without them, the whole atlas is freed at start of next frame.
+ */
+class ScaledSpriteCache
+{
+public:
+  explicit ScaledSpriteCache(SDL_Point atlasSize);
+
+  //! Get placement of sprite scaled to size & mark it as used in this frame,
+  //! nullptr if missing
+  const SDL_Rect* find(SpriteHandle handle, SDL_Point size);
+
+  //! Place sprite scaled to size, std::nullopt if there is no space now
+  std::optional<SDL_Rect> insert(SpriteHandle handle, SDL_Point size);
+
+  //! Mark start of frame (sprites of previous frames can be evicted)
+  void beginFrame();
+
+  //! Evict sprites not used during last maxUnusedFrames frames
+  void evictUnused(unsigned maxUnusedFrames);
+
+  //! Free whole atlas
+  void clear();
+
+  SDL_Point getAtlasSize() const;
+
+  //! Count of placed sprites
+  std::size_t getCount() const;
+
+protected:
+  struct Entry
+  {
+    SDL_Rect rect;
+    std::uint64_t lastUsedFrame;
+  };
+
+  using Key = std::uint64_t;
+
+  static Key makeKey(SpriteHandle handle, SDL_Point size);
+
+  //! Is size within atlas (otherwise it is never placed)
+  bool canFit(SDL_Point size) const;
+
+  //! Smallest freed rectangle of at least given size
+  std::optional<SDL_Rect> takeFreeRect(SDL_Point size);
+
+  //! Evict the least recently used sprite not used in this frame, returns
+  //! false if there is none
+  bool evictLeastRecentlyUsed();
+
+private:
+  atlas::ShelfAllocator m_allocator;
+
+  //! Packed (handle, width, height) => placement
+  std::unordered_map<Key, Entry> m_entries;
+
+  //! Rectangles of evicted sprites (reused by sprites they can hold)
+  std::vector<SDL_Rect> m_freeRects;
+
+  std::uint64_t m_frame = { 0 };
+
+  //! Space was not found, atlas is freed at start of next frame
+  bool m_isFull = { false };
+};
@@ -0,0 +1,303 @@
+#include "script.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <new>
+#include <utility>
+
+/**
+ * @brief Fixed pool of equally sized blocks for coroutine frames
+ *
+ * Frames which do not fit (or do not find a free block) are allocated on
+ * heap.
+ */
+class ScriptFramePool
+{
+public:
+  static constexpr std::size_t blockSize = 1024; // bytes
+  static constexpr std::size_t blockCount = 32;
+
+  ScriptFramePool()
+  {
+    // thread blocks into free list
+    for (std::size_t i = 0; i < blockCount; i++) {
+      auto* block = reinterpret_cast<FreeBlock*>(&m_storage[i * blockSize]);
+      block->next = m_freeList;
+      m_freeList = block;
+    }
+  }
+
+  void* allocate(std::size_t size)
+  {
+    if (size > blockSize || m_freeList == nullptr) {
+      return ::operator new(size);
+    }
+
+    auto* block = m_freeList;
+    m_freeList = block->next;
+    return block;
+  }
+
+  //! Free block of given size (the one given to allocate)
+  void deallocate(void* ptr, std::size_t size)
+  {
+    if (!isOwned(ptr)) {
+      ::operator delete(ptr, size);
+      return;
+    }
+    assert(size <= blockSize);
+
+    auto* block = static_cast<FreeBlock*>(ptr);
+    block->next = m_freeList;
+    m_freeList = block;
+  }
+
+private:
+  bool isOwned(const void* ptr) const
+  {
+    const auto* byte = static_cast<const std::byte*>(ptr);
+    return byte >= m_storage.data() &&
+           byte < m_storage.data() + m_storage.size();
+  }
+
+  struct FreeBlock
+  {
+    FreeBlock* next;
+  };
+
+  alignas(std::max_align_t) std::array<std::byte, blockSize * blockCount>
+    m_storage;
+
+  FreeBlock* m_freeList = { nullptr };
+};
+
+namespace {
+//! Space before each frame with pool it was taken from (keeps frame aligned
+//! as by global operator new)
+constexpr std::size_t frameHeaderSize = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+static_assert(frameHeaderSize >= sizeof(ScriptFramePool*));
+} // namespace
+
+Script
+Script::promise_type::get_return_object()
+{
+  return Script(Handle::from_promise(*this));
+}
+
+void*
+Script::promise_type::allocate(std::size_t size, ScriptHost* host)
+{
+  // note: frame records its pool, operator delete is not given the host
+  auto* pool = host ? host->m_framePool.get() : nullptr;
+  auto* block = static_cast<std::byte*>(
+    pool ? pool->allocate(frameHeaderSize + size)
+         : ::operator new(frameHeaderSize + size));
+  *reinterpret_cast<ScriptFramePool**>(block) = pool;
+  return block + frameHeaderSize;
+}
+
+void
+Script::promise_type::operator delete(void* ptr, std::size_t size)
+{
+  auto* block = static_cast<std::byte*>(ptr) - frameHeaderSize;
+  auto* pool = *reinterpret_cast<ScriptFramePool**>(block);
+  if (pool) {
+    pool->deallocate(block, frameHeaderSize + size);
+  } else {
+    ::operator delete(block, frameHeaderSize + size);
+  }
+}
+
+ScriptHost::ScriptHost()
+  : m_framePool(std::make_unique<ScriptFramePool>())
+{
+}
+
+ScriptHost::~ScriptHost() = default;
+
+Script::Script(Handle handle)
+  : m_handle(handle)
+{
+}
+
+Script::Script(Script&& other) noexcept
+  : m_handle(std::exchange(other.m_handle, nullptr))
+{
+}
+
+Script&
+Script::operator=(Script&& other) noexcept
+{
+  if (this != &other) {
+    if (m_handle) {
+      m_handle.destroy();
+    }
+    m_handle = std::exchange(other.m_handle, nullptr);
+  }
+  return *this;
+}
+
+Script::~Script()
+{
+  if (m_handle) {
+    m_handle.destroy();
+  }
+}
+
+bool
+Script::isDone() const
+{
+  return !m_handle || m_handle.done();
+}
+
+Script::promise_type&
+Script::getPromise() const
+{
+  assert(m_handle);
+  return m_handle.promise();
+}
+
+void
+Script::resume()
+{
+  assert(!isDone());
+  m_handle.resume();
+}
+
+void
+ScriptScheduler::start(Script script, ScriptTag tag)
+{
+  m_scripts.push_back(Entry{ std::move(script), tag, false });
+  resume(m_scripts.size() - 1);
+  collect();
+}
+
+void
+ScriptScheduler::cancel(ScriptTag tag)
+{
+  for (auto& entry : m_scripts) {
+    if (entry.tag == tag) {
+      entry.isCancelled = true;
+    }
+  }
+  collect();
+}
+
+void
+ScriptScheduler::cancelAll()
+{
+  for (auto& entry : m_scripts) {
+    entry.isCancelled = true;
+  }
+  collect();
+}
+
+void
+ScriptScheduler::tick(unsigned count)
+{
+  if (count == 0) {
+    return;
+  }
+
+  // note: scripts started during the tick are not advanced
+  const auto scriptsCount = m_scripts.size();
+  for (std::size_t i = 0; i < scriptsCount; i++) {
+    auto& entry = m_scripts[i];
+    if (entry.isCancelled || entry.script.isDone()) {
+      continue;
+    }
+
+    auto& promise = entry.script.getPromise();
+    if (promise.awaitedEvent.has_value()) {
+      continue;
+    }
+
+    promise.remainingTicks -= std::min(promise.remainingTicks, count);
+    if (promise.remainingTicks == 0) {
+      resume(i);
+    }
+  }
+  collect();
+}
+
+void
+ScriptScheduler::raise(ScriptEvent event)
+{
+  const auto scriptsCount = m_scripts.size();
+  for (std::size_t i = 0; i < scriptsCount; i++) {
+    auto& entry = m_scripts[i];
+    if (entry.isCancelled || entry.script.isDone()) {
+      continue;
+    }
+
+    auto& promise = entry.script.getPromise();
+    if (promise.awaitedEvent == event) {
+      promise.awaitedEvent.reset();
+      resume(i);
+    }
+  }
+  collect();
+}
+
+std::size_t
+ScriptScheduler::getActiveCount() const
+{
+  return std::count_if(m_scripts.begin(), m_scripts.end(), [](const auto& e) {
+    return !e.isCancelled && !e.script.isDone();
+  });
+}
+
+std::optional<unsigned>
+ScriptScheduler::getTicksUntilWakeUp() const
+{
+  std::optional<unsigned> result;
+  for (const auto& entry : m_scripts) {
+    if (entry.isCancelled || entry.script.isDone() ||
+        entry.script.getPromise().awaitedEvent.has_value()) {
+      continue;
+    }
+
+    const auto ticks = entry.script.getPromise().remainingTicks;
+    result = std::min(result.value_or(ticks), ticks);
+  }
+  return result;
+}
+
+std::vector<ScriptScheduler::SavedScript>
+ScriptScheduler::save() const
+{
+  std::vector<SavedScript> scripts;
+  for (const auto& entry : m_scripts) {
+    if (entry.isCancelled || entry.script.isDone()) {
+      continue;
+    }
+
+    const auto& promise = entry.script.getPromise();
+    scripts.push_back(
+      SavedScript{ entry.tag, promise.remainingTicks, promise.awaitedEvent });
+  }
+  return scripts;
+}
+
+void
+ScriptScheduler::resume(std::size_t index)
+{
+  // Fix: script can start new scripts, thus entry must not be referenced
+  // after resumption (vector may reallocate)
+  m_resumeDepth++;
+  m_scripts[index].script.resume();
+  m_resumeDepth--;
+}
+
+void
+ScriptScheduler::collect()
+{
+  if (m_resumeDepth > 0) {
+    return;
+  }
+
+  std::erase_if(m_scripts, [](const Entry& entry) {
+    return entry.isCancelled || entry.script.isDone();
+  });
+}
@@ -0,0 +1,221 @@
+#pragma once
+
+#include <coroutine>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <vector>
+
+//! Game events that scripts can wait for
+enum class ScriptEvent
+{
+  level_started,
+  level_finished,
+  game_over,
+  ball_released,
+  ball_lost,
+  tile_destroyed,
+  pickup_picked,
+};
+
+//! Tag of running script, allows to cancel a whole group of scripts
+enum class ScriptTag
+{
+  none,
+  restart_level,
+  world_speed,
+  ball_size,
+};
+
+class ScriptHost;
+class ScriptFramePool;
+
+/**
+ * @brief Coroutine task, resumed by ScriptScheduler on world ticks or events
+ *
+ * Frames of member coroutines of ScriptHost (e.g. World) are taken from a
+ * fixed pool of their object, thus starting a script does not touch the heap
+ * (unless the pool is exhausted) and scripts can be resumed on any thread
+ * that currently uses their owner. Frames of other coroutines are allocated on
+ * heap.
+ */
+class Script
+{
+public:
+  struct promise_type
+  {
+    //! How many ticks remain before resuming
+    unsigned remainingTicks = 0;
+
+    //! Event which must be raised before resuming
+    std::optional<ScriptEvent> awaitedEvent;
+
+    Script get_return_object();
+
+    std::suspend_always initial_suspend() noexcept { return {}; }
+    std::suspend_always final_suspend() noexcept { return {}; }
+    void return_void() {}
+    void unhandled_exception() { throw; }
+
+    //! Frame of member coroutine of host (arguments of coroutine ignored)
+    static void* operator new(std::size_t size,
+                              ScriptHost& host,
+                              const auto&...)
+    {
+      return allocate(size, &host);
+    }
+
+    static void* operator new(std::size_t size)
+    {
+      return allocate(size, nullptr);
+    }
+
+    static void operator delete(void* ptr, std::size_t size);
+
+  private:
+    static void* allocate(std::size_t size, ScriptHost* host);
+  };
+
+  using Handle = std::coroutine_handle<promise_type>;
+
+  Script() = default;
+  explicit Script(Handle handle);
+
+  Script(Script&& other) noexcept;
+  Script& operator=(Script&& other) noexcept;
+
+  Script(const Script&) = delete;
+  Script& operator=(const Script&) = delete;
+
+  ~Script();
+
+  bool isDone() const;
+
+  promise_type& getPromise() const;
+  void resume();
+
+private:
+  Handle m_handle;
+};
+
+namespace script {
+struct WaitTicks
+{
+  unsigned count;
+
+  bool await_ready() const noexcept { return count == 0; }
+  void await_suspend(Script::Handle handle) const noexcept
+  {
+    handle.promise().remainingTicks = count;
+  }
+  void await_resume() const noexcept {}
+};
+
+struct WaitEvent
+{
+  ScriptEvent event;
+
+  bool await_ready() const noexcept { return false; }
+  void await_suspend(Script::Handle handle) const noexcept
+  {
+    handle.promise().awaitedEvent = event;
+  }
+  void await_resume() const noexcept {}
+};
+
+//! Awaitable: suspend script for given count of world ticks
+inline WaitTicks
+ticks(unsigned count)
+{
+  return WaitTicks{ count };
+}
+
+//! Awaitable: suspend script until the event is raised
+inline WaitEvent
+event(ScriptEvent event)
+{
+  return WaitEvent{ event };
+}
+} // namespace script
+
+/**
+ * @brief Base of classes whose member coroutines are scripts, owns pool of
+ * their frames
+ *
+ * Pool is not synchronized: host (and its scripts) must be used by one thread
+ * at a time. Host can not be moved, its scripts refer to it.
+ */
+class ScriptHost
+{
+public:
+  ScriptHost();
+  ~ScriptHost();
+
+  ScriptHost(const ScriptHost&) = delete;
+  ScriptHost& operator=(const ScriptHost&) = delete;
+
+private:
+  friend struct Script::promise_type;
+
+  std::unique_ptr<ScriptFramePool> m_framePool;
+};
+
+/**
+ * @brief Owns running scripts and resumes them when their wait is over
+ *
+ * Scripts may start or cancel other scripts (including themselves) while
+ * being resumed, destruction is deferred until the scheduler is idle.
+ */
+class ScriptScheduler
+{
+public:
+  //! Wait of suspended script, see save()
+  struct SavedScript
+  {
+    ScriptTag tag = { ScriptTag::none };
+    unsigned remainingTicks = { 0 };
+    std::optional<ScriptEvent> awaitedEvent;
+  };
+
+  //! Run script until its first suspension and keep it until finished
+  void start(Script script, ScriptTag tag = ScriptTag::none);
+
+  //! Cancel all scripts with given tag
+  void cancel(ScriptTag tag);
+  void cancelAll();
+
+  //! Advance by count of ticks and resume scripts whose wait is over
+  void tick(unsigned count);
+
+  //! Resume all scripts waiting for given event
+  void raise(ScriptEvent event);
+
+  std::size_t getActiveCount() const;
+
+  //! Ticks until the first script waiting for ticks is resumed (none if all
+  //! scripts wait for events)
+  std::optional<unsigned> getTicksUntilWakeUp() const;
+
+  //! Tags & waits of active scripts (in order of starting). Coroutine frames
+  //! can not be copied, owner of scripts recreates them from these.
+  std::vector<SavedScript> save() const;
+
+protected:
+  struct Entry
+  {
+    Script script;
+    ScriptTag tag = { ScriptTag::none };
+    bool isCancelled = { false };
+  };
+
+  void resume(std::size_t index);
+
+  //! Destroy finished and cancelled scripts, unless some script is running
+  void collect();
+
+private:
+  std::vector<Entry> m_scripts;
+
+  //! Depth of nested resumptions (script raising event resumes others)
+  unsigned m_resumeDepth = { 0 };
+};
@@ -0,0 +1,174 @@
+#include "sdl_render_backend.hpp"
+
+#include "constants.hpp"
+
+namespace {
+SDL_Texture*
+toSdl(Texture* texture)
+{
+  return reinterpret_cast<SDL_Texture*>(texture);
+}
+} // namespace
+
+SdlRenderBackend::SdlRenderBackend(SDL_Window* window, bool isHeadless)
+{
+  m_renderer = utils::make_raii_deleter<SDL_Renderer>(
+    utils::throw_if_null(
+      SDL_CreateRenderer(window,
+                         -1,
+                         isHeadless ? SDL_RENDERER_SOFTWARE
+                                    : SDL_RENDERER_ACCELERATED |
+                                        SDL_RENDERER_PRESENTVSYNC),
+      "Failed to initialize renderer"),
+    [](SDL_Renderer* renderer) { SDL_DestroyRenderer(renderer); });
+
+  // render in fixed logical resolution, scaled by whole multiples to window
+  // (and its DPI), remaining area is letterboxed
+  SDL_RenderSetLogicalSize(
+    m_renderer.get(), Constants::screenWidth, Constants::screenHeight);
+  SDL_RenderSetIntegerScale(m_renderer.get(), SDL_TRUE);
+}
+
+Texture*
+SdlRenderBackend::createTexture(SDL_Surface* surface)
+{
+  auto* texture = SDL_CreateTextureFromSurface(m_renderer.get(), surface);
+  if (texture != nullptr) {
+    SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND);
+  }
+  return reinterpret_cast<Texture*>(texture);
+}
+
+void
+SdlRenderBackend::updateTexture(Texture* texture,
+                                const SDL_Rect& rect,
+                                SDL_Surface* surface)
+{
+  Uint32 format;
+  SDL_QueryTexture(toSdl(texture), &format, nullptr, nullptr, nullptr);
+
+  const auto converted = utils::make_raii_deleter<SDL_Surface>(
+    utils::throw_if_null(SDL_ConvertSurfaceFormat(surface, format, 0),
+                         "Failed to convert surface to texture's format"),
+    [](SDL_Surface* surface) { SDL_FreeSurface(surface); });
+  SDL_UpdateTexture(toSdl(texture), &rect, converted->pixels, converted->pitch);
+}
+
+void
+SdlRenderBackend::destroyTexture(Texture* texture)
+{
+  SDL_DestroyTexture(toSdl(texture));
+}
+
+SDL_Point
+SdlRenderBackend::getTextureSize(Texture* texture) const
+{
+  SDL_Point size = { 0, 0 };
+  SDL_QueryTexture(toSdl(texture), nullptr, nullptr, &size.x, &size.y);
+  return size;
+}
+
+SDL_Point
+SdlRenderBackend::getMaxTextureSize() const
+{
+  // note: some renderers report no limit (zero)
+  SDL_RendererInfo info;
+  SDL_GetRendererInfo(m_renderer.get(), &info);
+  return SDL_Point{ info.max_texture_width, info.max_texture_height };
+}
+
+SDL_Point
+SdlRenderBackend::getOutputSize() const
+{
+  SDL_Point size = { 0, 0 };
+  SDL_GetRendererOutputSize(m_renderer.get(), &size.x, &size.y);
+  return size;
+}
+
+void
+SdlRenderBackend::beginFrame(SDL_Color clearColor)
+{
+  SDL_SetRenderDrawColor(
+    m_renderer.get(), clearColor.r, clearColor.g, clearColor.b, clearColor.a);
+  SDL_RenderClear(m_renderer.get());
+}
+
+void
+SdlRenderBackend::setViewport(const SDL_Rect* viewport)
+{
+  SDL_RenderSetViewport(m_renderer.get(), viewport);
+}
+
+void
+SdlRenderBackend::fillRect(const SDL_Rect& rect,
+                           SDL_Color color,
+                           SDL_BlendMode blendMode)
+{
+  SDL_SetRenderDrawBlendMode(m_renderer.get(), blendMode);
+  SDL_SetRenderDrawColor(m_renderer.get(), color.r, color.g, color.b, color.a);
+  SDL_RenderFillRect(m_renderer.get(), &rect);
+}
+
+void
+SdlRenderBackend::copy(Texture* texture,
+                       const SDL_Rect* source,
+                       const SDL_Rect* destination)
+{
+  SDL_RenderCopy(m_renderer.get(), toSdl(texture), source, destination);
+}
+
+void
+SdlRenderBackend::endFrame()
+{
+  SDL_RenderPresent(m_renderer.get());
+}
+
+bool
+SdlRenderBackend::readPixels(SDL_Surface* target)
+{
+  // note: renderer reads in output pixels (logical size scaled to window &
+  // its DPI), thus read the letterboxed game area into buffer of that size
+  // and sample one output pixel of each logical pixel
+  float scaleX = 1.0f;
+  float scaleY = 1.0f;
+  SDL_RenderGetScale(m_renderer.get(), &scaleX, &scaleY);
+  SDL_Rect viewport;
+  SDL_RenderGetViewport(m_renderer.get(), &viewport);
+  const SDL_Rect area{ static_cast<int>(viewport.x * scaleX),
+                       static_cast<int>(viewport.y * scaleY),
+                       static_cast<int>(target->w * scaleX),
+                       static_cast<int>(target->h * scaleY) };
+  if (!m_readback || m_readback->w != area.w || m_readback->h != area.h) {
+    m_readback = utils::make_raii_deleter<SDL_Surface>(
+      SDL_CreateRGBSurfaceWithFormat(
+        0, area.w, area.h, 32, SDL_PIXELFORMAT_ARGB8888),
+      [](SDL_Surface* surface) { SDL_FreeSurface(surface); });
+    if (!m_readback) {
+      return false;
+    }
+  }
+
+  // note: rect of read is clipped by viewport, read from whole output
+  SDL_RenderSetViewport(m_renderer.get(), nullptr);
+  const bool isRead = SDL_RenderReadPixels(m_renderer.get(),
+                                           &area,
+                                           SDL_PIXELFORMAT_ARGB8888,
+                                           m_readback->pixels,
+                                           m_readback->pitch) == 0;
+  SDL_RenderSetViewport(m_renderer.get(), &viewport);
+  if (!isRead) {
+    return false;
+  }
+
+  for (int y = 0; y < target->h; y++) {
+    const auto* row = reinterpret_cast<const Uint32*>(
+      static_cast<const Uint8*>(m_readback->pixels) +
+      static_cast<int>(y * scaleY) * m_readback->pitch);
+    auto* output = reinterpret_cast<Uint32*>(
+      static_cast<Uint8*>(target->pixels) + y * target->pitch);
+    for (int x = 0; x < target->w; x++) {
+      output[x] = row[static_cast<int>(x * scaleX)];
+    }
+  }
+  return true;
+}
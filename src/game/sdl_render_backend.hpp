@@ -0,0 +1,43 @@
+#pragma once
+
+#include "render_backend.hpp"
+#include "utils.hpp"
+
+/**
+ * @brief Backend drawing through SDL's renderer
+ *
+ * Textures are SDL_Textures, logical resolution and letterboxing are handled
+ * by SDL_RenderSetLogicalSize with integer scaling.
+ */
+class SdlRenderBackend : public RenderBackend
+{
+public:
+  //! Note: headless backend uses SDL's software renderer without vsync
+  SdlRenderBackend(SDL_Window* window, bool isHeadless);
+
+  Texture* createTexture(SDL_Surface* surface) override;
+  void updateTexture(Texture* texture,
+                     const SDL_Rect& rect,
+                     SDL_Surface* surface) override;
+  void destroyTexture(Texture* texture) override;
+  SDL_Point getTextureSize(Texture* texture) const override;
+  SDL_Point getMaxTextureSize() const override;
+  SDL_Point getOutputSize() const override;
+
+  void beginFrame(SDL_Color clearColor) override;
+  void setViewport(const SDL_Rect* viewport) override;
+  void fillRect(const SDL_Rect& rect,
+                SDL_Color color,
+                SDL_BlendMode blendMode) override;
+  void copy(Texture* texture,
+            const SDL_Rect* source,
+            const SDL_Rect* destination) override;
+  void endFrame() override;
+  bool readPixels(SDL_Surface* target) override;
+
+private:
+  utils::RaiiOwnership<SDL_Renderer> m_renderer;
+
+  //! Pixels read by readPixels() in output resolution (reused by frames)
+  utils::RaiiOwnership<SDL_Surface> m_readback;
+};
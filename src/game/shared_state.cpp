@@ -0,0 +1,200 @@
+#include "shared_state.hpp"
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <thread>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace shared_state {
+namespace {
+//! Map segment of given name, created (and removed with mapping) by writer,
+//! which fails if the segment exists (e.g. owned by another game)
+utils::RaiiOwnership<Segment>
+mapSegment(const std::string& name, bool isWriter)
+{
+#ifdef _WIN32
+  HANDLE mapping = isWriter
+                     ? CreateFileMappingA(INVALID_HANDLE_VALUE,
+                                          nullptr,
+                                          PAGE_READWRITE,
+                                          0,
+                                          sizeof(Segment),
+                                          name.c_str())
+                     : OpenFileMappingA(FILE_MAP_READ, FALSE, name.c_str());
+  if (mapping == nullptr) {
+    throw std::runtime_error(
+      std::format("Failed to open shared state: {}", name));
+  }
+  if (isWriter && GetLastError() == ERROR_ALREADY_EXISTS) {
+    CloseHandle(mapping);
+    throw std::runtime_error(std::format(
+      "Shared state is already exported by another process: {}", name));
+  }
+
+  const auto access = isWriter ? FILE_MAP_WRITE : FILE_MAP_READ;
+  auto* segment = static_cast<Segment*>(
+    MapViewOfFile(mapping, access, 0, 0, sizeof(Segment)));
+  if (segment == nullptr) {
+    CloseHandle(mapping);
+    throw std::runtime_error(
+      std::format("Failed to map shared state: {}", name));
+  }
+
+  // note: named mapping exists while any handle is open
+  return utils::make_raii_deleter<Segment>(segment, [=](Segment* ptr) {
+    UnmapViewOfFile(ptr);
+    CloseHandle(mapping);
+  });
+#else
+  const int file =
+    isWriter ? shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644)
+             : shm_open(name.c_str(), O_RDONLY, 0);
+  if (file < 0 && isWriter && errno == EEXIST) {
+    throw std::runtime_error(std::format(
+      "Shared state is already exported by another process (or left over "
+      "by crashed one, remove /dev/shm{}): {}",
+      name,
+      name));
+  }
+  if (file < 0) {
+    throw std::runtime_error(
+      std::format("Failed to open shared state: {}", name));
+  }
+  auto fileOwnership = utils::make_raii_action([=]() { close(file); });
+
+  // note: segment is created by this writer, remove it if mapping fails
+  const auto fail = [&](const std::string& message) {
+    if (isWriter) {
+      shm_unlink(name.c_str());
+    }
+    throw std::runtime_error(std::format("{}: {}", message, name));
+  };
+
+  if (isWriter) {
+    if (ftruncate(file, sizeof(Segment)) != 0) {
+      fail("Failed to resize shared state");
+    }
+  } else {
+    struct stat info;
+    if (fstat(file, &info) != 0 ||
+        static_cast<std::size_t>(info.st_size) < sizeof(Segment)) {
+      fail("Truncated shared state");
+    }
+  }
+
+  // note: mapping stays valid after the descriptor is closed
+  void* data = mmap(nullptr,
+                    sizeof(Segment),
+                    isWriter ? PROT_READ | PROT_WRITE : PROT_READ,
+                    MAP_SHARED,
+                    file,
+                    0);
+  if (data == MAP_FAILED) {
+    fail("Failed to map shared state");
+  }
+
+  return utils::make_raii_deleter<Segment>(
+    static_cast<Segment*>(data), [=](Segment* ptr) {
+      munmap(ptr, sizeof(Segment));
+      if (isWriter) {
+        shm_unlink(name.c_str());
+      }
+    });
+#endif
+}
+} // namespace
+
+Writer::Writer(const std::string& name)
+  : m_segment(mapSegment(name, true))
+{
+  // note: new segment is zero-filled, publish() starts from sequence 0
+  std::atomic_ref(m_segment->sequence).store(0, std::memory_order_relaxed);
+  m_segment->version = version;
+  m_segment->snapshotSize = sizeof(Snapshot);
+  m_segment->magic = magic;
+}
+
+void
+Writer::publish(const Snapshot& snapshot)
+{
+  decltype(Segment::words) words;
+  std::memcpy(words.data(), &snapshot, sizeof(snapshot));
+
+  std::atomic_ref sequence(m_segment->sequence);
+  const auto current = sequence.load(std::memory_order_relaxed);
+  sequence.store(current + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+
+  for (std::size_t i = 0; i < words.size(); i++) {
+    std::atomic_ref(m_segment->words[i])
+      .store(words[i], std::memory_order_relaxed);
+  }
+  sequence.store(current + 2, std::memory_order_release);
+}
+
+Reader::Reader(const std::string& name)
+  : m_segment(mapSegment(name, false))
+{
+  if (m_segment->magic != magic) {
+    throw std::runtime_error(
+      std::format("Not a shared game state: {}", name));
+  }
+  if (m_segment->version != version ||
+      m_segment->snapshotSize != sizeof(Snapshot)) {
+    throw std::runtime_error(std::format(
+      "Unsupported shared state version {} in: {}", m_segment->version, name));
+  }
+}
+
+std::optional<Snapshot>
+Reader::read(unsigned maxAttempts) const
+{
+  std::atomic_ref sequence(m_segment->sequence);
+  decltype(Segment::words) words;
+
+  for (unsigned attempt = 0; attempt < maxAttempts; attempt++) {
+    const auto before = sequence.load(std::memory_order_acquire);
+    if (before == 0) {
+      return std::nullopt;
+    }
+
+    if (before % 2 == 0) {
+      for (std::size_t i = 0; i < words.size(); i++) {
+        words[i] = std::atomic_ref(m_segment->words[i])
+                     .load(std::memory_order_relaxed);
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+
+      if (sequence.load(std::memory_order_relaxed) == before) {
+        Snapshot snapshot;
+        std::memcpy(&snapshot, words.data(), sizeof(snapshot));
+        return snapshot;
+      }
+    }
+
+    // writer is in the middle of update, let it finish
+    m_retryCount++;
+    std::this_thread::yield();
+  }
+  return std::nullopt;
+}
+
+std::uint64_t
+Reader::getRetryCount() const
+{
+  return m_retryCount;
+}
+} // namespace shared_state
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+
+#include "utils.hpp"
+
+/**
+ * @brief Live game state shared with other processes (overlays, analytics)
+ *
+ * The game writes a Snapshot into a named shared-memory segment each update,
+ * readers map the same segment. The segment is guarded by a seqlock: writer
+ * makes the sequence odd, writes the snapshot and makes it even again, thus
+ * it never waits for readers. Reader retries whenever the sequence was odd
+ * or changed while it was copying (torn read).
+ *
+ * Note: no SDL here, readers are built without it.
+ */
+namespace shared_state {
+static constexpr std::array<char, 4> magic = { 'A', 'R', 'K', 'S' };
+static constexpr std::uint16_t version = 1;
+
+//! Name of segment used when none is given (POSIX shm name)
+static constexpr const char* defaultName = "/arkanoid_state";
+
+//! Tiles of camera's view (the same as Constants::maxTilesX/Y)
+static constexpr std::size_t tileColumns = 10;
+static constexpr std::size_t tileRows = 10;
+
+struct Snapshot
+{
+  //! Count of published updates
+  std::uint64_t tick;
+
+  //! GameStatus
+  std::int32_t status;
+  std::int32_t score;
+  std::uint32_t remainingBalls;
+
+  //! Alive tiles in the whole level
+  std::uint32_t remainingTiles;
+
+  //! Game speed rate
+  float speed;
+
+  //! Ball is in play (its values are zero otherwise)
+  std::uint32_t hasBall;
+  float ballX, ballY;
+  float ballSpeedX, ballSpeedY;
+  float ballRadius;
+
+  float paddleX, paddleY, paddleWidth, paddleHeight;
+
+  //! Camera's view (all positions are in world units)
+  float viewX, viewY, viewWidth, viewHeight;
+
+  //! Level cell of tiles[0], grid starts at view's top-left cell
+  std::int32_t firstColumn, firstRow;
+
+  //! Lifes of tiles in cells of view (row-major, 0 = empty)
+  std::array<std::uint8_t, tileColumns * tileRows> tiles;
+};
+
+static_assert(sizeof(Snapshot) % sizeof(std::uint64_t) == 0);
+
+//! Memory layout of the segment
+struct Segment
+{
+  std::array<char, 4> magic;
+  std::uint16_t version;
+  std::uint16_t reserved;
+  std::uint32_t snapshotSize;
+  std::uint32_t reserved2;
+
+  //! Seqlock: odd while writer is writing, incremented by 2 per update
+  std::uint64_t sequence;
+
+  //! Snapshot, copied by 64-bit words (atomically, for race-free readers)
+  std::array<std::uint64_t, sizeof(Snapshot) / sizeof(std::uint64_t)> words;
+};
+
+/**
+ * @brief Creates segment and publishes snapshots (never blocks)
+ *
+ * Segment is removed once writer is destroyed.
+ */
+class Writer
+{
+public:
+  //! Throws if segment can not be created
+  explicit Writer(const std::string& name = defaultName);
+
+  void publish(const Snapshot& snapshot);
+
+private:
+  utils::RaiiOwnership<Segment> m_segment;
+};
+
+/**
+ * @brief Maps segment of running game (read-only)
+ */
+class Reader
+{
+public:
+  //! Throws if segment does not exist or is not a game state
+  explicit Reader(const std::string& name = defaultName);
+
+  //! Consistent snapshot, none if the game has not published any yet or
+  //! all attempts were torn (writer is too busy)
+  std::optional<Snapshot> read(unsigned maxAttempts = 1000) const;
+
+  //! Count of torn reads retried so far
+  std::uint64_t getRetryCount() const;
+
+private:
+  utils::RaiiOwnership<Segment> m_segment;
+  mutable std::uint64_t m_retryCount = { 0 };
+};
+} // namespace shared_state
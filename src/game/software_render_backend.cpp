@@ -0,0 +1,410 @@
+#include "software_render_backend.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "constants.hpp"
+#include "raster.hpp"
+
+namespace {
+//! More stripes than this do not pay off for frame of few primitives
+constexpr unsigned maxStripeCount = 8;
+
+constexpr auto letterboxColor = raster::toPixel(0, 0, 0, 0xFF);
+
+SDL_Surface*
+toSurface(Texture* texture)
+{
+  return reinterpret_cast<SDL_Surface*>(texture);
+}
+
+std::uint32_t*
+getRow(SDL_Surface* surface, int y)
+{
+  return reinterpret_cast<std::uint32_t*>(
+    static_cast<std::uint8_t*>(surface->pixels) + y * surface->pitch);
+}
+
+const std::uint32_t*
+getRow(const SDL_Surface* surface, int y)
+{
+  return reinterpret_cast<const std::uint32_t*>(
+    static_cast<const std::uint8_t*>(surface->pixels) + y * surface->pitch);
+}
+
+//! Can be used as framebuffer as it is (alpha is ignored by window)
+bool
+isArgbLayout(const SDL_Surface* surface)
+{
+  const auto format = surface->format->format;
+  return format == SDL_PIXELFORMAT_ARGB8888 || format == SDL_PIXELFORMAT_RGB888;
+}
+} // namespace
+
+SoftwareRenderBackend::SoftwareRenderBackend(SDL_Window* window)
+  : m_window(window)
+  , m_viewport{ 0, 0, Constants::screenWidth, Constants::screenHeight }
+{
+  // note: draw into native framebuffer, not a texture of hidden renderer
+  SDL_SetHint(SDL_HINT_FRAMEBUFFER_ACCELERATION, "0");
+
+  m_windowSurface = utils::throw_if_null(
+    SDL_GetWindowSurface(m_window), "Failed to obtain window's framebuffer");
+
+  m_stripeCount =
+    std::clamp(std::thread::hardware_concurrency(), 1u, maxStripeCount);
+  m_scratch.resize(m_stripeCount);
+
+  // stripe 0 is rasterized by the calling thread
+  for (unsigned stripe = 1; stripe < m_stripeCount; stripe++) {
+    m_workers.emplace_back([this, stripe]() { runWorker(stripe); });
+  }
+
+  SDL_Log("Software rasterizer: %u stripes, %s kernels",
+          m_stripeCount,
+          raster::getKernelName());
+}
+
+SoftwareRenderBackend::~SoftwareRenderBackend()
+{
+  {
+    std::lock_guard lock(m_mutex);
+    m_isStopping = true;
+  }
+  m_wakeUp.notify_all();
+  for (auto& worker : m_workers) {
+    worker.join();
+  }
+
+  // like SDL's renderer, textures not destroyed by user die with backend
+  for (auto* texture : m_textures) {
+    SDL_FreeSurface(texture);
+  }
+}
+
+Texture*
+SoftwareRenderBackend::createTexture(SDL_Surface* surface)
+{
+  auto* texture =
+    SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+  if (texture != nullptr) {
+    m_textures.insert(texture);
+  }
+  return reinterpret_cast<Texture*>(texture);
+}
+
+void
+SoftwareRenderBackend::updateTexture(Texture* texture,
+                                     const SDL_Rect& rect,
+                                     SDL_Surface* surface)
+{
+  const auto converted = utils::make_raii_deleter<SDL_Surface>(
+    utils::throw_if_null(
+      SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0),
+      "Failed to convert surface to texture's format"),
+    [](SDL_Surface* surface) { SDL_FreeSurface(surface); });
+
+  auto* target = toSurface(texture);
+  for (int y = 0; y < rect.h; y++) {
+    std::copy_n(getRow(converted.get(), y),
+                rect.w,
+                getRow(target, rect.y + y) + rect.x);
+  }
+}
+
+void
+SoftwareRenderBackend::destroyTexture(Texture* texture)
+{
+  m_textures.erase(toSurface(texture));
+  SDL_FreeSurface(toSurface(texture));
+}
+
+SDL_Point
+SoftwareRenderBackend::getTextureSize(Texture* texture) const
+{
+  return SDL_Point{ toSurface(texture)->w, toSurface(texture)->h };
+}
+
+SDL_Point
+SoftwareRenderBackend::getMaxTextureSize() const
+{
+  // note: limited by memory only
+  return SDL_Point{ 0, 0 };
+}
+
+SDL_Point
+SoftwareRenderBackend::getOutputSize() const
+{
+  // note: window's surface is not resized until the next frame
+  SDL_Point size = { 0, 0 };
+  SDL_GetWindowSize(m_window, &size.x, &size.y);
+  return size;
+}
+
+void
+SoftwareRenderBackend::beginFrame(SDL_Color clearColor)
+{
+  // note: window's surface is recreated once window is resized
+  m_windowSurface = utils::throw_if_null(
+    SDL_GetWindowSurface(m_window), "Failed to obtain window's framebuffer");
+
+  m_target = m_windowSurface;
+  if (!isArgbLayout(m_windowSurface)) {
+    if (!m_intermediate || m_intermediate->w != m_windowSurface->w ||
+        m_intermediate->h != m_windowSurface->h) {
+      m_intermediate = utils::make_raii_deleter<SDL_Surface>(
+        utils::throw_if_null(
+          SDL_CreateRGBSurfaceWithFormat(0,
+                                         m_windowSurface->w,
+                                         m_windowSurface->h,
+                                         32,
+                                         SDL_PIXELFORMAT_ARGB8888),
+          "Failed to create framebuffer"),
+        [](SDL_Surface* surface) { SDL_FreeSurface(surface); });
+    }
+    m_target = m_intermediate.get();
+  }
+  SDL_LockSurface(m_target);
+
+  // scale logical resolution by whole multiples, center it
+  m_scale = std::max(1,
+                     std::min(m_target->w / Constants::screenWidth,
+                              m_target->h / Constants::screenHeight));
+  m_offset =
+    SDL_Point{ (m_target->w - Constants::screenWidth * m_scale) / 2,
+               (m_target->h - Constants::screenHeight * m_scale) / 2 };
+
+  m_stripeHeight =
+    (m_target->h + static_cast<int>(m_stripeCount) - 1) / m_stripeCount;
+
+  m_commands.clear();
+  setViewport(nullptr);
+
+  const auto output = SDL_Rect{ 0, 0, m_target->w, m_target->h };
+  const auto logicalArea =
+    toFramebuffer(SDL_Rect{ 0, 0, m_viewport.w, m_viewport.h });
+  if (!SDL_RectEquals(&output, &logicalArea)) {
+    Command command{};
+    command.type = Command::Type::fill;
+    command.destination = output;
+    command.color = letterboxColor;
+    m_commands.push_back(command);
+  }
+  fillRect(SDL_Rect{ 0, 0, m_viewport.w, m_viewport.h },
+           clearColor,
+           SDL_BLENDMODE_NONE);
+}
+
+void
+SoftwareRenderBackend::setViewport(const SDL_Rect* viewport)
+{
+  m_viewport = viewport ? *viewport
+                        : SDL_Rect{ 0,
+                                    0,
+                                    Constants::screenWidth,
+                                    Constants::screenHeight };
+}
+
+void
+SoftwareRenderBackend::fillRect(const SDL_Rect& rect,
+                                SDL_Color color,
+                                SDL_BlendMode blendMode)
+{
+  // note: other blend modes are not used by the game
+  Command command{};
+  command.type = blendMode == SDL_BLENDMODE_NONE ? Command::Type::fill
+                                                 : Command::Type::blend;
+  command.color = raster::toPixel(color.r, color.g, color.b, color.a);
+  addCommand(command, toFramebuffer(rect));
+}
+
+void
+SoftwareRenderBackend::copy(Texture* texture,
+                            const SDL_Rect* source,
+                            const SDL_Rect* destination)
+{
+  if (texture == nullptr) {
+    return;
+  }
+
+  const auto* surface = toSurface(texture);
+
+  Command command{};
+  command.type = Command::Type::copy;
+  command.texture = surface;
+  command.source =
+    source ? *source : SDL_Rect{ 0, 0, surface->w, surface->h };
+  command.area = toFramebuffer(
+    destination ? *destination : SDL_Rect{ 0, 0, m_viewport.w, m_viewport.h });
+  addCommand(command, command.area);
+}
+
+void
+SoftwareRenderBackend::endFrame()
+{
+  flush();
+  SDL_UnlockSurface(m_target);
+
+  if (m_target != m_windowSurface) {
+    SDL_BlitSurface(m_target, nullptr, m_windowSurface, nullptr);
+  }
+  SDL_UpdateWindowSurface(m_window);
+}
+
+bool
+SoftwareRenderBackend::readPixels(SDL_Surface* target)
+{
+  if (m_target == nullptr) {
+    return false;
+  }
+  flush();
+
+  // sample one framebuffer pixel of each logical pixel
+  for (int y = 0; y < target->h; y++) {
+    const auto* row = getRow(m_target, m_offset.y + y * m_scale) + m_offset.x;
+    auto* output = getRow(target, y);
+    for (int x = 0; x < target->w; x++) {
+      output[x] = row[x * m_scale] | 0xFF000000;
+    }
+  }
+  return true;
+}
+
+SDL_Rect
+SoftwareRenderBackend::toFramebuffer(const SDL_Rect& rect) const
+{
+  return SDL_Rect{ m_offset.x + (m_viewport.x + rect.x) * m_scale,
+                   m_offset.y + (m_viewport.y + rect.y) * m_scale,
+                   rect.w * m_scale,
+                   rect.h * m_scale };
+}
+
+void
+SoftwareRenderBackend::addCommand(Command command, const SDL_Rect& area)
+{
+  const auto viewport =
+    toFramebuffer(SDL_Rect{ 0, 0, m_viewport.w, m_viewport.h });
+  const auto output = SDL_Rect{ 0, 0, m_target->w, m_target->h };
+
+  SDL_Rect visible;
+  if (!SDL_IntersectRect(&area, &viewport, &visible) ||
+      !SDL_IntersectRect(&visible, &output, &command.destination)) {
+    return;
+  }
+  m_commands.push_back(command);
+}
+
+void
+SoftwareRenderBackend::flush()
+{
+  if (m_commands.empty()) {
+    return;
+  }
+
+  {
+    std::lock_guard lock(m_mutex);
+    m_generation++;
+    m_pendingStripes = m_stripeCount - 1;
+  }
+  m_wakeUp.notify_all();
+
+  rasterizeStripe(0);
+
+  std::unique_lock lock(m_mutex);
+  m_finished.wait(lock, [this]() { return m_pendingStripes == 0; });
+  m_commands.clear();
+}
+
+void
+SoftwareRenderBackend::rasterizeStripe(unsigned stripe)
+{
+  const auto firstRow = static_cast<int>(stripe) * m_stripeHeight;
+  const auto lastRow = std::min(firstRow + m_stripeHeight, m_target->h);
+
+  // note: commands are rasterized in order, each stripe is independent
+  for (const auto& command : m_commands) {
+    rasterize(command, firstRow, lastRow, m_scratch[stripe]);
+  }
+}
+
+void
+SoftwareRenderBackend::rasterize(const Command& command,
+                                 int firstRow,
+                                 int lastRow,
+                                 std::vector<std::uint32_t>& scratch)
+{
+  const auto& rect = command.destination;
+  const auto top = std::max(rect.y, firstRow);
+  const auto bottom = std::min(rect.y + rect.h, lastRow);
+
+  switch (command.type) {
+    case Command::Type::fill:
+      for (int y = top; y < bottom; y++) {
+        raster::fillSpan(getRow(m_target, y) + rect.x, command.color, rect.w);
+      }
+      break;
+
+    case Command::Type::blend:
+      for (int y = top; y < bottom; y++) {
+        raster::blendColorSpan(
+          getRow(m_target, y) + rect.x, command.color, rect.w);
+      }
+      break;
+
+    case Command::Type::copy: {
+      // nearest sampling: map destination pixels back into source
+      const auto& source = command.source;
+      const auto& area = command.area;
+      const bool isScaled = source.w != area.w;
+
+      int cachedRow = -1;
+      for (int y = top; y < bottom; y++) {
+        const auto sourceRow = source.y + (y - area.y) * source.h / area.h;
+        const auto* pixels = getRow(command.texture, sourceRow) + source.x;
+        auto* destination = getRow(m_target, y) + rect.x;
+
+        if (!isScaled) {
+          raster::blendSpan(destination, pixels + (rect.x - area.x), rect.w);
+          continue;
+        }
+
+        // scaled-up rows repeat, gather each source row once
+        if (sourceRow != cachedRow) {
+          scratch.resize(rect.w);
+          for (int x = 0; x < rect.w; x++) {
+            scratch[x] = pixels[(rect.x + x - area.x) * source.w / area.w];
+          }
+          cachedRow = sourceRow;
+        }
+        raster::blendSpan(destination, scratch.data(), rect.w);
+      }
+      break;
+    }
+  }
+}
+
+void
+SoftwareRenderBackend::runWorker(unsigned stripe)
+{
+  unsigned generation = 0;
+  while (true) {
+    {
+      std::unique_lock lock(m_mutex);
+      m_wakeUp.wait(lock, [&]() {
+        return m_isStopping || m_generation != generation;
+      });
+      if (m_isStopping) {
+        return;
+      }
+      generation = m_generation;
+    }
+
+    rasterizeStripe(stripe);
+
+    {
+      std::lock_guard lock(m_mutex);
+      m_pendingStripes--;
+    }
+    m_finished.notify_one();
+  }
+}
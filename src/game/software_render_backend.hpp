@@ -0,0 +1,133 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "render_backend.hpp"
+#include "utils.hpp"
+
+/**
+ * @brief Backend rasterizing game's primitives into window's framebuffer
+ *
+ * Draws are recorded during frame and rasterized when the frame ends. The
+ * framebuffer is split into horizontal stripes, each rasterized by its own
+ * thread with SIMD span kernels (see raster.hpp). Textures are ARGB8888
+ * surfaces in memory.
+ */
+class SoftwareRenderBackend : public RenderBackend
+{
+public:
+  explicit SoftwareRenderBackend(SDL_Window* window);
+  ~SoftwareRenderBackend() override;
+
+  SoftwareRenderBackend(const SoftwareRenderBackend&) = delete;
+  SoftwareRenderBackend& operator=(const SoftwareRenderBackend&) = delete;
+
+  Texture* createTexture(SDL_Surface* surface) override;
+  void updateTexture(Texture* texture,
+                     const SDL_Rect& rect,
+                     SDL_Surface* surface) override;
+  void destroyTexture(Texture* texture) override;
+  SDL_Point getTextureSize(Texture* texture) const override;
+  SDL_Point getMaxTextureSize() const override;
+  SDL_Point getOutputSize() const override;
+
+  void beginFrame(SDL_Color clearColor) override;
+  void setViewport(const SDL_Rect* viewport) override;
+  void fillRect(const SDL_Rect& rect,
+                SDL_Color color,
+                SDL_BlendMode blendMode) override;
+  void copy(Texture* texture,
+            const SDL_Rect* source,
+            const SDL_Rect* destination) override;
+  void endFrame() override;
+  bool readPixels(SDL_Surface* target) override;
+
+protected:
+  struct Command
+  {
+    enum class Type
+    {
+      fill,
+      blend,
+      copy
+    };
+
+    Type type;
+
+    //! Written pixels (clipped, in framebuffer pixels)
+    SDL_Rect destination;
+
+    //! Fill & blend: ARGB8888 color
+    std::uint32_t color;
+
+    //! Copy: texture, its part and where it is mapped to (before clipping)
+    const SDL_Surface* texture;
+    SDL_Rect source;
+    SDL_Rect area;
+  };
+
+  //! Logical rectangle (relative to viewport) in framebuffer pixels
+  SDL_Rect toFramebuffer(const SDL_Rect& rect) const;
+
+  //! Record command writing into area, clipped by viewport
+  void addCommand(Command command, const SDL_Rect& area);
+
+  //! Rasterize recorded commands, all stripes in parallel
+  void flush();
+
+  void rasterizeStripe(unsigned stripe);
+
+  void rasterize(const Command& command,
+                 int firstRow,
+                 int lastRow,
+                 std::vector<std::uint32_t>& scratch);
+
+  void runWorker(unsigned stripe);
+
+private:
+  SDL_Window* m_window;
+
+  //! Window's surface (valid until resize, refreshed by each frame)
+  SDL_Surface* m_windowSurface = { nullptr };
+
+  //! ARGB8888 framebuffer, used if window's surface is in other format
+  utils::RaiiOwnership<SDL_Surface> m_intermediate;
+
+  //! Surface being rasterized into (window's or intermediate)
+  SDL_Surface* m_target = { nullptr };
+
+  //! Integer scale of logical pixels and offset of letterboxed area
+  int m_scale = { 1 };
+  SDL_Point m_offset = { 0, 0 };
+
+  //! Current viewport (in logical pixels)
+  SDL_Rect m_viewport;
+
+  //! Live textures, freed with backend at latest
+  std::unordered_set<SDL_Surface*> m_textures;
+
+  std::vector<Command> m_commands;
+
+  //! Per-stripe buffer of scaled source pixels
+  std::vector<std::vector<std::uint32_t>> m_scratch;
+
+  unsigned m_stripeCount = { 1 };
+  int m_stripeHeight = { 0 };
+
+  std::mutex m_mutex;
+  std::condition_variable m_wakeUp;
+  std::condition_variable m_finished;
+
+  //! Incremented by each flush, workers rasterize once per generation
+  unsigned m_generation = { 0 };
+  unsigned m_pendingStripes = { 0 };
+  bool m_isStopping = { false };
+
+  //! Note: must be the last member, it uses all the members above
+  std::vector<std::thread> m_workers;
+};
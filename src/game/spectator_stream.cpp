@@ -0,0 +1,564 @@
+#include "spectator_stream.hpp"
+
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+namespace spectator {
+namespace {
+enum MessageType : std::uint8_t
+{
+  delta,
+  keyframe
+};
+
+//! Sections following scalars (bitmask)
+enum Section : std::uint8_t
+{
+  tiles = 1,
+  pickups = 2
+};
+
+constexpr std::size_t cellsPerBlock = 64;
+
+//! Spectator refuses larger messages & worlds (malformed stream)
+constexpr std::size_t maxMessageSize = 16 << 20;
+constexpr std::size_t maxCells = 1 << 20;
+
+//! Client of socket sink is dropped when it lags behind by this much
+constexpr std::size_t maxPendingBytes = 4 << 20;
+
+class MessageWriter
+{
+public:
+  explicit MessageWriter(Datagram& bytes)
+    : m_bytes(bytes)
+  {
+  }
+
+  void writeByte(std::uint8_t value)
+  {
+    m_bytes.push_back(static_cast<std::byte>(value));
+  }
+
+  void writeFixed(std::uint64_t value, unsigned size)
+  {
+    for (unsigned i = 0; i < size; i++) {
+      writeByte(static_cast<std::uint8_t>(value >> (i * 8)));
+    }
+  }
+
+  void writeVarint(std::uint64_t value)
+  {
+    while (value >= 0x80) {
+      writeByte(static_cast<std::uint8_t>(value | 0x80));
+      value >>= 7;
+    }
+    writeByte(static_cast<std::uint8_t>(value));
+  }
+
+  //! Small negative numbers are encoded as small varints too
+  void writeSigned(std::int64_t value)
+  {
+    writeVarint((static_cast<std::uint64_t>(value) << 1) ^
+                static_cast<std::uint64_t>(value >> 63));
+  }
+
+  void writeColor(SDL_Color color)
+  {
+    writeByte(color.r);
+    writeByte(color.g);
+    writeByte(color.b);
+  }
+
+private:
+  Datagram& m_bytes;
+};
+
+class MessageReader
+{
+public:
+  explicit MessageReader(std::span<const std::byte> bytes)
+    : m_bytes(bytes)
+  {
+  }
+
+  std::uint8_t readByte()
+  {
+    if (m_position >= m_bytes.size()) {
+      throw std::runtime_error("Truncated spectator message");
+    }
+    return static_cast<std::uint8_t>(m_bytes[m_position++]);
+  }
+
+  std::uint64_t readFixed(unsigned size)
+  {
+    std::uint64_t value = 0;
+    for (unsigned i = 0; i < size; i++) {
+      value |= static_cast<std::uint64_t>(readByte()) << (i * 8);
+    }
+    return value;
+  }
+
+  std::uint64_t readVarint()
+  {
+    std::uint64_t value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7) {
+      const auto byte = readByte();
+      value |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+      if ((byte & 0x80) == 0) {
+        return value;
+      }
+    }
+    throw std::runtime_error("Malformed varint in spectator message");
+  }
+
+  std::int64_t readSigned()
+  {
+    const auto value = readVarint();
+    return static_cast<std::int64_t>(value >> 1) ^
+           -static_cast<std::int64_t>(value & 1);
+  }
+
+  SDL_Color readColor()
+  {
+    SDL_Color color;
+    color.r = readByte();
+    color.g = readByte();
+    color.b = readByte();
+    color.a = 0xFF;
+    return color;
+  }
+
+  bool isAtEnd() const { return m_position == m_bytes.size(); }
+
+private:
+  std::span<const std::byte> m_bytes;
+  std::size_t m_position = { 0 };
+};
+
+//! Prepare frame as base of keyframe: empty world of given size
+void
+resetFrame(Frame& frame, std::int32_t columns, std::int32_t rows)
+{
+  frame.fields = {};
+  frame.columns = columns;
+  frame.rows = rows;
+  frame.cells.assign(static_cast<std::size_t>(columns) * rows, Cell{});
+  frame.pickups.clear();
+}
+} // namespace
+
+bool
+Cell::operator==(const Cell& other) const
+{
+  // note: alpha is not sent
+  return lifes == other.lifes && color.r == other.color.r &&
+         color.g == other.color.g && color.b == other.color.b;
+}
+
+bool
+FramePickup::operator==(const FramePickup& other) const
+{
+  return type == other.type && color.r == other.color.r &&
+         color.g == other.color.g && color.b == other.color.b &&
+         x == other.x && y == other.y && width == other.width &&
+         height == other.height;
+}
+
+std::int32_t&
+Frame::operator[](Field field)
+{
+  return fields[static_cast<std::size_t>(field)];
+}
+
+std::int32_t
+Frame::operator[](Field field) const
+{
+  return fields[static_cast<std::size_t>(field)];
+}
+
+std::int32_t
+quantize(float position)
+{
+  return static_cast<std::int32_t>(std::lround(position * positionScale));
+}
+
+float
+dequantize(std::int32_t position)
+{
+  return static_cast<float>(position) / positionScale;
+}
+
+SDL_FRect
+dequantize(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h)
+{
+  return SDL_FRect{
+    dequantize(x), dequantize(y), dequantize(w), dequantize(h)
+  };
+}
+
+Encoder::Encoder(unsigned keyframeInterval)
+  : m_keyframeInterval(keyframeInterval)
+{
+}
+
+Message
+Encoder::encode(const Frame& frame)
+{
+  const bool isKeyframe = m_isKeyframeRequested ||
+                          m_ticksSinceKeyframe >= m_keyframeInterval ||
+                          frame.columns != m_previous.columns ||
+                          frame.rows != m_previous.rows;
+  if (isKeyframe) {
+    // keyframe is delta against empty world
+    resetFrame(m_previous, frame.columns, frame.rows);
+    m_isKeyframeRequested = false;
+    m_ticksSinceKeyframe = 0;
+  }
+  m_ticksSinceKeyframe++;
+  if (frame.cells.size() != m_previous.cells.size()) {
+    throw std::runtime_error("Cells of spectator frame do not match its size");
+  }
+
+  auto bytes = std::make_shared<Datagram>();
+  MessageWriter writer(*bytes);
+  writer.writeFixed(0, sizeof(std::uint32_t));
+  for (const auto character : magic) {
+    writer.writeByte(static_cast<std::uint8_t>(character));
+  }
+  writer.writeByte(version);
+  writer.writeByte(isKeyframe ? MessageType::keyframe : MessageType::delta);
+  writer.writeVarint(frame.tick);
+  if (isKeyframe) {
+    writer.writeVarint(static_cast<std::uint64_t>(frame.columns));
+    writer.writeVarint(static_cast<std::uint64_t>(frame.rows));
+  }
+
+  // scalars: bitmask of changed ones, then their differences
+  std::uint64_t changedFields = 0;
+  for (std::size_t i = 0; i < frame.fields.size(); i++) {
+    if (frame.fields[i] != m_previous.fields[i]) {
+      changedFields |= std::uint64_t{ 1 } << i;
+    }
+  }
+  writer.writeVarint(changedFields);
+  for (std::size_t i = 0; i < frame.fields.size(); i++) {
+    if (changedFields & (std::uint64_t{ 1 } << i)) {
+      writer.writeSigned(static_cast<std::int64_t>(frame.fields[i]) -
+                         m_previous.fields[i]);
+    }
+  }
+
+  // tiles: which 64-cell blocks changed, which cells of them, new values
+  const auto blockCount =
+    (frame.cells.size() + cellsPerBlock - 1) / cellsPerBlock;
+  std::vector<std::uint64_t> blockMasks(blockCount, 0);
+  bool hasChangedTiles = false;
+  for (std::size_t i = 0; i < frame.cells.size(); i++) {
+    if (!(frame.cells[i] == m_previous.cells[i])) {
+      blockMasks[i / cellsPerBlock] |= std::uint64_t{ 1 }
+                                       << (i % cellsPerBlock);
+      hasChangedTiles = true;
+    }
+  }
+  const bool hasChangedPickups = frame.pickups != m_previous.pickups;
+  writer.writeByte((hasChangedTiles ? Section::tiles : 0) |
+                   (hasChangedPickups ? Section::pickups : 0));
+
+  if (hasChangedTiles) {
+    for (std::size_t block = 0; block < blockCount; block += 8) {
+      std::uint8_t blockBits = 0;
+      for (std::size_t i = block; i < std::min(block + 8, blockCount); i++) {
+        blockBits |= (blockMasks[i] != 0 ? 1 : 0) << (i - block);
+      }
+      writer.writeByte(blockBits);
+    }
+    for (const auto mask : blockMasks) {
+      if (mask != 0) {
+        writer.writeFixed(mask, sizeof(mask));
+      }
+    }
+
+    for (std::size_t block = 0; block < blockCount; block++) {
+      for (auto mask = blockMasks[block]; mask != 0; mask &= mask - 1) {
+        const auto index = block * cellsPerBlock +
+                           static_cast<std::size_t>(std::countr_zero(mask));
+        const auto& cell = frame.cells[index];
+        const auto& previous = m_previous.cells[index];
+
+        // note: color is sent only when tile appears or changes its color
+        const bool hasColor =
+          cell.lifes > 0 && (cell.color.r != previous.color.r ||
+                             cell.color.g != previous.color.g ||
+                             cell.color.b != previous.color.b);
+        writer.writeVarint((static_cast<std::uint64_t>(cell.lifes) << 1) |
+                           (hasColor ? 1 : 0));
+        if (hasColor) {
+          writer.writeColor(cell.color);
+        }
+      }
+    }
+  }
+
+  if (hasChangedPickups) {
+    writer.writeVarint(frame.pickups.size());
+    for (const auto& pickup : frame.pickups) {
+      writer.writeByte(pickup.type);
+      writer.writeColor(pickup.color);
+      writer.writeSigned(pickup.x);
+      writer.writeSigned(pickup.y);
+      writer.writeSigned(pickup.width);
+      writer.writeSigned(pickup.height);
+    }
+  }
+
+  const auto size =
+    static_cast<std::uint32_t>(bytes->size() - sizeof(std::uint32_t));
+  std::memcpy(bytes->data(), &size, sizeof(size));
+
+  // note: decoder clears color of emptied cells, keep the same base
+  m_previous.tick = frame.tick;
+  m_previous.fields = frame.fields;
+  m_previous.pickups = frame.pickups;
+  for (std::size_t i = 0; i < frame.cells.size(); i++) {
+    m_previous.cells[i] = frame.cells[i].lifes > 0 ? frame.cells[i] : Cell{};
+  }
+  return Message{ std::move(bytes), isKeyframe };
+}
+
+void
+Encoder::requestKeyframe()
+{
+  m_isKeyframeRequested = true;
+}
+
+std::size_t
+Decoder::feed(std::span<const std::byte> bytes)
+{
+  m_receivedBytes += bytes.size();
+  m_buffer.insert(m_buffer.end(), bytes.begin(), bytes.end());
+
+  std::size_t appliedCount = 0;
+  std::size_t offset = 0;
+  while (m_buffer.size() - offset >= sizeof(std::uint32_t)) {
+    std::uint32_t size;
+    std::memcpy(&size, m_buffer.data() + offset, sizeof(size));
+    if (size > maxMessageSize) {
+      throw std::runtime_error("Malformed spectator stream");
+    }
+    if (m_buffer.size() - offset - sizeof(size) < size) {
+      break;
+    }
+
+    const auto message =
+      std::span(m_buffer).subspan(offset + sizeof(size), size);
+    offset += sizeof(size) + size;
+
+    // note: stream may be joined in the middle, wait for keyframe
+    if (message.size() > magic.size() + 1 &&
+        (m_isSynced || static_cast<std::uint8_t>(message[magic.size() + 1]) ==
+                         MessageType::keyframe)) {
+      apply(message);
+      m_isSynced = true;
+      appliedCount++;
+    }
+  }
+  m_buffer.erase(m_buffer.begin(), m_buffer.begin() + offset);
+  return appliedCount;
+}
+
+bool
+Decoder::isSynced() const
+{
+  return m_isSynced;
+}
+
+const Frame&
+Decoder::getFrame() const
+{
+  return m_frame;
+}
+
+std::uint64_t
+Decoder::getReceivedBytes() const
+{
+  return m_receivedBytes;
+}
+
+void
+Decoder::apply(std::span<const std::byte> message)
+{
+  MessageReader reader(message);
+  for (const auto character : magic) {
+    if (reader.readByte() != static_cast<std::uint8_t>(character)) {
+      throw std::runtime_error("Not a spectator stream");
+    }
+  }
+  if (const auto streamVersion = reader.readByte(); streamVersion != version) {
+    throw std::runtime_error(
+      std::format("Unsupported spectator stream version: {}", streamVersion));
+  }
+
+  const auto type = reader.readByte();
+  m_frame.tick = reader.readVarint();
+  if (type == MessageType::keyframe) {
+    const auto columns = reader.readVarint();
+    const auto rows = reader.readVarint();
+    // note: both are untrusted, their product could overflow
+    if (columns > maxCells || rows > maxCells ||
+        columns * rows > maxCells) {
+      throw std::runtime_error("Too large world in spectator stream");
+    }
+    resetFrame(m_frame,
+               static_cast<std::int32_t>(columns),
+               static_cast<std::int32_t>(rows));
+  }
+
+  const auto changedFields = reader.readVarint();
+  for (std::size_t i = 0; i < m_frame.fields.size(); i++) {
+    if (changedFields & (std::uint64_t{ 1 } << i)) {
+      m_frame.fields[i] =
+        static_cast<std::int32_t>(m_frame.fields[i] + reader.readSigned());
+    }
+  }
+
+  const auto sections = reader.readByte();
+  if (sections & Section::tiles) {
+    const auto blockCount =
+      (m_frame.cells.size() + cellsPerBlock - 1) / cellsPerBlock;
+    std::vector<bool> isBlockChanged(blockCount);
+    for (std::size_t block = 0; block < blockCount; block += 8) {
+      const auto blockBits = reader.readByte();
+      for (std::size_t i = block; i < std::min(block + 8, blockCount); i++) {
+        isBlockChanged[i] = blockBits & (1 << (i - block));
+      }
+    }
+
+    std::vector<std::uint64_t> blockMasks(blockCount, 0);
+    for (std::size_t block = 0; block < blockCount; block++) {
+      if (isBlockChanged[block]) {
+        blockMasks[block] = reader.readFixed(sizeof(std::uint64_t));
+      }
+    }
+
+    for (std::size_t block = 0; block < blockCount; block++) {
+      for (auto mask = blockMasks[block]; mask != 0; mask &= mask - 1) {
+        const auto index = block * cellsPerBlock +
+                           static_cast<std::size_t>(std::countr_zero(mask));
+        if (index >= m_frame.cells.size()) {
+          throw std::runtime_error("Malformed tiles in spectator message");
+        }
+
+        auto& cell = m_frame.cells[index];
+        const auto value = reader.readVarint();
+        cell.lifes = static_cast<std::uint8_t>(value >> 1);
+        if (value & 1) {
+          cell.color = reader.readColor();
+        }
+        if (cell.lifes == 0) {
+          cell = Cell{};
+        }
+      }
+    }
+  }
+
+  if (sections & Section::pickups) {
+    const auto count = reader.readVarint();
+    if (count > message.size()) {
+      throw std::runtime_error("Malformed pickups in spectator message");
+    }
+    m_frame.pickups.resize(count);
+    for (auto& pickup : m_frame.pickups) {
+      pickup.type = reader.readByte();
+      pickup.color = reader.readColor();
+      pickup.x = static_cast<std::int32_t>(reader.readSigned());
+      pickup.y = static_cast<std::int32_t>(reader.readSigned());
+      pickup.width = static_cast<std::int32_t>(reader.readSigned());
+      pickup.height = static_cast<std::int32_t>(reader.readSigned());
+    }
+  }
+
+  if (!reader.isAtEnd()) {
+    throw std::runtime_error("Trailing bytes in spectator message");
+  }
+}
+
+SocketSink::SocketSink(std::uint16_t port)
+  : m_server(port, maxPendingBytes)
+{
+}
+
+void
+SocketSink::write(const Message& message)
+{
+  m_server.broadcast(message.bytes, message.isKeyframe);
+}
+
+std::size_t
+SocketSink::getSpectatorCount() const
+{
+  return m_server.getClientCount();
+}
+
+std::uint16_t
+SocketSink::getPort() const
+{
+  return m_server.getPort();
+}
+
+FileSink::FileSink(const std::string& path)
+  : m_file(path, std::ios::binary | std::ios::trunc)
+{
+  if (!m_file) {
+    throw std::runtime_error("Failed to create spectator stream: " + path);
+  }
+}
+
+void
+FileSink::write(const Message& message)
+{
+  // note: flushed each tick, readers follow the file as it grows
+  m_file.write(reinterpret_cast<const char*>(message.bytes->data()),
+               static_cast<std::streamsize>(message.bytes->size()));
+  m_file.flush();
+}
+
+Broadcaster::Broadcaster(unsigned keyframeInterval)
+  : m_encoder(keyframeInterval)
+{
+}
+
+void
+Broadcaster::addSink(std::unique_ptr<Sink> sink)
+{
+  // note: stream of new sink must start by keyframe
+  m_sinks.push_back(std::move(sink));
+  m_encoder.requestKeyframe();
+}
+
+void
+Broadcaster::publish(const Frame& frame)
+{
+  const auto message = m_encoder.encode(frame);
+  m_encodedBytes += message.bytes->size();
+  m_messageCount++;
+  for (auto& sink : m_sinks) {
+    sink->write(message);
+  }
+}
+
+std::uint64_t
+Broadcaster::getEncodedBytes() const
+{
+  return m_encodedBytes;
+}
+
+std::uint64_t
+Broadcaster::getMessageCount() const
+{
+  return m_messageCount;
+}
+} // namespace spectator
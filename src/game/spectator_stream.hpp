@@ -0,0 +1,233 @@
+#pragma once
+
+#include <SDL.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "transport.hpp"
+
+/**
+ * @brief Live game state for spectators: keyframes followed by deltas
+ *
+ * Game encodes single message per tick, shared (not copied) by all sinks &
+ * their consumers, thus cost of encoding does not grow with spectators.
+ * Message is either keyframe (state from scratch) or delta against the
+ * previous message:
+ * - changed scalars (score, lives, quantized ball, paddle & view) as
+ *   differences, flagged by a bitmask
+ * - changed tiles as two-level bitmask (64-cell blocks, cells of block),
+ *   followed by new lifes (and color of appearing tiles)
+ * - pickups (whole list) when they changed
+ *
+ * Stream is a sequence of messages, each prefixed by its size (u32). All
+ * numbers are little-endian, varints use 7 bits per byte.
+ */
+namespace spectator {
+constexpr std::array<char, 4> magic = { 'A', 'R', 'K', 'V' };
+constexpr std::uint8_t version = 1;
+
+//! Positions are quantized to 1/positionScale of world unit
+constexpr int positionScale = 4;
+
+//! Ticks between keyframes (new spectators wait for the next one)
+constexpr unsigned defaultKeyframeInterval = 60;
+
+constexpr std::uint16_t defaultPort = 7100;
+
+//! Scalars of frame, see Frame::fields
+enum class Field
+{
+  status,
+  score,
+  remainingBalls,
+
+  //! Game speed rate in thousandths
+  speed,
+
+  //! Quantized positions & sizes (zero radius: no ball in play)
+  ballX,
+  ballY,
+  ballRadius,
+  paddleX,
+  paddleY,
+  paddleWidth,
+  paddleHeight,
+  viewX,
+  viewY,
+  viewWidth,
+  viewHeight,
+  count
+};
+
+struct Cell
+{
+  //! Zero for empty cell
+  std::uint8_t lifes = { 0 };
+  SDL_Color color = { 0, 0, 0, 0 };
+
+  bool operator==(const Cell& other) const;
+};
+
+struct FramePickup
+{
+  std::uint8_t type = { 0 };
+  SDL_Color color = { 0, 0, 0, 0 };
+
+  //! Quantized body
+  std::int32_t x = { 0 };
+  std::int32_t y = { 0 };
+  std::int32_t width = { 0 };
+  std::int32_t height = { 0 };
+
+  bool operator==(const FramePickup& other) const;
+};
+
+//! State of game as seen by spectators
+struct Frame
+{
+  std::uint64_t tick = { 0 };
+  std::array<std::int32_t, static_cast<std::size_t>(Field::count)> fields{};
+
+  //! Size of world in tiles
+  std::int32_t columns = { 0 };
+  std::int32_t rows = { 0 };
+
+  //! Tiles of the whole world (row-major)
+  std::vector<Cell> cells;
+  std::vector<FramePickup> pickups;
+
+  std::int32_t& operator[](Field field);
+  std::int32_t operator[](Field field) const;
+};
+
+std::int32_t
+quantize(float position);
+
+float
+dequantize(std::int32_t position);
+
+SDL_FRect
+dequantize(std::int32_t x, std::int32_t y, std::int32_t w, std::int32_t h);
+
+//! Single encoded message (with its size prefix)
+struct Message
+{
+  SharedBytes bytes;
+  bool isKeyframe = { false };
+};
+
+/**
+ * @brief Encodes frames into messages, keeping the previous one for deltas
+ */
+class Encoder
+{
+public:
+  explicit Encoder(unsigned keyframeInterval = defaultKeyframeInterval);
+
+  Message encode(const Frame& frame);
+
+  //! Encode the next frame as keyframe
+  void requestKeyframe();
+
+private:
+  unsigned m_keyframeInterval;
+  unsigned m_ticksSinceKeyframe = { 0 };
+  bool m_isKeyframeRequested = { true };
+  Frame m_previous;
+};
+
+/**
+ * @brief Rebuilds frames from stream (fed in arbitrary chunks)
+ */
+class Decoder
+{
+public:
+  //! Apply all complete messages, returns count of applied messages
+  //! (throws on malformed stream)
+  std::size_t feed(std::span<const std::byte> bytes);
+
+  //! Keyframe was received (frame is valid)
+  bool isSynced() const;
+
+  const Frame& getFrame() const;
+
+  std::uint64_t getReceivedBytes() const;
+
+protected:
+  void apply(std::span<const std::byte> message);
+
+private:
+  Datagram m_buffer;
+  Frame m_frame;
+  bool m_isSynced = { false };
+  std::uint64_t m_receivedBytes = { 0 };
+};
+
+//! Consumer of messages, e.g. socket or file
+class Sink
+{
+public:
+  virtual ~Sink() = default;
+
+  virtual void write(const Message& message) = 0;
+};
+
+//! Spectators connected to loopback TCP port
+class SocketSink : public Sink
+{
+public:
+  //! Throws if port can not be bound (zero: any free port, see getPort())
+  explicit SocketSink(std::uint16_t port = defaultPort);
+
+  void write(const Message& message) override;
+
+  std::size_t getSpectatorCount() const;
+
+  std::uint16_t getPort() const;
+
+private:
+  BroadcastServer m_server;
+};
+
+//! Stream appended to file, spectators read it as it grows
+class FileSink : public Sink
+{
+public:
+  //! Throws if file can not be created
+  explicit FileSink(const std::string& path);
+
+  void write(const Message& message) override;
+
+private:
+  std::ofstream m_file;
+};
+
+/**
+ * @brief Encodes frame once per tick and passes the message to all sinks
+ */
+class Broadcaster
+{
+public:
+  explicit Broadcaster(unsigned keyframeInterval = defaultKeyframeInterval);
+
+  void addSink(std::unique_ptr<Sink> sink);
+
+  void publish(const Frame& frame);
+
+  //! Size of all encoded messages
+  std::uint64_t getEncodedBytes() const;
+  std::uint64_t getMessageCount() const;
+
+private:
+  Encoder m_encoder;
+  std::vector<std::unique_ptr<Sink>> m_sinks;
+  std::uint64_t m_encodedBytes = { 0 };
+  std::uint64_t m_messageCount = { 0 };
+};
+} // namespace spectator
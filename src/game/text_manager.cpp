@@ -3,55 +3,37 @@
 #include <cassert>
 #include <filesystem>
 
+#ifdef ARKANOID_EMBED_ASSETS
+#include "baked_assets.hpp"
+#endif
+
+namespace {
+constexpr int fontSize = 28; // pt
+} // namespace
+
 void
 TextManager::initialize()
 {
+#ifdef ARKANOID_EMBED_ASSETS
+  // note: font keeps reading from the memory, which is static
+  const auto& data = baked_assets::font;
+  font = utils::make_raii_deleter<TTF_Font>(
+    utils::throw_if_null(
+      TTF_OpenFontRW(
+        SDL_RWFromConstMem(data.data(), static_cast<int>(data.size())),
+        1,
+        fontSize),
+      "Failed to open embedded TTF font"),
+    [](TTF_Font* font) { TTF_CloseFont(font); });
+#else
   const auto fontPath = std::filesystem::absolute("assets/font.ttf").string();
   assert(std::filesystem::exists(fontPath));
 
   font = utils::make_raii_deleter<TTF_Font>(
-    utils::throw_if_null(TTF_OpenFont(fontPath.c_str(), 28),
+    utils::throw_if_null(TTF_OpenFont(fontPath.c_str(), fontSize),
                          std::string("Failed to open TTF font: ") + fontPath),
     [](TTF_Font* font) { TTF_CloseFont(font); });
-}
-
-void
-TextManager::removeUnused()
-{
-  using namespace std::chrono_literals;
-  const auto maxUnusedDuration = 5s;
-
-  const auto now = std::chrono::high_resolution_clock::now();
-  for (auto it = textures.begin(); it != textures.end(); it++) {
-
-    const auto lastUsed = it->second.lastUsed;
-    if ((lastUsed + maxUnusedDuration) < now) {
-      it = textures.erase(it);
-    }
-
-    if (it == textures.end()) {
-      break;
-    }
-  }
-}
-
-bool
-TextManager::hasTexture(const std::string& text) const
-{
-    return textures.count(text);
-}
-
-void
-TextManager::addTexture(const std::string& text, SDL_Texture* texture)
-{
-  textures[text] =
-    TextTexture{ std::chrono::high_resolution_clock::now(), texture };
-}
-
-SDL_Texture*
-TextManager::getTexture(const std::string& text) const
-{
-  return textures.at(text).texture;
+#endif
 }
 
 TTF_Font*
@@ -0,0 +1,105 @@
+#include "texture_cache.hpp"
+
+#include <algorithm>
+#include <iterator>
+
+TextureCache::TextureCache(std::size_t budgetBytes)
+{
+  m_stats.budgetBytes = budgetBytes;
+}
+
+Texture*
+TextureCache::find(const std::string& key)
+{
+  const auto it = m_index.find(key);
+  if (it == m_index.end()) {
+    m_stats.misses++;
+    return nullptr;
+  }
+  m_stats.hits++;
+
+  // move to front, list iterators stay valid
+  auto entry = it->second;
+  entry->lastUsedFrame = m_frame;
+  m_entries.splice(m_entries.begin(), m_entries, entry);
+  return entry->texture.get();
+}
+
+Texture*
+TextureCache::insert(const std::string& key,
+                     utils::RaiiOwnership<Texture> texture,
+                     std::size_t bytes)
+{
+  if (const auto it = m_index.find(key); it != m_index.end()) {
+    evict(it->second);
+  }
+
+  m_entries.push_front(Entry{ key, std::move(texture), bytes, m_frame });
+  m_index[key] = m_entries.begin();
+
+  m_stats.usedBytes += bytes;
+  m_stats.peakBytes = std::max(m_stats.peakBytes, m_stats.usedBytes);
+  m_stats.textureCount++;
+
+  evictOverBudget();
+  return m_entries.front().texture.get();
+}
+
+void
+TextureCache::beginFrame()
+{
+  m_frame++;
+  evictOverBudget();
+}
+
+void
+TextureCache::evictUnused(unsigned maxUnusedFrames)
+{
+  while (!m_entries.empty() &&
+         m_entries.back().lastUsedFrame + maxUnusedFrames < m_frame) {
+    evict(std::prev(m_entries.end()));
+    m_stats.evictions++;
+  }
+}
+
+void
+TextureCache::setBudget(std::size_t budgetBytes)
+{
+  m_stats.budgetBytes = budgetBytes;
+  evictOverBudget();
+}
+
+void
+TextureCache::clear()
+{
+  m_index.clear();
+  m_entries.clear();
+  m_stats.usedBytes = 0;
+  m_stats.textureCount = 0;
+}
+
+const TextureCacheStats&
+TextureCache::getStats() const
+{
+  return m_stats;
+}
+
+void
+TextureCache::evictOverBudget()
+{
+  while (m_stats.usedBytes > m_stats.budgetBytes && !m_entries.empty() &&
+         m_entries.back().lastUsedFrame != m_frame) {
+    evict(std::prev(m_entries.end()));
+    m_stats.evictions++;
+  }
+}
+
+void
+TextureCache::evict(EntryList::iterator entry)
+{
+  m_stats.usedBytes -= entry->bytes;
+  m_stats.textureCount--;
+
+  m_index.erase(entry->key);
+  m_entries.erase(entry);
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "render_backend.hpp"
+#include "utils.hpp"
+
+//! Memory held by texture cache (in bytes) and its evictions
+struct TextureCacheStats
+{
+  std::size_t usedBytes{ 0 };
+  std::size_t peakBytes{ 0 };
+  std::size_t budgetBytes{ 0 };
+
+  unsigned textureCount{ 0 };
+
+  //! Textures destroyed to fit budget or because they were unused too long
+  std::uint64_t evictions{ 0 };
+
+  std::uint64_t hits{ 0 };
+  std::uint64_t misses{ 0 };
+};
+
+/**
+ * @brief Textures identified by key, kept within memory budget
+ *
+ * The least recently used textures are destroyed when the budget is exceeded.
+ * Textures used during current frame are never evicted (they may still be
+ * referenced by recorded draws), so the budget can be exceeded until the
+ * frame ends.
+ */
+class TextureCache
+{
+public:
+  explicit TextureCache(std::size_t budgetBytes);
+
+  //! Get texture & mark it as used in this frame, nullptr if missing
+  Texture* find(const std::string& key);
+
+  //! Take ownership of texture of given size, evicting others if needed
+  Texture* insert(const std::string& key,
+                  utils::RaiiOwnership<Texture> texture,
+                  std::size_t bytes);
+
+  //! Mark start of frame (textures of previous frames can be evicted)
+  void beginFrame();
+
+  //! Evict textures not used during last maxUnusedFrames frames
+  void evictUnused(unsigned maxUnusedFrames);
+
+  //! Change budget (evicting textures over it)
+  void setBudget(std::size_t budgetBytes);
+
+  //! Destroy all textures
+  void clear();
+
+  const TextureCacheStats& getStats() const;
+
+protected:
+  struct Entry
+  {
+    std::string key;
+    utils::RaiiOwnership<Texture> texture;
+    std::size_t bytes;
+    std::uint64_t lastUsedFrame;
+  };
+
+  using EntryList = std::list<Entry>;
+
+  void evictOverBudget();
+
+  void evict(EntryList::iterator entry);
+
+private:
+  //! Entries ordered from the most recently used
+  EntryList m_entries;
+
+  //! Key => entry in the list
+  std::unordered_map<std::string, EntryList::iterator> m_index;
+
+  std::uint64_t m_frame = { 0 };
+
+  TextureCacheStats m_stats;
+};
@@ -0,0 +1,444 @@
+#include "transport.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+
+void
+closeSocket(SocketHandle socket)
+{
+  closesocket(socket);
+}
+
+bool
+isValidSocket(SocketHandle socket)
+{
+  return socket != INVALID_SOCKET;
+}
+
+//! Last call failed only because it would block
+bool
+isWouldBlock()
+{
+  return WSAGetLastError() == WSAEWOULDBLOCK;
+}
+#else
+using SocketHandle = int;
+
+void
+closeSocket(SocketHandle socket)
+{
+  close(socket);
+}
+
+bool
+isValidSocket(SocketHandle socket)
+{
+  return socket >= 0;
+}
+
+//! Last call failed only because it would block
+bool
+isWouldBlock()
+{
+  return errno == EAGAIN || errno == EWOULDBLOCK;
+}
+#endif
+
+// note: peer closing connection must not kill the game by SIGPIPE
+#ifdef MSG_NOSIGNAL
+constexpr int sendFlags = MSG_NOSIGNAL;
+#else
+constexpr int sendFlags = 0;
+#endif
+
+//! Largest datagram accepted by receive()
+constexpr std::size_t maxDatagramSize = 1500;
+
+//! Bytes read by single StreamClient::receive()
+constexpr std::size_t streamChunkSize = 64 * 1024;
+
+//! Initialize socket library (Windows only), released by returned ownership
+utils::RaiiAction
+initializeSockets()
+{
+#ifdef _WIN32
+  WSADATA data;
+  if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+    throw std::runtime_error("Failed to initialize sockets");
+  }
+  return utils::make_raii_action([]() { WSACleanup(); });
+#else
+  return {};
+#endif
+}
+
+//! Socket closed with the last copy of ownership
+utils::RaiiOwnership<std::intptr_t>
+ownSocket(SocketHandle handle)
+{
+  return utils::make_raii_deleter<std::intptr_t>(
+    new std::intptr_t(static_cast<std::intptr_t>(handle)),
+    [](std::intptr_t* ptr) {
+      closeSocket(static_cast<SocketHandle>(*ptr));
+      delete ptr;
+    });
+}
+
+//! Game polls sockets every frame, they must never block
+void
+setNonBlocking(SocketHandle handle)
+{
+#ifdef _WIN32
+  u_long isNonBlocking = 1;
+  const bool hasFailed = ioctlsocket(handle, FIONBIO, &isNonBlocking) != 0;
+#else
+  const bool hasFailed =
+    fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) != 0;
+#endif
+  if (hasFailed) {
+    throw std::runtime_error("Failed to make socket non-blocking");
+  }
+}
+
+//! Resolve IPv4 address of host
+sockaddr_in
+resolveHost(const std::string& host, std::uint16_t port, int socketType)
+{
+  addrinfo hints{};
+  hints.ai_family = AF_INET;
+  hints.ai_socktype = socketType;
+  addrinfo* resolved = nullptr;
+  const auto service = std::to_string(port);
+  if (getaddrinfo(host.c_str(), service.c_str(), &hints, &resolved) != 0 ||
+      resolved == nullptr) {
+    throw std::runtime_error(std::format("Failed to resolve host: {}", host));
+  }
+
+  sockaddr_in address{};
+  std::memcpy(&address, resolved->ai_addr, sizeof(address));
+  freeaddrinfo(resolved);
+  return address;
+}
+} // namespace
+
+UdpTransport::UdpTransport(std::uint16_t localPort,
+                           const std::string& remoteHost,
+                           std::uint16_t remotePort)
+  : m_library(initializeSockets())
+{
+  // resolve peer before creating socket
+  const auto remote = resolveHost(remoteHost, remotePort, SOCK_DGRAM);
+  m_remoteAddress.resize(sizeof(remote));
+  std::memcpy(m_remoteAddress.data(), &remote, sizeof(remote));
+
+  const auto handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+  if (!isValidSocket(handle)) {
+    throw std::runtime_error("Failed to create UDP socket");
+  }
+  m_socket = ownSocket(handle);
+
+  sockaddr_in local{};
+  local.sin_family = AF_INET;
+  local.sin_addr.s_addr = htonl(INADDR_ANY);
+  local.sin_port = htons(localPort);
+  if (bind(handle, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) !=
+      0) {
+    throw std::runtime_error(
+      std::format("Failed to bind UDP port: {}", localPort));
+  }
+  setNonBlocking(handle);
+}
+
+void
+UdpTransport::send(std::span<const std::byte> datagram)
+{
+  // note: datagram lost by the network is as good as datagram not sent
+  sendto(static_cast<SocketHandle>(*m_socket),
+         reinterpret_cast<const char*>(datagram.data()),
+         static_cast<int>(datagram.size()),
+         0,
+         reinterpret_cast<const sockaddr*>(m_remoteAddress.data()),
+         static_cast<int>(m_remoteAddress.size()));
+}
+
+std::optional<Datagram>
+UdpTransport::receive()
+{
+  Datagram datagram(maxDatagramSize);
+  while (true) {
+    sockaddr_in sender{};
+    socklen_t senderSize = sizeof(sender);
+    const auto size = recvfrom(static_cast<SocketHandle>(*m_socket),
+                               reinterpret_cast<char*>(datagram.data()),
+                               static_cast<int>(datagram.size()),
+                               0,
+                               reinterpret_cast<sockaddr*>(&sender),
+                               &senderSize);
+    if (size < 0) {
+      return std::nullopt;
+    }
+
+    const auto& remote =
+      *reinterpret_cast<const sockaddr_in*>(m_remoteAddress.data());
+    if (sender.sin_addr.s_addr == remote.sin_addr.s_addr &&
+        sender.sin_port == remote.sin_port) {
+      datagram.resize(static_cast<std::size_t>(size));
+      return datagram;
+    }
+  }
+}
+
+BroadcastServer::BroadcastServer(std::uint16_t port,
+                                 std::size_t maxPendingBytes)
+  : m_library(initializeSockets())
+  , m_maxPendingBytes(maxPendingBytes)
+{
+  const auto handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (!isValidSocket(handle)) {
+    throw std::runtime_error("Failed to create TCP socket");
+  }
+  m_socket = ownSocket(handle);
+
+  // note: restarted game binds the port again immediately
+  int isReused = 1;
+  setsockopt(handle,
+             SOL_SOCKET,
+             SO_REUSEADDR,
+             reinterpret_cast<const char*>(&isReused),
+             sizeof(isReused));
+
+  sockaddr_in local{};
+  local.sin_family = AF_INET;
+  local.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  local.sin_port = htons(port);
+  if (bind(handle, reinterpret_cast<const sockaddr*>(&local), sizeof(local)) !=
+        0 ||
+      listen(handle, SOMAXCONN) != 0) {
+    throw std::runtime_error(std::format("Failed to listen on port: {}", port));
+  }
+  setNonBlocking(handle);
+}
+
+void
+BroadcastServer::broadcast(const SharedBytes& bytes, bool isSyncPoint)
+{
+  acceptClients();
+
+  std::erase_if(m_clients, [&](Client& client) {
+    if (!client.isSynced && !isSyncPoint) {
+      return false;
+    }
+    client.isSynced = true;
+    client.pending.push_back(bytes);
+    client.pendingBytes += bytes->size();
+
+    // note: slow client must not make the game buffer the stream forever
+    return !flush(client) || client.pendingBytes > m_maxPendingBytes;
+  });
+}
+
+std::size_t
+BroadcastServer::getClientCount() const
+{
+  return m_clients.size();
+}
+
+std::uint16_t
+BroadcastServer::getPort() const
+{
+  sockaddr_in local{};
+  socklen_t localSize = sizeof(local);
+  if (getsockname(static_cast<SocketHandle>(*m_socket),
+                  reinterpret_cast<sockaddr*>(&local),
+                  &localSize) != 0) {
+    return 0;
+  }
+  return ntohs(local.sin_port);
+}
+
+void
+BroadcastServer::acceptClients()
+{
+  const auto listening = static_cast<SocketHandle>(*m_socket);
+  while (true) {
+    const auto handle = accept(listening, nullptr, nullptr);
+    if (!isValidSocket(handle)) {
+      return;
+    }
+
+    Client client;
+    client.socket = ownSocket(handle);
+    try {
+      setNonBlocking(handle);
+    } catch (const std::runtime_error&) {
+      continue;
+    }
+    m_clients.push_back(std::move(client));
+  }
+}
+
+bool
+BroadcastServer::flush(Client& client)
+{
+  const auto handle = static_cast<SocketHandle>(*client.socket);
+  while (!client.pending.empty()) {
+    const auto& bytes = *client.pending.front();
+    const auto size = ::send(
+      handle,
+      reinterpret_cast<const char*>(bytes.data() + client.offset),
+      static_cast<int>(bytes.size() - client.offset),
+      sendFlags);
+    if (size < 0) {
+      return isWouldBlock();
+    }
+
+    client.offset += static_cast<std::size_t>(size);
+    if (client.offset == bytes.size()) {
+      client.pendingBytes -= bytes.size();
+      client.pending.pop_front();
+      client.offset = 0;
+    }
+  }
+  return true;
+}
+
+StreamClient::StreamClient(const std::string& host, std::uint16_t port)
+  : m_library(initializeSockets())
+{
+  const auto remote = resolveHost(host, port, SOCK_STREAM);
+  const auto handle = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+  if (!isValidSocket(handle)) {
+    throw std::runtime_error("Failed to create TCP socket");
+  }
+  m_socket = ownSocket(handle);
+
+  if (connect(handle,
+              reinterpret_cast<const sockaddr*>(&remote),
+              sizeof(remote)) != 0) {
+    throw std::runtime_error(
+      std::format("Failed to connect to {}:{}", host, port));
+  }
+  setNonBlocking(handle);
+}
+
+std::optional<Datagram>
+StreamClient::receive()
+{
+  Datagram bytes(streamChunkSize);
+  const auto size = recv(static_cast<SocketHandle>(*m_socket),
+                         reinterpret_cast<char*>(bytes.data()),
+                         static_cast<int>(bytes.size()),
+                         0);
+  if (size == 0 || (size < 0 && !isWouldBlock())) {
+    return std::nullopt;
+  }
+
+  bytes.resize(size < 0 ? 0 : static_cast<std::size_t>(size));
+  return bytes;
+}
+
+LossyLink::LossyLink(const Settings& settings)
+  : m_settings(settings)
+  , m_random(settings.seed)
+{
+  for (unsigned index = 0; index < 2; index++) {
+    m_endpoints[index] = std::make_unique<Endpoint>(*this, index);
+  }
+}
+
+Transport&
+LossyLink::getEndpoint(unsigned index)
+{
+  return *m_endpoints[index];
+}
+
+void
+LossyLink::tick()
+{
+  m_tick++;
+}
+
+std::uint64_t
+LossyLink::getLostCount() const
+{
+  return m_lostCount;
+}
+
+void
+LossyLink::send(unsigned from, std::span<const std::byte> datagram)
+{
+  std::uniform_real_distribution<float> chance(0.0f, 1.0f);
+  if (chance(m_random) < m_settings.lossRate) {
+    m_lostCount++;
+    return;
+  }
+
+  const auto jitter =
+    m_settings.jitterTicks > 0 ? m_random() % (m_settings.jitterTicks + 1) : 0;
+  auto& queue = m_inFlight[1 - from];
+  const auto deliveryTick = m_tick + m_settings.latencyTicks + jitter;
+
+  // note: jitter reorders datagrams, queue is kept sorted by delivery
+  const auto position = std::upper_bound(
+    queue.begin(),
+    queue.end(),
+    deliveryTick,
+    [](std::uint64_t tick, const InFlight& other) {
+      return tick < other.deliveryTick;
+    });
+  queue.insert(position,
+               InFlight{ deliveryTick, Datagram(datagram.begin(),
+                                                datagram.end()) });
+}
+
+std::optional<Datagram>
+LossyLink::receive(unsigned to)
+{
+  auto& queue = m_inFlight[to];
+  if (queue.empty() || queue.front().deliveryTick > m_tick) {
+    return std::nullopt;
+  }
+
+  auto datagram = std::move(queue.front().datagram);
+  queue.pop_front();
+  return datagram;
+}
+
+LossyLink::Endpoint::Endpoint(LossyLink& link, unsigned index)
+  : m_link(link)
+  , m_index(index)
+{
+}
+
+void
+LossyLink::Endpoint::send(std::span<const std::byte> datagram)
+{
+  m_link.send(m_index, datagram);
+}
+
+std::optional<Datagram>
+LossyLink::Endpoint::receive()
+{
+  return m_link.receive(m_index);
+}
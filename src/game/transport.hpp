@@ -0,0 +1,195 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <optional>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "utils.hpp"
+
+using Datagram = std::vector<std::byte>;
+
+//! Immutable bytes shared by all receivers (sent without copying)
+using SharedBytes = std::shared_ptr<const std::vector<std::byte>>;
+
+/**
+ * @brief Unreliable, unordered delivery of datagrams between two peers
+ *
+ * Both calls never block: receive() returns none when nothing has arrived.
+ */
+class Transport
+{
+public:
+  virtual ~Transport() = default;
+
+  virtual void send(std::span<const std::byte> datagram) = 0;
+  virtual std::optional<Datagram> receive() = 0;
+};
+
+/**
+ * @brief UDP socket bound to local port, talking to a single remote peer
+ *
+ * Datagrams from other addresses are ignored.
+ */
+class UdpTransport : public Transport
+{
+public:
+  //! Throws if socket can not be created or bound
+  UdpTransport(std::uint16_t localPort,
+               const std::string& remoteHost,
+               std::uint16_t remotePort);
+
+  void send(std::span<const std::byte> datagram) override;
+  std::optional<Datagram> receive() override;
+
+private:
+  //! Initialization of socket library (Windows only)
+  utils::RaiiAction m_library;
+
+  //! Socket handle (closed with the last copy)
+  utils::RaiiOwnership<std::intptr_t> m_socket;
+
+  //! Resolved address of remote peer (sockaddr_in)
+  std::vector<std::byte> m_remoteAddress;
+};
+
+/**
+ * @brief TCP server on loopback sending the same byte stream to many clients
+ *
+ * Never blocks: bytes which client's socket does not take are queued (shared,
+ * not copied) and client is dropped once its queue exceeds the limit. Newly
+ * accepted clients skip bytes until the next sync point (e.g. keyframe),
+ * from which the stream can be decoded.
+ */
+class BroadcastServer
+{
+public:
+  //! Throws if port can not be bound (zero: any free port, see getPort())
+  BroadcastServer(std::uint16_t port, std::size_t maxPendingBytes);
+
+  BroadcastServer(const BroadcastServer&) = delete;
+  BroadcastServer& operator=(const BroadcastServer&) = delete;
+
+  //! Accept waiting clients, queue bytes & send as much as sockets take
+  void broadcast(const SharedBytes& bytes, bool isSyncPoint);
+
+  std::size_t getClientCount() const;
+
+  //! Port the server listens on
+  std::uint16_t getPort() const;
+
+protected:
+  struct Client
+  {
+    utils::RaiiOwnership<std::intptr_t> socket;
+    std::deque<SharedBytes> pending;
+
+    //! Already sent bytes of pending.front()
+    std::size_t offset = { 0 };
+    std::size_t pendingBytes = { 0 };
+
+    //! Stream is sent to client (since the first sync point)
+    bool isSynced = { false };
+  };
+
+  void acceptClients();
+
+  //! Returns false if client is gone
+  bool flush(Client& client);
+
+private:
+  utils::RaiiAction m_library;
+  utils::RaiiOwnership<std::intptr_t> m_socket;
+  std::size_t m_maxPendingBytes;
+  std::vector<Client> m_clients;
+};
+
+/**
+ * @brief TCP connection receiving byte stream (see BroadcastServer)
+ */
+class StreamClient
+{
+public:
+  //! Throws if server is not reachable
+  StreamClient(const std::string& host, std::uint16_t port);
+
+  //! Bytes received so far (empty if none), none once server closed stream
+  std::optional<Datagram> receive();
+
+private:
+  utils::RaiiAction m_library;
+  utils::RaiiOwnership<std::intptr_t> m_socket;
+};
+
+/**
+ * @brief In-process link between two endpoints with latency, jitter & loss
+ *
+ * Time of link advances by tick() (e.g. once per frame), datagram sent at
+ * tick t is received at tick t + latency + random jitter, unless lost.
+ * Random decisions are seeded, thus runs of tests are repeatable.
+ */
+class LossyLink
+{
+public:
+  struct Settings
+  {
+    unsigned latencyTicks = { 0 };
+    unsigned jitterTicks = { 0 };
+
+    //! Probability of losing datagram (0-1)
+    float lossRate = { 0.0f };
+
+    unsigned seed = { 1 };
+  };
+
+  explicit LossyLink(const Settings& settings);
+
+  LossyLink(const LossyLink&) = delete;
+  LossyLink& operator=(const LossyLink&) = delete;
+
+  //! Endpoints of link, index 0 talks to 1 and vice versa
+  Transport& getEndpoint(unsigned index);
+
+  void tick();
+
+  std::uint64_t getLostCount() const;
+
+protected:
+  struct InFlight
+  {
+    std::uint64_t deliveryTick;
+    Datagram datagram;
+  };
+
+  class Endpoint : public Transport
+  {
+  public:
+    Endpoint(LossyLink& link, unsigned index);
+
+    void send(std::span<const std::byte> datagram) override;
+    std::optional<Datagram> receive() override;
+
+  private:
+    LossyLink& m_link;
+    unsigned m_index;
+  };
+
+  void send(unsigned from, std::span<const std::byte> datagram);
+  std::optional<Datagram> receive(unsigned to);
+
+private:
+  Settings m_settings;
+  std::minstd_rand m_random;
+  std::uint64_t m_tick = { 0 };
+  std::uint64_t m_lostCount = { 0 };
+
+  //! Datagrams travelling to endpoint (by index)
+  std::deque<InFlight> m_inFlight[2];
+
+  std::unique_ptr<Endpoint> m_endpoints[2];
+};
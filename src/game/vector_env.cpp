@@ -0,0 +1,230 @@
+#include "vector_env.hpp"
+
+#include <algorithm>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+VectorEnv::VectorEnv(std::size_t envCount,
+                     unsigned threadCount,
+                     unsigned seed,
+                     unsigned frameSkip)
+  : m_envCount(envCount)
+  , m_seed(seed)
+  , m_frameSkip(std::max(frameSkip, 1u))
+{
+  if (envCount == 0) {
+    throw std::runtime_error("At least one environment is required");
+  }
+
+  if (threadCount == 0) {
+    threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+  }
+  m_workerCount =
+    static_cast<unsigned>(std::min<std::size_t>(threadCount, envCount));
+  m_worlds.resize(envCount);
+
+  // note: workers create their worlds first, wait for them
+  m_pendingWorkers = m_workerCount;
+  for (unsigned worker = 0; worker < m_workerCount; worker++) {
+    m_workers.emplace_back([this, worker]() { runWorker(worker); });
+  }
+
+  std::unique_lock lock(m_mutex);
+  m_finished.wait(lock, [this]() { return m_pendingWorkers == 0; });
+  if (m_error) {
+    lock.unlock();
+    stopWorkers();
+    std::rethrow_exception(m_error);
+  }
+}
+
+VectorEnv::~VectorEnv()
+{
+  stopWorkers();
+}
+
+void
+VectorEnv::stopWorkers()
+{
+  {
+    std::lock_guard lock(m_mutex);
+    m_isStopping = true;
+  }
+  m_wakeUp.notify_all();
+  for (auto& worker : m_workers) {
+    if (worker.joinable()) {
+      worker.join();
+    }
+  }
+}
+
+std::size_t
+VectorEnv::getEnvCount() const
+{
+  return m_envCount;
+}
+
+void
+VectorEnv::reset(float* observations)
+{
+  m_observations = observations;
+  run(Task::reset);
+}
+
+void
+VectorEnv::step(const AgentAction* actions,
+                float* observations,
+                float* rewards,
+                std::uint8_t* dones)
+{
+  m_actions = actions;
+  m_observations = observations;
+  m_rewards = rewards;
+  m_dones = dones;
+  run(Task::step);
+}
+
+void
+VectorEnv::renderGrids(int width, int height, std::uint8_t* grids)
+{
+  if (width <= 0 || height <= 0) {
+    throw std::runtime_error("Invalid size of occupancy grid");
+  }
+  m_gridWidth = width;
+  m_gridHeight = height;
+  m_grids = grids;
+  run(Task::renderGrids);
+}
+
+void
+VectorEnv::run(Task task)
+{
+  {
+    std::lock_guard lock(m_mutex);
+    m_task = task;
+    m_pendingWorkers = m_workerCount;
+    m_generation++;
+  }
+  m_wakeUp.notify_all();
+
+  std::unique_lock lock(m_mutex);
+  m_finished.wait(lock, [this]() { return m_pendingWorkers == 0; });
+  if (m_error) {
+    std::rethrow_exception(std::exchange(m_error, nullptr));
+  }
+}
+
+void
+VectorEnv::runWorker(unsigned worker)
+{
+  const auto first = getFirstWorld(worker);
+  const auto last = getFirstWorld(worker + 1);
+
+  const auto runTask = [&](auto&& task) {
+    try {
+      for (auto index = first; index < last; index++) {
+        task(index);
+      }
+    } catch (...) {
+      std::lock_guard lock(m_mutex);
+      if (!m_error) {
+        m_error = std::current_exception();
+      }
+    }
+
+    {
+      std::lock_guard lock(m_mutex);
+      m_pendingWorkers--;
+    }
+    m_finished.notify_one();
+  };
+
+  runTask([this](std::size_t index) {
+    // note: chunks of levels are loaded synchronously, thus seeded episodes
+    // repeat exactly and no world owns streaming thread
+    m_worlds[index] = std::make_unique<World>();
+    m_worlds[index]->setRandomSeed(m_seed + static_cast<unsigned>(index));
+    m_worlds[index]->setDeterministic(true);
+  });
+
+  unsigned generation = 0;
+  while (true) {
+    {
+      std::unique_lock lock(m_mutex);
+      m_wakeUp.wait(lock, [&]() {
+        return m_isStopping || m_generation != generation;
+      });
+      if (m_isStopping) {
+        break;
+      }
+      generation = m_generation;
+    }
+
+    switch (m_task) {
+      case Task::reset:
+        runTask([this](std::size_t index) { resetWorld(index); });
+        break;
+      case Task::step:
+        runTask([this](std::size_t index) { stepWorld(index); });
+        break;
+      case Task::renderGrids:
+        runTask([this](std::size_t index) { renderGrid(index); });
+        break;
+    }
+  }
+
+  for (auto index = first; index < last; index++) {
+    m_worlds[index].reset();
+  }
+}
+
+void
+VectorEnv::resetWorld(std::size_t index)
+{
+  auto& world = *m_worlds[index];
+  world.restartLevel();
+  world.getObservation(std::span(
+    m_observations + index * World::observationSize, World::observationSize));
+}
+
+void
+VectorEnv::stepWorld(std::size_t index)
+{
+  auto& world = *m_worlds[index];
+  const auto initialScore = world.getGameState().score;
+
+  world.applyAction(m_actions[index]);
+  bool isDone = false;
+  for (unsigned frame = 0; frame < m_frameSkip && !isDone; frame++) {
+    world.update(frameDelta);
+    isDone = world.getGameStatus() == GameStatus::game_over ||
+             world.getGameStatus() == GameStatus::you_won;
+  }
+
+  m_rewards[index] =
+    static_cast<float>(world.getGameState().score - initialScore);
+  m_dones[index] = isDone;
+
+  // note: observation of finished world is the first one of next episode
+  if (isDone) {
+    world.restartLevel();
+  }
+  world.getObservation(std::span(
+    m_observations + index * World::observationSize, World::observationSize));
+}
+
+void
+VectorEnv::renderGrid(std::size_t index)
+{
+  const auto size = OccupancyGrid::getSize(m_gridWidth, m_gridHeight);
+  OccupancyGrid grid(
+    std::span(m_grids + index * size, size), m_gridWidth, m_gridHeight);
+  m_worlds[index]->renderOccupancyGrid(grid);
+}
+
+std::size_t
+VectorEnv::getFirstWorld(unsigned worker) const
+{
+  return m_envCount * worker / m_workerCount;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "world.hpp"
+
+/**
+ * @brief Many worlds stepped in parallel for bots (reinforcement learning)
+ *
+ * Each world is pinned to a single worker thread, which creates, steps and
+ * destroys it (thus worlds are never shared between threads). Results are
+ * written directly into caller's buffers, each worker writes only the
+ * elements of its worlds. Finished episodes are restarted immediately.
+ */
+class VectorEnv
+{
+public:
+  //! Simulated time of single update
+  static constexpr auto frameDelta = std::chrono::microseconds(16'667);
+
+  //! Creates worlds seeded by seed + index of world. Thread count 0 uses
+  //! all cores. Each step repeats action for frameSkip updates.
+  VectorEnv(std::size_t envCount,
+            unsigned threadCount,
+            unsigned seed,
+            unsigned frameSkip);
+  ~VectorEnv();
+
+  VectorEnv(const VectorEnv&) = delete;
+  VectorEnv& operator=(const VectorEnv&) = delete;
+
+  std::size_t getEnvCount() const;
+
+  //! Restart all worlds and write their observations
+  //! (envCount * World::observationSize)
+  void reset(float* observations);
+
+  //! Apply actions (envCount) and write observations, rewards (score deltas)
+  //! and done flags (envCount). Rethrows exception of any world.
+  void step(const AgentAction* actions,
+            float* observations,
+            float* rewards,
+            std::uint8_t* dones);
+
+  //! Render occupancy grids of all worlds
+  //! (envCount * OccupancyGrid::getSize(width, height) bytes)
+  void renderGrids(int width, int height, std::uint8_t* grids);
+
+protected:
+  enum class Task
+  {
+    reset,
+    step,
+    renderGrids
+  };
+
+  //! Run task on all workers and wait for them
+  void run(Task task);
+
+  void runWorker(unsigned worker);
+
+  //! Stop & join workers (they destroy their worlds)
+  void stopWorkers();
+
+  void resetWorld(std::size_t index);
+  void stepWorld(std::size_t index);
+  void renderGrid(std::size_t index);
+
+  //! Range of worlds owned by worker
+  std::size_t getFirstWorld(unsigned worker) const;
+
+private:
+  std::size_t m_envCount;
+  unsigned m_seed;
+  unsigned m_frameSkip;
+  unsigned m_workerCount;
+
+  //! Created & destroyed by owning workers
+  std::vector<std::unique_ptr<World>> m_worlds;
+
+  //! Buffers of current task
+  const AgentAction* m_actions = { nullptr };
+  float* m_observations = { nullptr };
+  float* m_rewards = { nullptr };
+  std::uint8_t* m_dones = { nullptr };
+  std::uint8_t* m_grids = { nullptr };
+  int m_gridWidth = { 0 };
+  int m_gridHeight = { 0 };
+  Task m_task = { Task::reset };
+
+  std::mutex m_mutex;
+  std::condition_variable m_wakeUp;
+  std::condition_variable m_finished;
+
+  //! Incremented by each task, workers run it once per generation
+  unsigned m_generation = { 0 };
+  unsigned m_pendingWorkers = { 0 };
+  bool m_isStopping = { false };
+
+  //! The first failure of workers (rethrown by caller)
+  std::exception_ptr m_error;
+
+  //! Note: must be the last member, it uses all the members above
+  std::vector<std::thread> m_workers;
+};
@@ -1,32 +1,57 @@
 #include "world.hpp"
-#include "sdl_helper.hpp"
 
 #include <cmath>
-#include <cstdlib>
+#include <cstdint>
+#include <type_traits>
 
 namespace {
 static const auto standardColors =
   std::vector<SDL_Color>{ Color::red, Color::blue, Color::green };
 
 auto
-getRandomStandardColor() -> SDL_Color
+getStandardColor(unsigned index) -> SDL_Color
 {
-  const auto i = std::rand() % standardColors.size();
-  return standardColors[i];
+  return standardColors[index % standardColors.size()];
 };
 
-auto
-frecTorec(SDL_FRect frec) -> SDL_Rect
-{
-  SDL_Rect result;
-  result.x = static_cast<int>(std::roundf(frec.x));
-  result.y = static_cast<int>(std::roundf(frec.y));
-  result.w = static_cast<int>(std::roundf(frec.w));
-  result.h = static_cast<int>(std::roundf(frec.h));
+//! Size of level chunk (in world units)
+constexpr float chunkWidth = LevelStreamer::chunkSize * Constants::tileWidth;
+constexpr float chunkHeight = LevelStreamer::chunkSize * Constants::tileHeight;
 
-  return result;
+//! Real time of one script tick
+constexpr auto tickDuration =
+  std::chrono::microseconds(1000'000 / Constants::ticksPerSecond);
+
+GridRect
+toGridRect(const SDL_FRect& rect)
+{
+  return { rect.x, rect.y, rect.w, rect.h };
 }
 
+//! FNV-1a over values added one by one (thus without padding of structs)
+class Checksum
+{
+public:
+  template<typename T>
+  void add(const T& value)
+  {
+    static_assert(std::is_arithmetic_v<T> || std::is_enum_v<T>);
+    addBytes(&value, sizeof(value));
+  }
+
+  void addBytes(const void* data, std::size_t size)
+  {
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    for (std::size_t i = 0; i < size; i++) {
+      m_hash = (m_hash ^ bytes[i]) * 1099511628211ull;
+    }
+  }
+
+  std::uint64_t get() const { return m_hash; }
+
+private:
+  std::uint64_t m_hash = { 14695981039346656037ull };
+};
 } // namespace
 
 void
@@ -39,23 +64,59 @@ World::initializeWorld()
   while (!m_events.empty()) {
     m_events.pop();
   }
+  m_scripts.cancelAll();
 
   m_tileMap.clear();
   m_pickups.clear();
 
-  // generate random tiles
-  for (int x = 0; x < Constants::maxTilesX; x++) {
-    for (int y = 0; y < Constants::maxTilesY - 3; y++) {
-      spawnRandomTile(x, y);
+  // choose layout: user's level file, built-in campaign, or random tiles
+  m_level.reset();
+  if (m_levelFile) {
+    m_level = m_levelFile->getView();
+  } else if (m_campaignLevel < campaign::levels.size()) {
+    m_level = campaign::levels[m_campaignLevel];
+  }
+
+  if (m_level) {
+    // keep bottom rows of world free for paddle
+    const auto& view = *m_level;
+    m_worldSize.x = std::max<float>(Constants::worldWidth,
+                                    view.columns * Constants::tileWidth);
+    m_worldSize.y = std::max<float>(Constants::worldHeight,
+                                    (view.rows + 3) * Constants::tileHeight);
+    m_remainingTiles = view.tileCount;
+  } else {
+    m_worldSize = SDL_FPoint{ Constants::worldWidth, Constants::worldHeight };
+
+    // generate random tiles
+    for (int x = 0; x < Constants::maxTilesX; x++) {
+      for (int y = 0; y < Constants::maxTilesY - 3; y++) {
+        spawnRandomTile(x, y);
+      }
     }
+    m_remainingTiles = m_tileMap.size();
   }
 
   // Note: this must come before ball
   initializePaddle();
   initializeBall();
 
+  m_camera.view.w = Constants::worldWidth;
+  m_camera.view.h = Constants::worldHeight;
+  m_camera.moveTo(m_ball->position, m_worldSize);
+  m_camera.keepInView(m_paddle.body, m_worldSize);
+
+  if (m_level) {
+    initializeLevelStreaming();
+  } else {
+    m_streamer.reset();
+    rebuildCollisionSpans();
+  }
+
   m_gameStatus = GameStatus::running;
   m_gameState = GameState();
+
+  m_scripts.raise(ScriptEvent::level_started);
 }
 
 void
@@ -67,7 +128,7 @@ World::initializeBall()
                                  m_paddle.body.y - m_ball->radius - 1.0f };
 
   // initially: 1unit/second upward
-  m_ball->speed = { ((std::rand() % 100) - 50.0f), -(Constants::ballSpeed) };
+  m_ball->speed = { (getRandom(100) - 50.0f), -(Constants::ballSpeed) };
 }
 
 void
@@ -75,15 +136,230 @@ World::initializePaddle()
 {
   m_paddle.body.w = Constants::paddleWidth;
   m_paddle.body.h = Constants::paddleHeight;
-  m_paddle.body.x = (Constants::worldWidth / 2.0) - (m_paddle.body.w * 0.5);
-  m_paddle.body.y = (Constants::worldHeight - Constants::paddleHeight * 1.2) -
+  m_paddle.body.x = (m_worldSize.x / 2.0) - (m_paddle.body.w * 0.5);
+  m_paddle.body.y = (m_worldSize.y - Constants::paddleHeight * 1.2) -
                     (m_paddle.body.h * 0.5);
 }
 
+void
+World::loadLevel(level::LevelFile level)
+{
+  const auto view = level.getView();
+  if (view.columns == 0 || view.rows == 0) {
+    throw std::runtime_error("Level has no tiles");
+  }
+
+  // Note: streamer reads the old level, stop it first
+  m_streamer.reset();
+  m_levelFile = std::move(level);
+}
+
+void
+World::initializeLevelStreaming()
+{
+  // Note: old streamer must stop before its chunks are forgotten
+  m_streamer.reset();
+  m_streamer = std::make_unique<LevelStreamer>(*m_level);
+
+  const auto chunkCount = m_streamer->getChunkCount();
+  m_isChunkResident.assign(chunkCount.x * chunkCount.y, false);
+  m_isChunkRequested.assign(chunkCount.x * chunkCount.y, false);
+  m_residentChunks = SDL_Rect{ 0, 0, 0, 0 };
+  m_hitTileLifes.clear();
+
+  updateLevelStreaming();
+}
+
+void
+World::updateLevelStreaming()
+{
+  if (!m_streamer) {
+    return;
+  }
+
+  const auto chunkCount = m_streamer->getChunkCount();
+  const auto chunkIndex = [&](SDL_Point chunk) {
+    return chunk.y * chunkCount.x + chunk.x;
+  };
+
+  bool hasChanged = false;
+
+  const auto required = getRequiredChunks();
+  if (!SDL_RectEquals(&required, &m_residentChunks)) {
+    // evict chunks which are not needed anymore
+    std::erase_if(m_tileMap, [&](const Tile& tile) {
+      const auto chunk = SDL_Point{ tile.cell.x / LevelStreamer::chunkSize,
+                                    tile.cell.y / LevelStreamer::chunkSize };
+      return !SDL_PointInRect(&chunk, &required);
+    });
+
+    for (int y = 0; y < m_residentChunks.h; y++) {
+      for (int x = 0; x < m_residentChunks.w; x++) {
+        const auto chunk =
+          SDL_Point{ m_residentChunks.x + x, m_residentChunks.y + y };
+        if (!SDL_PointInRect(&chunk, &required)) {
+          m_isChunkResident[chunkIndex(chunk)] = false;
+        }
+      }
+    }
+
+    // stream in the missing ones
+    for (int y = 0; y < required.h; y++) {
+      for (int x = 0; x < required.w; x++) {
+        const auto chunk = SDL_Point{ required.x + x, required.y + y };
+        const auto index = chunkIndex(chunk);
+        if (m_isChunkResident[index] || m_isChunkRequested[index]) {
+          continue;
+        }
+
+        // note: timing of background loading differs between runs
+        if (m_isDeterministic) {
+          insertChunk(m_streamer->load(chunk));
+        } else {
+          m_isChunkRequested[index] = true;
+          m_streamer->request(chunk);
+        }
+      }
+    }
+
+    m_residentChunks = required;
+    hasChanged = true;
+  }
+
+  for (auto& chunk : m_streamer->takeLoaded()) {
+    const auto index = chunkIndex(chunk.coord);
+    m_isChunkRequested[index] = false;
+
+    // note: chunk could be loaded synchronously or left the region meanwhile
+    if (SDL_PointInRect(&chunk.coord, &m_residentChunks) &&
+        !m_isChunkResident[index]) {
+      insertChunk(std::move(chunk));
+      hasChanged = true;
+    }
+  }
+
+  // visible chunks (and chunks under ball) can not wait for streaming
+  for (int y = 0; y < m_residentChunks.h; y++) {
+    for (int x = 0; x < m_residentChunks.w; x++) {
+      const auto chunk =
+        SDL_Point{ m_residentChunks.x + x, m_residentChunks.y + y };
+      if (m_isChunkResident[chunkIndex(chunk)]) {
+        continue;
+      }
+
+      const auto chunkBody =
+        SDL_FRect{ static_cast<float>(chunk.x * chunkWidth),
+                   static_cast<float>(chunk.y * chunkHeight),
+                   chunkWidth,
+                   chunkHeight };
+      const auto ballBody =
+        m_ball ? m_ball->getBoundingRect() : SDL_FRect{ 0, 0, 0, 0 };
+      if (SDL_HasIntersectionF(&chunkBody, &m_camera.view) ||
+          SDL_HasIntersectionF(&chunkBody, &ballBody)) {
+        insertChunk(m_streamer->load(chunk));
+        hasChanged = true;
+      }
+    }
+  }
+
+  if (hasChanged) {
+    rebuildCollisionSpans();
+  }
+}
+
+void
+World::insertChunk(LevelStreamer::Chunk chunk)
+{
+  const auto chunkCount = m_streamer->getChunkCount();
+  m_isChunkResident[chunk.coord.y * chunkCount.x + chunk.coord.x] = true;
+
+  const auto columns = m_level->columns;
+  for (auto& tile : chunk.tiles) {
+    // tiles hit before eviction keep their lifes
+    const auto it = m_hitTileLifes.find(tile.cell.y * columns + tile.cell.x);
+    if (it != m_hitTileLifes.end()) {
+      if (it->second == 0) {
+        continue;
+      }
+      tile.lifes = it->second;
+    }
+
+    tile.id = m_nextTileId++;
+    m_tileMap.push_back(tile);
+  }
+}
+
+SDL_Rect
+World::getRequiredChunks() const
+{
+  // area around camera and ball, with a margin of one chunk to stream ahead
+  auto area = m_camera.view;
+  if (m_ball) {
+    const auto ballBody = m_ball->getBoundingRect();
+    const auto right = std::max(area.x + area.w, ballBody.x + ballBody.w);
+    const auto bottom = std::max(area.y + area.h, ballBody.y + ballBody.h);
+    area.x = std::min(area.x, ballBody.x);
+    area.y = std::min(area.y, ballBody.y);
+    area.w = right - area.x;
+    area.h = bottom - area.y;
+  }
+
+  const auto chunkCount = m_streamer->getChunkCount();
+  const auto firstX =
+    std::clamp(static_cast<int>(area.x / chunkWidth) - 1, 0, chunkCount.x);
+  const auto firstY =
+    std::clamp(static_cast<int>(area.y / chunkHeight) - 1, 0, chunkCount.y);
+  const auto lastX = std::clamp(
+    static_cast<int>((area.x + area.w) / chunkWidth) + 1, 0, chunkCount.x - 1);
+  const auto lastY =
+    std::clamp(static_cast<int>((area.y + area.h) / chunkHeight) + 1,
+               0,
+               chunkCount.y - 1);
+
+  return SDL_Rect{ firstX, firstY, lastX - firstX + 1, lastY - firstY + 1 };
+}
+
+void
+World::rebuildCollisionSpans()
+{
+  auto cells = SDL_Rect{ 0, 0, Constants::maxTilesX, Constants::maxTilesY };
+  if (m_streamer) {
+    cells = SDL_Rect{ m_residentChunks.x * LevelStreamer::chunkSize,
+                      m_residentChunks.y * LevelStreamer::chunkSize,
+                      m_residentChunks.w * LevelStreamer::chunkSize,
+                      m_residentChunks.h * LevelStreamer::chunkSize };
+  }
+
+  const auto tileSize =
+    SDL_FPoint{ Constants::tileWidth, Constants::tileHeight };
+  m_collisionSpans.rebuild(m_tileMap, cells, tileSize);
+}
+
 void
 World::update(std::chrono::microseconds delta)
 {
-  const auto now = std::chrono::high_resolution_clock::now();
+  applyCommands();
+  updateSimulation(delta);
+
+  m_tick++;
+  if (m_stateWriter) {
+    m_stateWriter->publish(getStateSnapshot());
+  }
+  if (m_broadcaster) {
+    getSpectatorFrame(m_spectatorFrame);
+    m_broadcaster->publish(m_spectatorFrame);
+  }
+}
+
+void
+World::updateSimulation(std::chrono::microseconds delta)
+{
+  // note: events follow simulated time, thus the same deltas & inputs always
+  // give the same states (regardless of real time spent by update)
+  m_time += delta;
+  const auto now = m_time;
+  const auto firstNewEvent = m_nextEventSequence;
+  const auto realDelta = delta;
   using namespace std::chrono_literals;
   // slow down the game if FPS fall below 30 frames per second (33ms)
   // => prevent tunneling when updating movement and detecting collisions
@@ -94,52 +370,90 @@ World::update(std::chrono::microseconds delta)
   delta *= m_gameState.speed;
 
   // process events
-  while (!m_events.empty()) {
-    if (m_events.top().getDeadline() < now) {
-      SDL_Log("Popping event");
-      const auto event = m_events.top();
-      m_events.pop();
-
-      // Fix: event could possibly destroy all events, including the one that is
-      // being evaluated at the moments
-      event.getCallback()();
-    } else {
-      break;
+  {
+    const ProfileScope scope(ProfilePhase::events);
+    if (auto* profiler = Profiler::getCurrent()) {
+      profiler->recordEventQueueDepth(m_events.size());
+    }
+
+    // note: events pushed by events are evaluated by the next update
+    while (!m_events.empty()) {
+      if (m_events.top().getDeadline() <= now &&
+          m_events.top().getSequence() < firstNewEvent) {
+        SDL_Log("Popping event");
+        const auto event = m_events.top();
+        m_events.pop();
+
+        if (auto* profiler = Profiler::getCurrent()) {
+          profiler->recordTimerLateness(
+            std::chrono::duration_cast<std::chrono::microseconds>(
+              now - event.getDeadline()));
+        }
+
+        // Fix: event could possibly destroy all events, including the one that
+        // is being evaluated at the moments
+        event.getCallback()();
+      } else {
+        break;
+      }
     }
   }
 
+  // advance scripts in fixed ticks of real time (unaffected by game speed)
+  m_pendingTickTime += realDelta;
+  const auto ticks = m_pendingTickTime / tickDuration;
+  m_pendingTickTime -= ticks * tickDuration;
+  m_scripts.tick(static_cast<unsigned>(ticks));
+
+  if (m_isAutopilotEnabled) {
+    updateAutopilot();
+  }
+
   if (m_gameStatus != GameStatus::running) {
     return;
   }
 
   if (m_ball && hasBallFallenDown(*m_ball)) {
-    m_events.push(Event([=]() { onBallFallDown(); }));
+    pushEvent([this]() { onBallFallDown(); });
   }
 
-  updatePickups(delta);
+  {
+    const ProfileScope scope(ProfilePhase::pickups);
+    updatePickups(delta);
+  }
 
   Paddle paddleBackup = m_paddle;
 
   // dry run: simulate movement and detect if any collision could happened on
   // the way
-  updatePaddleDynamics(m_paddle, delta);
+  {
+    const ProfileScope scope(ProfilePhase::dynamics);
+    updatePaddleDynamics(m_paddle, delta);
+  }
 
   if (m_ball.has_value()) {
     Ball ballBackup = *m_ball;
-    updateBallDynamics(*m_ball, delta);
+    {
+      const ProfileScope scope(ProfilePhase::dynamics);
+      updateBallDynamics(*m_ball, delta);
+    }
 
-    bool hasAnyCollision = detectBallCollisions(*m_ball, false) ||
-                           collidesBallWithWorldBoundaries(*m_ball);
+    bool hasAnyCollision = false;
+    {
+      const ProfileScope scope(ProfilePhase::collisionDryRun);
+      hasAnyCollision = detectBallCollisions(*m_ball, false) ||
+                        collidesBallWithWorldBoundaries(*m_ball);
+    }
 
     // if ball has a potential collision, revert the state to initial and do
     // microstepping
     if (hasAnyCollision) {
+      const ProfileScope scope(ProfilePhase::microstepping);
       m_ball = ballBackup;
       m_paddle = paddleBackup;
 
-      constexpr auto microstepsCount = 10;
-      const auto microDelta = delta / microstepsCount;
-      for (int i = 0; i < microstepsCount; i++) {
+      const auto microDelta = delta / m_quality.ballMicrosteps;
+      for (unsigned i = 0; i < m_quality.ballMicrosteps; i++) {
         updatePaddleDynamics(m_paddle, microDelta);
         updateBallDynamics(*m_ball, microDelta);
         correctBallAgainstWorldBoundaries(*m_ball);
@@ -148,6 +462,18 @@ World::update(std::chrono::microseconds delta)
     }
   }
 
+  // follow ball (or paddle, when ball is lost) and stream level around
+  const auto elapsedSeconds = delta.count() / static_cast<float>(1000'000.0);
+  const auto cameraTarget =
+    m_ball ? m_ball->position
+           : SDL_FPoint{ m_paddle.body.x + m_paddle.body.w * 0.5f,
+                         m_paddle.body.y };
+  m_camera.follow(cameraTarget, m_worldSize, elapsedSeconds);
+  // note: paddle is at the bottom of (possibly taller) world, player must
+  // see it even when ball flies high
+  m_camera.keepInView(m_paddle.body, m_worldSize);
+  updateLevelStreaming();
+
   // update pickups and detect collisions
   // note: pickups are moving slow, we don't need to the maskarade above
 
@@ -157,16 +483,34 @@ World::update(std::chrono::microseconds delta)
   }
 }
 
-void
-World::render(Application& app)
+std::optional<std::chrono::microseconds>
+World::getTimeUntilChange() const
 {
-  renderEntities(app);
-  renderHUD(app);
+  using namespace std::chrono;
+  if (m_gameStatus == GameStatus::running ||
+      (m_isAutopilotEnabled && m_gameStatus == GameStatus::initial_screen)) {
+    return microseconds(0);
+  }
+
+  // overlays are static, only pending events & scripts can change the world
+  std::optional<microseconds> result;
+  if (!m_events.empty()) {
+    const auto untilEvent =
+      duration_cast<microseconds>(m_events.top().getDeadline() - m_time);
+    result = std::max(untilEvent, microseconds(0));
+  }
+
+  if (const auto ticks = m_scripts.getTicksUntilWakeUp()) {
+    const auto untilTick = tickDuration * *ticks - m_pendingTickTime;
+    result = std::min(result.value_or(untilTick), untilTick);
+  }
+  return result;
 }
 
 void
-World::renderEntities(Application& app)
+World::render(Application& app)
 {
+  // note: transform is computed once and shared by all entities of frame
   const auto appSize = app.getWindowSize();
   SDL_Rect viewport;
   viewport.x = Constants::worldRenderingHorizontalMargin;
@@ -174,63 +518,81 @@ World::renderEntities(Application& app)
   viewport.w = appSize.x - Constants::worldRenderingHorizontalMargin * 2;
   viewport.h = appSize.y - Constants::worldRenderingTopMargin;
 
-  SDL_RenderSetViewport(app.getRenderer(), &viewport);
+  app.setViewport(&viewport);
+  {
+    const ProfileScope scope(ProfilePhase::renderEntities);
+    renderEntities(app, m_camera.getViewTransform({ viewport.w, viewport.h }));
+  }
+  app.setViewport(nullptr);
+
+  const ProfileScope scope(ProfilePhase::renderHUD);
+  renderHUD(app);
+}
 
-  // render tiles
-  const auto tileTexture = app.getTexture("tile");
+void
+World::renderEntities(Application& app, const ViewTransform& transform)
+{
+  // render tiles: colors first, then texture overlays in one run from atlas
+  // note: tiles never overlap, thus the order does not change the result
+  m_visibleTileRects.clear();
   for (const auto& entity : m_tileMap) {
-    const auto& c = entity.color;
-    SDL_SetRenderDrawColor(app.getRenderer(), c.r, c.g, c.b, c.a);
+    if (!SDL_HasIntersectionF(&entity.body, &m_camera.view)) {
+      continue;
+    }
 
-    const auto rect = worldToViewCoordinates(app, entity.body);
+    const auto rect = transform.toView(entity.body);
 
-    SDL_RenderFillRect(app.getRenderer(), &rect);
+    app.fillRect(rect, entity.color);
+    m_visibleTileRects.push_back(rect);
+  }
 
-    if (tileTexture) {
-      SDL_SetTextureBlendMode(tileTexture, SDL_BLENDMODE_BLEND);
-      SDL_RenderCopy(app.getRenderer(), tileTexture, NULL, &rect);
+  // note: tiles have one or two sizes (rounding), look up the scaled sprite
+  // only when it changes
+  if (m_quality.hasTileOverlay && app.getSprite(m_sprites.tile).texture) {
+    Sprite tileSprite;
+    SDL_Point tileSize{ -1, -1 };
+    for (const auto& rect : m_visibleTileRects) {
+      if (rect.w != tileSize.x || rect.h != tileSize.y) {
+        tileSize = SDL_Point{ rect.w, rect.h };
+        tileSprite = app.getScaledSprite(m_sprites.tile, tileSize);
+      }
+      app.copySprite(tileSprite, rect);
     }
   }
 
   // render ball
   if (m_ball) {
-    const auto& c = Color::black;
-    SDL_SetRenderDrawColor(app.getRenderer(), c.r, c.g, c.b, c.a);
-
     SDL_FRect ballBody = m_ball->getBoundingRect();
-    const auto rect = worldToViewCoordinates(app, ballBody);
+    const auto rect = transform.toView(ballBody);
 
-    const auto ballTexture = app.getTexture("ball");
-    if (ballTexture) {
-      SDL_SetTextureBlendMode(ballTexture, SDL_BLENDMODE_BLEND);
-      SDL_RenderCopy(app.getRenderer(), ballTexture, NULL, &rect);
+    // note: ball changes its size by pickups, each size is scaled once
+    const auto ballSprite =
+      app.getScaledSprite(m_sprites.ball, SDL_Point{ rect.w, rect.h });
+    if (ballSprite.texture) {
+      app.copySprite(ballSprite, rect);
     } else {
-      SDL_RenderFillRect(app.getRenderer(), &rect);
+      app.fillRect(rect, Color::black);
     }
   }
 
   // render paddle
   {
-    const auto& c = Color::black;
-    SDL_SetRenderDrawColor(app.getRenderer(), c.r, c.g, c.b, c.a);
-
     SDL_FRect body = m_paddle.body;
-    const auto rect = worldToViewCoordinates(app, body);
+    const auto rect = transform.toView(body);
 
-    SDL_RenderFillRect(app.getRenderer(), &rect);
+    app.fillRect(rect, Color::black);
   }
 
   // render pickups
   for (const auto& entity : m_pickups) {
-    const auto& c = entity.color;
-    SDL_SetRenderDrawColor(app.getRenderer(), c.r, c.g, c.b, c.a);
+    if (!SDL_HasIntersectionF(&entity.body, &m_camera.view)) {
+      continue;
+    }
 
-    const auto rect = worldToViewCoordinates(app, entity.body);
+    const auto rect = transform.toView(entity.body);
 
-    SDL_RenderFillRect(app.getRenderer(), &rect);
+    app.fillRect(rect, entity.color);
   }
-
-  SDL_RenderSetViewport(app.getRenderer(), nullptr);
 }
 
 void
@@ -242,7 +604,7 @@ World::renderHUD(Application& app)
     {
       const auto blackText = app.getCachedTextureForText(
         std::format("Lives: {}", m_gameState.remainingBalls));
-      const auto textSize = sdl_helper::getTextureSize(blackText);
+      const auto textSize = app.getTextureSize(blackText);
 
       const auto ws = app.getWindowSize();
       SDL_Rect rect;
@@ -251,14 +613,14 @@ World::renderHUD(Application& app)
       rect.w = textSize.x;
       rect.h = textSize.y;
 
-      SDL_RenderCopy(app.getRenderer(), blackText, NULL, &rect);
+      app.copyTexture(blackText, NULL, &rect);
     }
 
     // render score
     {
       const auto blackText = app.getCachedTextureForText(
         std::format("Score: {}", m_gameState.score));
-      const auto textSize = sdl_helper::getTextureSize(blackText);
+      const auto textSize = app.getTextureSize(blackText);
 
       const auto ws = app.getWindowSize();
       SDL_Rect rect;
@@ -267,31 +629,40 @@ World::renderHUD(Application& app)
       rect.w = textSize.x;
       rect.h = textSize.y;
 
-      SDL_RenderCopy(app.getRenderer(), blackText, NULL, &rect);
+      app.copyTexture(blackText, NULL, &rect);
     }
   }
 
   else {
-    std::string textureName = [](GameStatus status) -> std::string {
+    const auto overlay = [this](GameStatus status) -> SpriteHandle {
       switch (status) {
         case GameStatus::initial_screen:
-          return "arkanoid";
+          return m_sprites.initialScreen;
         case GameStatus::game_over:
-          return "game_over";
+          return m_sprites.gameOver;
         case GameStatus::you_won:
-          return "you_won";
+          return m_sprites.youWon;
         default:
           assert(false);
-          return "";
+          return SpriteHandle{};
       }
     }(m_gameStatus);
 
-    const auto overlayTexture = app.getTexture(textureName);
-    SDL_SetTextureBlendMode(overlayTexture, SDL_BLENDMODE_BLEND);
-    SDL_RenderCopy(app.getRenderer(), overlayTexture, NULL, NULL);
+    const auto& overlaySprite = app.getSprite(overlay);
+    app.copyTexture(overlaySprite.texture, &overlaySprite.source, NULL);
   }
 }
 
+void
+World::bindSprites(const Application& app)
+{
+  m_sprites.tile = app.findSprite("tile");
+  m_sprites.ball = app.findSprite("ball");
+  m_sprites.initialScreen = app.findSprite("arkanoid");
+  m_sprites.gameOver = app.findSprite("game_over");
+  m_sprites.youWon = app.findSprite("you_won");
+}
+
 void
 World::onKeyPressed(bool isKeyDown, SDL_Keysym key)
 {
@@ -312,12 +683,518 @@ World::onKeyPressed(bool isKeyDown, SDL_Keysym key)
     restartLevel();
   }
 
+  if (key.sym == SDLK_a && isKeyDown) {
+    setAutopilot(!m_isAutopilotEnabled);
+  }
+
   if (key.sym == SDLK_RETURN && isKeyDown &&
       m_gameStatus == GameStatus::initial_screen) {
     restartLevel();
   }
 }
 
+bool
+World::submitCommand(const WorldCommand& command)
+{
+  return m_commands->push(command);
+}
+
+void
+World::applyCommands()
+{
+  // note: bounded, producers submitting all the time can not stall the tick
+  for (std::size_t i = 0; i < m_commands->getCapacity(); i++) {
+    const auto command = m_commands->pop();
+    if (!command) {
+      break;
+    }
+    applyCommand(*command);
+  }
+}
+
+void
+World::applyCommand(const WorldCommand& command)
+{
+  switch (command.type) {
+    case WorldCommand::Type::moveLeft:
+      m_paddle.keys[ControllerKeys::move_left] = command.value != 0;
+      break;
+    case WorldCommand::Type::moveRight:
+      m_paddle.keys[ControllerKeys::move_right] = command.value != 0;
+      break;
+    case WorldCommand::Type::releaseBall:
+      onReleaseBall();
+      break;
+    case WorldCommand::Type::agentAction:
+      if (command.value >= 0 &&
+          command.value <= static_cast<int>(AgentAction::release)) {
+        applyAction(static_cast<AgentAction>(command.value));
+      }
+      break;
+    case WorldCommand::Type::restartLevel:
+      restartLevel();
+      break;
+    case WorldCommand::Type::setAutopilot:
+      setAutopilot(command.value != 0);
+      break;
+  }
+}
+
+void
+World::setAutopilot(bool isEnabled)
+{
+  SDL_Log("setAutopilot: %d", isEnabled);
+  m_isAutopilotEnabled = isEnabled;
+
+  // note: do not keep moving once player takes over
+  m_paddle.keys.reset();
+}
+
+bool
+World::isAutopilotEnabled() const
+{
+  return m_isAutopilotEnabled;
+}
+
+std::size_t
+World::getPendingEventCount() const
+{
+  return m_events.size();
+}
+
+void
+World::setRandomSeed(unsigned seed)
+{
+  m_random.seed(seed);
+}
+
+void
+World::applyAction(AgentAction action)
+{
+  m_paddle.keys[ControllerKeys::move_left] = action == AgentAction::left;
+  m_paddle.keys[ControllerKeys::move_right] = action == AgentAction::right;
+  if (action == AgentAction::release) {
+    onReleaseBall();
+  }
+}
+
+void
+World::getObservation(std::span<float> observation) const
+{
+  assert(observation.size() == observationSize);
+  std::fill(observation.begin(), observation.end(), 0.0f);
+
+  const auto& view = m_camera.view;
+  const auto toViewX = [&view](float x) { return (x - view.x) / view.w; };
+  const auto toViewY = [&view](float y) { return (y - view.y) / view.h; };
+
+  observation[0] = toViewX(m_paddle.body.x + m_paddle.body.w * 0.5f);
+  observation[1] = m_paddle.body.w / view.w;
+  if (m_ball) {
+    observation[2] = 1.0f;
+    observation[3] = toViewX(m_ball->position.x);
+    observation[4] = toViewY(m_ball->position.y);
+    observation[5] = m_ball->speed.x / Constants::ballSpeed;
+    observation[6] = m_ball->speed.y / Constants::ballSpeed;
+  }
+  observation[7] = static_cast<float>(m_gameState.remainingBalls);
+
+  // tiles of cells whose grid starts at view's top-left cell
+  auto cells = observation.subspan(8);
+  const auto firstColumn = static_cast<int>(view.x / Constants::tileWidth);
+  const auto firstRow = static_cast<int>(view.y / Constants::tileHeight);
+  for (const auto& tile : m_tileMap) {
+    const auto column = tile.cell.x - firstColumn;
+    const auto row = tile.cell.y - firstRow;
+    if (column >= 0 && column < static_cast<int>(Constants::maxTilesX) &&
+        row >= 0 && row < static_cast<int>(Constants::maxTilesY)) {
+      cells[row * Constants::maxTilesX + column] = tile.lifes;
+    }
+  }
+}
+
+void
+World::renderOccupancyGrid(OccupancyGrid& grid) const
+{
+  static_assert(static_cast<int>(GridChannel::pickupPaddleSize) -
+                  static_cast<int>(GridChannel::pickupSpeedup) + 1 ==
+                Pickup::Type::size);
+
+  grid.setView(toGridRect(m_camera.view));
+  grid.clear();
+  for (const auto& tile : m_tileMap) {
+    grid.addRect(GridChannel::tiles,
+                 toGridRect(tile.body),
+                 static_cast<std::uint8_t>(std::min(255, 128 * tile.lifes)));
+  }
+  for (const auto& pickup : m_pickups) {
+    const auto channel = static_cast<GridChannel>(
+      static_cast<int>(GridChannel::pickupSpeedup) + pickup.type);
+    grid.addRect(channel, toGridRect(pickup.body), 255);
+  }
+  grid.addRect(GridChannel::paddle, toGridRect(m_paddle.body), 255);
+
+  if (m_ball) {
+    const auto body = toGridRect(m_ball->getBoundingRect());
+    grid.addRect(GridChannel::ball, body, 255);
+    const auto& speed = m_ball->speed;
+    grid.setRect(GridChannel::ballSpeedX,
+                 body,
+                 OccupancyGrid::toSigned(speed.x / Constants::ballSpeed));
+    grid.setRect(GridChannel::ballSpeedY,
+                 body,
+                 OccupancyGrid::toSigned(speed.y / Constants::ballSpeed));
+  }
+}
+
+void
+World::setDeterministic(bool isDeterministic)
+{
+  m_isDeterministic = isDeterministic;
+}
+
+void
+World::saveState(WorldSnapshot& snapshot) const
+{
+  if (m_streamer && !m_isDeterministic) {
+    throw std::runtime_error("Streamed level can be saved only when "
+                             "world is deterministic");
+  }
+
+  snapshot.scripts = m_scripts.save();
+  for (const auto& script : snapshot.scripts) {
+    if (script.tag == ScriptTag::none || script.awaitedEvent) {
+      throw std::runtime_error("Script waiting for event can not be saved");
+    }
+  }
+
+  snapshot.tileMap = m_tileMap;
+  snapshot.remainingTiles = m_remainingTiles;
+  snapshot.nextTileId = m_nextTileId;
+  snapshot.nextPickupId = m_nextPickupId;
+  snapshot.random = m_random;
+  snapshot.collisionSpans = m_collisionSpans;
+  snapshot.pickups = m_pickups;
+  snapshot.ball = m_ball;
+  snapshot.paddle = m_paddle;
+  snapshot.events = m_events;
+  snapshot.nextEventSequence = m_nextEventSequence;
+  snapshot.time = m_time;
+  snapshot.pendingTickTime = m_pendingTickTime;
+  snapshot.gameStatus = m_gameStatus;
+  snapshot.isAutopilotEnabled = m_isAutopilotEnabled;
+  snapshot.tick = m_tick;
+  snapshot.gameState = m_gameState;
+  snapshot.worldSize = m_worldSize;
+  snapshot.camera = m_camera;
+  snapshot.campaignLevel = m_campaignLevel;
+  snapshot.level = m_level;
+  snapshot.residentChunks = m_residentChunks;
+  snapshot.isChunkResident = m_isChunkResident;
+  snapshot.hitTileLifes = m_hitTileLifes;
+}
+
+void
+World::restoreState(const WorldSnapshot& snapshot)
+{
+  // note: scripts of saved state are recreated from their waits
+  m_scripts.cancelAll();
+  for (const auto& script : snapshot.scripts) {
+    m_scripts.start(resumeTimeline(script.tag, script.remainingTicks),
+                    script.tag);
+  }
+
+  // level could change since saving (e.g. next level of campaign)
+  const auto isSameLevel =
+    m_level.has_value() == snapshot.level.has_value() &&
+    (!m_level || m_level->tiles.data() == snapshot.level->tiles.data());
+  m_level = snapshot.level;
+  if (!isSameLevel) {
+    m_streamer.reset();
+    if (m_level) {
+      m_streamer = std::make_unique<LevelStreamer>(*m_level);
+    }
+  }
+
+  m_tileMap = snapshot.tileMap;
+  m_remainingTiles = snapshot.remainingTiles;
+  m_nextTileId = snapshot.nextTileId;
+  m_nextPickupId = snapshot.nextPickupId;
+  m_random = snapshot.random;
+  m_collisionSpans = snapshot.collisionSpans;
+  m_pickups = snapshot.pickups;
+  m_ball = snapshot.ball;
+  m_paddle = snapshot.paddle;
+  m_events = snapshot.events;
+  m_nextEventSequence = snapshot.nextEventSequence;
+  m_time = snapshot.time;
+  m_pendingTickTime = snapshot.pendingTickTime;
+  m_gameStatus = snapshot.gameStatus;
+  m_isAutopilotEnabled = snapshot.isAutopilotEnabled;
+  m_tick = snapshot.tick;
+  m_gameState = snapshot.gameState;
+  m_worldSize = snapshot.worldSize;
+  m_camera = snapshot.camera;
+  m_campaignLevel = snapshot.campaignLevel;
+  m_residentChunks = snapshot.residentChunks;
+  m_isChunkResident = snapshot.isChunkResident;
+  m_isChunkRequested.assign(m_isChunkResident.size(), false);
+  m_hitTileLifes = snapshot.hitTileLifes;
+}
+
+std::uint64_t
+World::getStateChecksum() const
+{
+  // state published for external tools (zero-initialized, no garbage in
+  // padding) and the rest of simulation it does not show: tiles out of
+  // view, pickups, effects (scripts), random generator & pending events
+  Checksum checksum;
+  const auto snapshot = getStateSnapshot();
+  checksum.addBytes(&snapshot, sizeof(snapshot));
+
+  checksum.add(m_gameState.speed);
+  for (const auto& tile : m_tileMap) {
+    checksum.add(tile.id);
+    checksum.add(tile.lifes);
+  }
+  for (const auto& pickup : m_pickups) {
+    checksum.add(pickup.id);
+    checksum.add(pickup.type);
+    checksum.add(pickup.body.x);
+    checksum.add(pickup.body.y);
+  }
+  for (const auto& script : m_scripts.save()) {
+    checksum.add(script.tag);
+    checksum.add(script.remainingTicks);
+    checksum.add(script.awaitedEvent.has_value());
+    checksum.add(script.awaitedEvent.value_or(ScriptEvent{}));
+  }
+
+  // note: the next output of linear congruential generator identifies its
+  // state
+  auto random = m_random;
+  checksum.add(random());
+  checksum.add(m_nextEventSequence);
+  checksum.add(m_events.size());
+  return checksum.get();
+}
+
+void
+World::exportState(const std::string& name)
+{
+  m_stateWriter = std::make_unique<shared_state::Writer>(name);
+  m_stateWriter->publish(getStateSnapshot());
+}
+
+shared_state::Snapshot
+World::getStateSnapshot() const
+{
+  static_assert(shared_state::tileColumns == Constants::maxTilesX &&
+                shared_state::tileRows == Constants::maxTilesY);
+
+  shared_state::Snapshot snapshot{};
+  snapshot.tick = m_tick;
+  snapshot.status = m_gameStatus;
+  snapshot.score = m_gameState.score;
+  snapshot.remainingBalls = m_gameState.remainingBalls;
+  snapshot.remainingTiles = m_remainingTiles;
+  snapshot.speed = m_gameState.speed;
+  if (m_ball) {
+    snapshot.hasBall = 1;
+    snapshot.ballX = m_ball->position.x;
+    snapshot.ballY = m_ball->position.y;
+    snapshot.ballSpeedX = m_ball->speed.x;
+    snapshot.ballSpeedY = m_ball->speed.y;
+    snapshot.ballRadius = m_ball->radius;
+  }
+  snapshot.paddleX = m_paddle.body.x;
+  snapshot.paddleY = m_paddle.body.y;
+  snapshot.paddleWidth = m_paddle.body.w;
+  snapshot.paddleHeight = m_paddle.body.h;
+
+  const auto& view = m_camera.view;
+  snapshot.viewX = view.x;
+  snapshot.viewY = view.y;
+  snapshot.viewWidth = view.w;
+  snapshot.viewHeight = view.h;
+
+  // tiles of cells whose grid starts at view's top-left cell
+  snapshot.firstColumn = static_cast<int>(view.x / Constants::tileWidth);
+  snapshot.firstRow = static_cast<int>(view.y / Constants::tileHeight);
+  for (const auto& tile : m_tileMap) {
+    const auto column = tile.cell.x - snapshot.firstColumn;
+    const auto row = tile.cell.y - snapshot.firstRow;
+    if (column >= 0 && column < static_cast<int>(Constants::maxTilesX) &&
+        row >= 0 && row < static_cast<int>(Constants::maxTilesY)) {
+      snapshot.tiles[row * Constants::maxTilesX + column] = tile.lifes;
+    }
+  }
+  return snapshot;
+}
+
+spectator::Broadcaster&
+World::broadcastToSpectators()
+{
+  if (!m_broadcaster) {
+    m_broadcaster = std::make_unique<spectator::Broadcaster>();
+  }
+  return *m_broadcaster;
+}
+
+void
+World::getSpectatorFrame(spectator::Frame& frame) const
+{
+  using spectator::Field;
+  using spectator::quantize;
+
+  frame.tick = m_tick;
+  frame[Field::status] = m_gameStatus;
+  frame[Field::score] = m_gameState.score;
+  frame[Field::remainingBalls] =
+    static_cast<std::int32_t>(m_gameState.remainingBalls);
+  frame[Field::speed] =
+    static_cast<std::int32_t>(std::lround(m_gameState.speed * 1000.0f));
+
+  frame[Field::ballX] = m_ball ? quantize(m_ball->position.x) : 0;
+  frame[Field::ballY] = m_ball ? quantize(m_ball->position.y) : 0;
+  frame[Field::ballRadius] = m_ball ? quantize(m_ball->radius) : 0;
+  frame[Field::paddleX] = quantize(m_paddle.body.x);
+  frame[Field::paddleY] = quantize(m_paddle.body.y);
+  frame[Field::paddleWidth] = quantize(m_paddle.body.w);
+  frame[Field::paddleHeight] = quantize(m_paddle.body.h);
+
+  const auto& view = m_camera.view;
+  frame[Field::viewX] = quantize(view.x);
+  frame[Field::viewY] = quantize(view.y);
+  frame[Field::viewWidth] = quantize(view.w);
+  frame[Field::viewHeight] = quantize(view.h);
+
+  // note: tiles of evicted chunks are missing, spectators see only the view
+  frame.columns =
+    static_cast<std::int32_t>(std::ceil(m_worldSize.x / Constants::tileWidth));
+  frame.rows = static_cast<std::int32_t>(
+    std::ceil(m_worldSize.y / Constants::tileHeight));
+  frame.cells.assign(static_cast<std::size_t>(frame.columns) * frame.rows,
+                     spectator::Cell{});
+  for (const auto& tile : m_tileMap) {
+    if (tile.cell.x >= 0 && tile.cell.x < frame.columns && tile.cell.y >= 0 &&
+        tile.cell.y < frame.rows) {
+      frame.cells[tile.cell.y * frame.columns + tile.cell.x] =
+        spectator::Cell{ tile.lifes, tile.color };
+    }
+  }
+
+  frame.pickups.clear();
+  for (const auto& pickup : m_pickups) {
+    frame.pickups.push_back(
+      spectator::FramePickup{ static_cast<std::uint8_t>(pickup.type),
+                              pickup.color,
+                              quantize(pickup.body.x),
+                              quantize(pickup.body.y),
+                              quantize(pickup.body.w),
+                              quantize(pickup.body.h) });
+  }
+}
+
+void
+World::setQuality(const QualitySettings& quality)
+{
+  if (quality.ballMicrosteps == 0) {
+    throw std::runtime_error("Ball needs at least one microstep");
+  }
+  m_quality = quality;
+}
+
+const QualitySettings&
+World::getQuality() const
+{
+  return m_quality;
+}
+
+const GameState&
+World::getGameState() const
+{
+  return m_gameState;
+}
+
+GameStatus
+World::getGameStatus() const
+{
+  return m_gameStatus;
+}
+
+void
+World::pushEvent(Event::EventCallback callback)
+{
+  m_events.push(Event(m_time, m_nextEventSequence++, std::move(callback)));
+}
+
+unsigned
+World::getRandom(unsigned count)
+{
+  return m_random() % count;
+}
+
+void
+World::updateAutopilot()
+{
+  if (m_gameStatus == GameStatus::initial_screen) {
+    restartLevel();
+  }
+
+  // note: finished game is restarted by its timeline
+  if (m_gameStatus != GameStatus::running) {
+    return;
+  }
+
+  if (!m_ball) {
+    onReleaseBall();
+  }
+
+  const auto paddleCenter = m_paddle.body.x + m_paddle.body.w * 0.5f;
+  const auto target = predictBallLanding(*m_ball).value_or(m_ball->position.x);
+
+  // keep still while ball lands on the middle part of paddle
+  const auto deadZone = m_paddle.body.w * 0.2f;
+  m_paddle.keys[ControllerKeys::move_left] = target < paddleCenter - deadZone;
+  m_paddle.keys[ControllerKeys::move_right] = target > paddleCenter + deadZone;
+}
+
+std::optional<float>
+World::predictBallLanding(const Ball& ball) const
+{
+  if (ball.speed.y == 0) {
+    return std::nullopt;
+  }
+
+  // vertical distance to paddle (via ceiling when ball moves upward)
+  const auto landingY = m_paddle.body.y - ball.radius;
+  const auto distance =
+    ball.speed.y > 0
+      ? landingY - ball.position.y
+      : (ball.position.y - ball.radius) + (landingY - ball.radius);
+  if (distance < 0) {
+    return std::nullopt;
+  }
+  const auto time = distance / std::abs(ball.speed.y);
+
+  // walls reflect ball, thus its center moves within [radius, width - radius]
+  // as triangle wave: unfold the path & fold it back into range
+  const auto range = m_worldSize.x - 2 * ball.radius;
+  if (range <= 0) {
+    return ball.position.x;
+  }
+  auto x = std::fmod(ball.position.x - ball.radius + ball.speed.x * time,
+                     2 * range);
+  if (x < 0) {
+    x += 2 * range;
+  }
+  if (x > range) {
+    x = 2 * range - x;
+  }
+  return ball.radius + x;
+}
+
 void
 World::updatePickups(std::chrono::microseconds delta)
 {
@@ -332,8 +1209,8 @@ World::updatePickups(std::chrono::microseconds delta)
     pickup.body.y += Constants::pickupFallSpeed * elapsedSeconds;
 
     // detect falling out of world
-    if (pickup.body.y > Constants::worldHeight - pickup.body.h * 0.5) {
-      m_events.push(Event([=]() { onPickupFallDown(pickup.id); }));
+    if (pickup.body.y > m_worldSize.y - pickup.body.h * 0.5) {
+      pushEvent([this, id = pickup.id]() { onPickupFallDown(id); });
       continue;
     }
 
@@ -342,7 +1219,7 @@ World::updatePickups(std::chrono::microseconds delta)
     pickupConvexHull.h = pickup.body.y - initialBody.y + initialBody.h;
 
     if (SDL_HasIntersectionF(&pickupConvexHull, &m_paddle.body)) {
-      m_events.push(Event([=]() { onPickupPicked(pickup.id); }));
+      pushEvent([this, id = pickup.id]() { onPickupPicked(id); });
     }
   }
 }
@@ -358,7 +1235,7 @@ World::updatePaddleDynamics(Paddle& paddle, std::chrono::microseconds delta)
 
   // keep within world
   paddle.body.x =
-    std::clamp(paddle.body.x, 0.0f, Constants::worldWidth - paddle.body.w);
+    std::clamp(paddle.body.x, 0.0f, m_worldSize.x - paddle.body.w);
 }
 
 void
@@ -374,7 +1251,7 @@ bool
 World::hasBallFallenDown(Ball& ball)
 {
   const bool isBelowWorld =
-    (ball.position.y + ball.radius > (Constants::worldHeight - 10));
+    (ball.position.y + ball.radius > (m_worldSize.y - 10));
   return isBelowWorld;
 }
 
@@ -383,10 +1260,10 @@ World::collidesBallWithWorldBoundaries(Ball& ball)
 {
   const bool isAboveWorld = (ball.position.y - ball.radius < 0);
   const bool isBelowWorld =
-    (ball.position.y + ball.radius > Constants::worldHeight);
+    (ball.position.y + ball.radius > m_worldSize.y);
   const bool isLeftWorld = (ball.position.x - ball.radius < 0);
   const bool isRightWorld =
-    (ball.position.x + ball.radius > Constants::worldWidth);
+    (ball.position.x + ball.radius > m_worldSize.x);
 
   return isAboveWorld || isBelowWorld || isLeftWorld || isRightWorld;
 }
@@ -395,9 +1272,9 @@ void
 World::correctBallAgainstWorldBoundaries(Ball& ball)
 {
   bool isAboveWorld = (ball.position.y - ball.radius < 0);
-  bool isBelowWorld = (ball.position.y + ball.radius > Constants::worldHeight);
+  bool isBelowWorld = (ball.position.y + ball.radius > m_worldSize.y);
   bool isLeftWorld = (ball.position.x - ball.radius < 0);
-  bool isRightWorld = (ball.position.x + ball.radius > Constants::worldWidth);
+  bool isRightWorld = (ball.position.x + ball.radius > m_worldSize.x);
 
   if ((isAboveWorld && ball.speed.y < 0) ||
       (isBelowWorld && ball.speed.y > 0)) {
@@ -413,7 +1290,7 @@ World::correctBallAgainstWorldBoundaries(Ball& ball)
   }
 
   if (isBelowWorld) {
-    ball.position.y = Constants::worldHeight - ball.radius;
+    ball.position.y = m_worldSize.y - ball.radius;
   }
 
   if (isLeftWorld) {
@@ -421,7 +1298,7 @@ World::correctBallAgainstWorldBoundaries(Ball& ball)
   }
 
   if (isRightWorld) {
-    ball.position.x = Constants::worldWidth - ball.radius;
+    ball.position.x = m_worldSize.x - ball.radius;
   }
 }
 
@@ -447,11 +1324,15 @@ World::detectBallCollisions(Ball& ball, bool reportCollisions)
     return false;
   };
 
-  for (const auto& tile : m_tileMap) {
-    if (detectBallVsBodyCollision(tile.body) && reportCollisions) {
-      m_events.push(Event([=]() { onBallHitTile(tile.id); }));
-    }
-  }
+  // test merged spans instead of separate tiles, so that hitting the seam of
+  // two neighbouring tiles (in a row or a column) is resolved only once
+  m_collisionSpans.forEachContact(
+    ballBody, [&](const CollisionSpans::Span& span) {
+      if (detectBallVsBodyCollision(span.body) && reportCollisions) {
+        const auto tileId = m_collisionSpans.getTileHitBySpan(span, ballBody);
+        pushEvent([this, tileId]() { onBallHitTile(tileId); });
+      }
+    });
 
   // detect collision against paddle
   bool hasPaddleCollision = detectBallVsBodyCollision(m_paddle.body);
@@ -506,40 +1387,35 @@ World::resolveBallSpeedCollisionAfter(Ball& ball, SDL_FRect rect)
   return { false, false };
 }
 
+Tile&
+World::spawnTile(unsigned x, unsigned y, SDL_Color color)
+{
+  auto tile =
+    Tile::atCell(SDL_Point{ static_cast<int>(x), static_cast<int>(y) });
+  tile.id = m_nextTileId++;
+  tile.color = color;
+
+  m_tileMap.push_back(tile);
+  return m_tileMap.back();
+}
+
 void
 World::spawnRandomTile(unsigned x, unsigned y)
 {
-  bool skipTile = std::rand() % 2;
+  bool skipTile = getRandom(2);
   if (skipTile) {
     return;
   }
 
-  SDL_FRect body;
-  body.x = x * Constants::tileWidth;
-  body.y = y * Constants::tileHeight;
-  body.w = Constants::tileWidth;
-  body.h = Constants::tileHeight;
-
-  Tile tile;
-
-  static unsigned id = 0;
-  tile.id = id++;
-  tile.body = body;
-  tile.color = getRandomStandardColor();
-
-  m_tileMap.push_back(tile);
+  spawnTile(x, y, getStandardColor(getRandom(standardColors.size())));
 }
 
 void
-World::spawnRandomPickup(SDL_Point position, SDL_Color color)
+World::spawnPickup(SDL_Point position, SDL_Color color, Pickup::Type type)
 {
-  static unsigned id = 0;
-
   Pickup pickup;
-  pickup.id = id++;
-
-  // Choose random type
-  pickup.type = static_cast<Pickup::Type>(std::rand() % Pickup::Type::size);
+  pickup.id = m_nextPickupId++;
+  pickup.type = type;
 
   pickup.body.w = Constants::tileWidth * 0.5;
   pickup.body.h = Constants::tileHeight * 0.5;
@@ -550,6 +1426,15 @@ World::spawnRandomPickup(SDL_Point position, SDL_Color color)
   m_pickups.push_back(pickup);
 }
 
+void
+World::spawnRandomPickup(SDL_Point position, SDL_Color color)
+{
+  // Choose random type
+  spawnPickup(position,
+              color,
+              static_cast<Pickup::Type>(getRandom(Pickup::Type::size)));
+}
+
 void
 World::setWorldSpeed(float ratio)
 {
@@ -571,12 +1456,64 @@ World::restartLevel()
   initializeWorld();
 }
 
+Script
+World::restartLevelTimeline()
+{
+  co_await script::ticks(Constants::restartDelay * Constants::ticksPerSecond);
+  finishTimeline(ScriptTag::restart_level);
+}
+
+Script
+World::worldSpeedTimeline(float ratio)
+{
+  setWorldSpeed(ratio);
+  co_await script::ticks(Constants::pickupEffectDuration *
+                         Constants::ticksPerSecond);
+  finishTimeline(ScriptTag::world_speed);
+}
+
+Script
+World::ballSizeTimeline()
+{
+  setBallSize(0.5);
+  co_await script::ticks(Constants::pickupEffectDuration *
+                         Constants::ticksPerSecond);
+  finishTimeline(ScriptTag::ball_size);
+}
+
+Script
+World::resumeTimeline(ScriptTag tag, unsigned remainingTicks)
+{
+  co_await script::ticks(remainingTicks);
+  finishTimeline(tag);
+}
+
+void
+World::finishTimeline(ScriptTag tag)
+{
+  switch (tag) {
+    case ScriptTag::restart_level:
+      restartLevel();
+      break;
+    case ScriptTag::world_speed:
+      setWorldSpeed(1.0);
+      break;
+    case ScriptTag::ball_size:
+      setBallSize(2.0);
+      break;
+    case ScriptTag::none:
+      break;
+  }
+}
+
 void
 World::onLevelFinished()
 {
   SDL_Log("onLevelFinished");
   m_gameStatus = GameStatus::you_won;
-  m_events.push(Event(std::chrono::seconds(10), [=]() { restartLevel(); }));
+  m_campaignLevel++;
+  m_scripts.raise(ScriptEvent::level_finished);
+  m_scripts.start(restartLevelTimeline(), ScriptTag::restart_level);
 }
 
 void
@@ -584,7 +1521,8 @@ World::onGameOver()
 {
   SDL_Log("onGameOver");
   m_gameStatus = GameStatus::game_over;
-  m_events.push(Event(std::chrono::seconds(10), [=]() { restartLevel(); }));
+  m_scripts.raise(ScriptEvent::game_over);
+  m_scripts.start(restartLevelTimeline(), ScriptTag::restart_level);
 }
 
 void
@@ -593,6 +1531,7 @@ World::onReleaseBall()
   SDL_Log("onReleaseBall");
   if (!m_ball.has_value()) {
     initializeBall();
+    m_scripts.raise(ScriptEvent::ball_released);
   }
 }
 
@@ -610,24 +1549,39 @@ World::onBallHitTile(EntityID id)
   if (it != m_tileMap.end()) {
     it->lifes--;
 
+    // level tiles may be evicted with chunk, remember the damage
+    if (m_level) {
+      const auto columns = m_level->columns;
+      m_hitTileLifes[it->cell.y * columns + it->cell.x] = it->lifes;
+    }
+
     if (it->lifes == 0) {
       willBeDestroyed = true;
 
       m_gameState.score += Constants::rewardTileDestroyed;
+
+      // note: count of level file is not verified, never wrap around
+      m_remainingTiles -= m_remainingTiles > 0 ? 1 : 0;
+      m_scripts.raise(ScriptEvent::tile_destroyed);
     }
   }
 
   // when tile was destroyed and with some lower chance, generate special pickup
-  if (willBeDestroyed && std::rand() % 5 == 0) {
+  if (willBeDestroyed) {
     SDL_Point spawnPoint = { it->body.x, it->body.y };
-    spawnRandomPickup(spawnPoint, it->color);
+    if (it->drop) {
+      spawnPickup(spawnPoint, it->color, *it->drop);
+    } else if (getRandom(5) == 0) {
+      spawnRandomPickup(spawnPoint, it->color);
+    }
   }
   if (willBeDestroyed) {
     // destroy it
+    m_collisionSpans.removeTile(*it);
     m_tileMap.erase(it);
   }
 
-  if (m_tileMap.empty()) {
+  if (willBeDestroyed && m_remainingTiles == 0) {
     onLevelFinished();
   }
 }
@@ -637,6 +1591,7 @@ World::onBallFallDown()
 {
   SDL_Log("onBallFallDown");
   m_ball.reset();
+  m_scripts.raise(ScriptEvent::ball_lost);
 
   m_gameState.score -= Constants::penaltyLostBall;
   if (m_gameState.remainingBalls == 0) {
@@ -659,20 +1614,20 @@ World::onPickupPicked(EntityID pickupId)
   if (it != m_pickups.end()) {
 
     m_gameState.score += Constants::rewardPickupPicked;
+    m_scripts.raise(ScriptEvent::pickup_picked);
 
     const auto& pickup = *it;
     switch (pickup.type) {
       case Pickup::Type::speedup: {
-        setWorldSpeed(2.0);
-        m_events.push(
-          Event(std::chrono::seconds(10), [=]() { setWorldSpeed(1.0); }));
+        // the latest pickup decides when the speed is restored
+        m_scripts.cancel(ScriptTag::world_speed);
+        m_scripts.start(worldSpeedTimeline(2.0), ScriptTag::world_speed);
         break;
       }
 
       case Pickup::Type::slowdown: {
-        setWorldSpeed(1.0);
-        m_events.push(
-          Event(std::chrono::seconds(10), [=]() { setWorldSpeed(1.0); }));
+        m_scripts.cancel(ScriptTag::world_speed);
+        m_scripts.start(worldSpeedTimeline(1.0), ScriptTag::world_speed);
         break;
       }
 
@@ -682,9 +1637,7 @@ World::onPickupPicked(EntityID pickupId)
         if (m_ball && m_ball->radius < minimalRadius)
           break;
 
-        setBallSize(0.5);
-        m_events.push(
-          Event(std::chrono::seconds(10), [=]() { setBallSize(2.0); }));
+        m_scripts.start(ballSizeTimeline(), ScriptTag::ball_size);
         break;
       }
 
@@ -692,11 +1645,11 @@ World::onPickupPicked(EntityID pickupId)
         // until restart
         m_paddle.body.w *= 2;
         m_paddle.body.w =
-          std::clamp(m_paddle.body.w, 0.0f, Constants::worldWidth * 0.99f);
+          std::clamp(m_paddle.body.w, 0.0f, m_worldSize.x * 0.99f);
 
-        if (Constants::worldWidth < (m_paddle.body.x + m_paddle.body.w)) {
+        if (m_worldSize.x < (m_paddle.body.x + m_paddle.body.w)) {
           m_paddle.body.x = std::clamp(
-            m_paddle.body.x, 0.0f, Constants::worldWidth - m_paddle.body.w);
+            m_paddle.body.x, 0.0f, m_worldSize.x - m_paddle.body.w);
         }
         break;
       }
@@ -723,23 +1676,3 @@ World::onPickupFallDown(EntityID pickupId)
     m_pickups.erase(it);
   }
 }
-
-SDL_Rect
-World::worldToViewCoordinates(Application& app, SDL_FRect units)
-{
-  SDL_Rect viewport;
-  SDL_RenderGetViewport(app.getRenderer(), &viewport);
-
-  const auto widthRatio =
-    static_cast<float>(viewport.w) / Constants::worldWidth;
-  const auto heightRatio =
-    static_cast<float>(viewport.h) / Constants::worldHeight;
-
-  units.x *= widthRatio;
-  units.w *= widthRatio;
-
-  units.y *= heightRatio;
-  units.h *= heightRatio;
-
-  return frecTorec(units);
-}
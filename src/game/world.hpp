@@ -6,17 +6,33 @@
 #include <bitset>
 #include <cassert>
 #include <chrono>
+#include <memory>
 #include <queue>
 #include <utility>
 #include <vector>
 #include <optional>
 #include <queue>
+#include <random>
+#include <span>
+#include <unordered_map>
 
 #include "application.hpp"
 #include "ball.hpp"
+#include "camera.hpp"
+#include "campaign.hpp"
+#include "collision_spans.hpp"
 #include "constants.hpp"
 #include "entities.hpp"
 #include "event.hpp"
+#include "level.hpp"
+#include "level_streamer.hpp"
+#include "mpsc_queue.hpp"
+#include "occupancy_grid.hpp"
+#include "profiler.hpp"
+#include "quality_governor.hpp"
+#include "script.hpp"
+#include "shared_state.hpp"
+#include "spectator_stream.hpp"
 
 enum GameStatus
 {
@@ -38,22 +54,184 @@ struct GameState
   int score{ 0 };
 };
 
+//! Input of agent (bot) for single step, see World::applyAction()
+enum class AgentAction
+{
+  none,
+  left,
+  right,
+  release
+};
+
+//! Input submitted from any thread, applied at the start of the next tick
+//! (see World::submitCommand)
+struct WorldCommand
+{
+  enum class Type
+  {
+    //! Hold (value 1) or let go (value 0) paddle's movement key
+    moveLeft,
+    moveRight,
+    releaseBall,
+
+    //! AgentAction in value, see World::applyAction()
+    agentAction,
+    restartLevel,
+
+    //! Enable (value 1) or disable (value 0) autopilot
+    setAutopilot
+  };
+
+  Type type = { Type::releaseBall };
+  int value = { 0 };
+};
+
+/**
+ * @brief Saved simulation state of world (see World::saveState)
+ *
+ * Only the world which saved the state can restore it: pending events refer
+ * to their world.
+ */
+struct WorldSnapshot
+{
+  std::vector<Tile> tileMap;
+  unsigned remainingTiles{ 0 };
+  EntityID nextTileId{ 0 };
+  EntityID nextPickupId{ 0 };
+  std::minstd_rand random;
+  CollisionSpans collisionSpans;
+  std::vector<Pickup> pickups;
+  std::optional<Ball> ball;
+  Paddle paddle;
+  std::priority_queue<Event> events;
+  std::uint64_t nextEventSequence{ 0 };
+  Event::TimePoint time;
+  std::vector<ScriptScheduler::SavedScript> scripts;
+  std::chrono::microseconds pendingTickTime{ 0 };
+  GameStatus gameStatus{ GameStatus::initial_screen };
+  bool isAutopilotEnabled{ false };
+  std::uint64_t tick{ 0 };
+  GameState gameState;
+  SDL_FPoint worldSize{ 0, 0 };
+  Camera camera;
+  std::size_t campaignLevel{ 0 };
+  std::optional<level::LevelView> level;
+  SDL_Rect residentChunks{ 0, 0, 0, 0 };
+  std::vector<bool> isChunkResident;
+  std::unordered_map<unsigned, std::uint8_t> hitTileLifes;
+};
+
 /**
  * @brief Logical definition of the world and its entities
+ *
+ * Worlds are independent: each owns its random generator, thus separate
+ * worlds can be updated on separate threads.
  */
-class World
+class World : public ScriptHost
 {
 public:
+  //! Count of values written by getObservation():
+  //! [0] paddle's center x, [1] paddle's width, [2] has ball (0/1),
+  //! [3] ball's x, [4] ball's y, [5] ball's speed x, [6] ball's speed y,
+  //! [7] remaining balls, [8...] lifes of tiles in cells of view (row-major,
+  //! maxTilesX * maxTilesY). Positions are relative to camera's view (0-1),
+  //! speeds to Constants::ballSpeed.
+  static constexpr std::size_t observationSize =
+    8 + Constants::maxTilesX * Constants::maxTilesY;
+
   void update(std::chrono::microseconds delta);
   void render(Application& app);
   void onKeyPressed(bool isKeyDown, SDL_Keysym key);
 
+  //! Queue input from any thread without locking, commands are applied at
+  //! the start of the next update() in order of submission. Returns false if
+  //! queue is full (command is dropped).
+  bool submitCommand(const WorldCommand& command);
+
+  //! Use level layout instead of random tiles (throws if it is invalid)
+  void loadLevel(level::LevelFile level);
+
+  //! Resolve sprites used by rendering (once assets are loaded)
+  void bindSprites(const Application& app);
+
+  //! Time until world changes without input: zero while playing, none if it
+  //! only waits for input (e.g. initial screen)
+  std::optional<std::chrono::microseconds> getTimeUntilChange() const;
+
+  //! Let the game play itself: paddle follows predicted landing of ball,
+  //! lost ball is released and level is started (toggled by A)
+  void setAutopilot(bool isEnabled);
+
+  bool isAutopilotEnabled() const;
+
+  //! Count of events waiting in queue
+  std::size_t getPendingEventCount() const;
+
+  //! Seed generator of random tiles, pickups & ball's direction
+  void setRandomSeed(unsigned seed);
+
+  //! Drive paddle by agent instead of keyboard (until next action)
+  void applyAction(AgentAction action);
+
+  //! Write state seen by agent, see observationSize for layout
+  void getObservation(std::span<float> observation) const;
+
+  //! Draw camera's view into grid (compact image-like observation)
+  void renderOccupancyGrid(OccupancyGrid& grid) const;
+
+  const GameState& getGameState() const;
+  GameStatus getGameStatus() const;
+
+  //! Optional work of update & render (see QualityGovernor), note: ball
+  //! microsteps change simulation, keep the default for replays & rollback
+  void setQuality(const QualitySettings& quality);
+
+  const QualitySettings& getQuality() const;
+
+  //! Reinitialize the game (start the current level from scratch)
+  void restartLevel();
+
+  //! Publish state into shared memory after each update, for external
+  //! tools (throws if segment can not be created)
+  void exportState(const std::string& name = shared_state::defaultName);
+
+  //! State published by exportState()
+  shared_state::Snapshot getStateSnapshot() const;
+
+  //! Encode state for spectators after each update (sinks are added to the
+  //! returned broadcaster)
+  spectator::Broadcaster& broadcastToSpectators();
+
+  //! State encoded for spectators (reuses buffers of frame)
+  void getSpectatorFrame(spectator::Frame& frame) const;
+
+  //! Load chunks of streamed level synchronously, thus the same inputs and
+  //! deltas always give the same states (required by saveState())
+  void setDeterministic(bool isDeterministic);
+
+  //! Copy simulation state (throws if it can not be restored: streamed level
+  //! of non-deterministic world, script waiting for event)
+  void saveState(WorldSnapshot& snapshot) const;
+
+  //! Return to saved state, e.g. to re-simulate with corrected inputs
+  void restoreState(const WorldSnapshot& snapshot);
+
+  //! Hash of observable state (to detect diverged simulations)
+  std::uint64_t getStateChecksum() const;
+
 protected:
+  //! Apply commands submitted so far (by submitCommand)
+  void applyCommands();
+  void applyCommand(const WorldCommand& command);
+
+  //! Single step of update() (events, scripts & dynamics)
+  void updateSimulation(std::chrono::microseconds delta);
+
   void initializeWorld();
   void initializeBall();
   void initializePaddle();
 
-  void renderEntities(Application& app);
+  void renderEntities(Application& app, const ViewTransform& transform);
   void renderHUD(Application& app);
 
   void updatePickups(std::chrono::microseconds delta);
@@ -66,13 +244,47 @@ protected:
   void correctBallAgainstWorldBoundaries(Ball& ball);
   bool detectBallCollisions(Ball& ball, bool reportCollisions);
 
+  //! Queue callback, evaluated by the next update
+  void pushEvent(Event::EventCallback callback);
+
+  //! Random number in [0, count)
+  unsigned getRandom(unsigned count);
+
+  //! Drive paddle's keys, release ball and start level (when autopilot is on)
+  void updateAutopilot();
+
+  //! Horizontal position of ball when it reaches paddle, reflected from walls
+  //! & ceiling (tiles are ignored), none if ball does not move vertically
+  std::optional<float> predictBallLanding(const Ball& ball) const;
+
   //! Returns pair <invertSpeedX, invertSpeedY> to adjust speed after collision
   std::pair<bool, bool> resolveBallSpeedCollisionAfter(Ball& ball,
                                                        SDL_FRect rect);
 
+  //! Spawn a tile at grid position
+  Tile& spawnTile(unsigned x, unsigned y, SDL_Color color);
+
   //! Spawn a random tile at position
   void spawnRandomTile(unsigned x, unsigned y);
 
+  //! Start streaming tiles of level around camera
+  void initializeLevelStreaming();
+
+  //! Keep chunks around camera and ball resident, evict the others
+  void updateLevelStreaming();
+
+  //! Add tiles of loaded chunk into tile map
+  void insertChunk(LevelStreamer::Chunk chunk);
+
+  //! Region of level chunks that should be resident
+  SDL_Rect getRequiredChunks() const;
+
+  //! Rebuild collision spans over tiles of resident chunks
+  void rebuildCollisionSpans();
+
+  //! Spawn a pickup of given type
+  void spawnPickup(SDL_Point position, SDL_Color color, Pickup::Type type);
+
   //! Spawn a random pickup
   void spawnRandomPickup(SDL_Point position, SDL_Color color);
 
@@ -80,8 +292,21 @@ protected:
   void setWorldSpeed(float ratio);
   void setBallSize(float ratio);
 
-  //! Internal Event: reinitialize the game
-  void restartLevel();
+  //! Script: restart the level after a delay
+  Script restartLevelTimeline();
+
+  //! Script: change world speed for a limited time
+  Script worldSpeedTimeline(float ratio);
+
+  //! Script: shrink the ball for a limited time
+  Script ballSizeTimeline();
+
+  //! Script: wait for the rest of timeline with given tag and finish it
+  //! (recreates timelines of restored state)
+  Script resumeTimeline(ScriptTag tag, unsigned remainingTicks);
+
+  //! The last step of timeline with given tag
+  void finishTimeline(ScriptTag tag);
 
   //! Event: When game finishes (all tiles are destroyed)
   void onLevelFinished();
@@ -104,12 +329,24 @@ protected:
   //! Event: pickup was not caught by paddle and fall down the world
   void onPickupFallDown(EntityID pickupId);
 
-  SDL_Rect worldToViewCoordinates(Application&, SDL_FRect units);
-
 private:
-  //! Static tiles
+  //! Static tiles (only resident chunks when level is streamed)
   std::vector<Tile> m_tileMap;
 
+  //! Count of alive tiles in the whole level
+  unsigned m_remainingTiles{ 0 };
+
+  EntityID m_nextTileId{ 0 };
+  EntityID m_nextPickupId{ 0 };
+
+  std::minstd_rand m_random;
+
+  //! Tiles merged into spans, kept in sync with m_tileMap
+  CollisionSpans m_collisionSpans;
+
+  //! Scratch buffer: view rectangles of visible tiles (reused by frames)
+  std::vector<SDL_Rect> m_visibleTileRects;
+
   //! Dynamic objects: pickups
   std::vector<Pickup> m_pickups;
 
@@ -122,8 +359,83 @@ private:
   //! Event queue, sorted w.r.t. deadline time
   std::priority_queue<Event> m_events;
 
+  //! Sequence of the next pushed event
+  std::uint64_t m_nextEventSequence{ 0 };
+
+  //! Simulated time (sum of update deltas), deadlines of events
+  Event::TimePoint m_time;
+
+  //! Running gameplay scripts (timelines)
+  ScriptScheduler m_scripts;
+
+  //! Real time not yet converted to script ticks
+  std::chrono::microseconds m_pendingTickTime{ 0 };
+
   GameStatus m_gameStatus{ GameStatus::initial_screen };
 
+  bool m_isAutopilotEnabled{ false };
+
+  QualitySettings m_quality;
+
+  //! Chunks are loaded synchronously, see setDeterministic()
+  bool m_isDeterministic{ false };
+
+  //! Count of updates
+  std::uint64_t m_tick{ 0 };
+
+  //! Commands of other threads (see submitCommand)
+  std::unique_ptr<MpscQueue<WorldCommand>> m_commands{
+    std::make_unique<MpscQueue<WorldCommand>>(Constants::commandQueueCapacity)
+  };
+
+  //! Shared memory of exportState() (if enabled)
+  std::unique_ptr<shared_state::Writer> m_stateWriter;
+
+  //! Spectator stream of broadcastToSpectators() (if enabled)
+  std::unique_ptr<spectator::Broadcaster> m_broadcaster;
+  spectator::Frame m_spectatorFrame;
+
   //! Defines parameters of the level 
   GameState m_gameState;
+
+  //! Sprites resolved by bindSprites()
+  struct
+  {
+    SpriteHandle tile;
+    SpriteHandle ball;
+    SpriteHandle initialScreen;
+    SpriteHandle gameOver;
+    SpriteHandle youWon;
+  } m_sprites;
+
+  //! Size of the world (in world units), never smaller than camera's view
+  SDL_FPoint m_worldSize{ Constants::worldWidth, Constants::worldHeight };
+
+  //! Visible part of the world
+  Camera m_camera;
+
+  //! Level file given by user (played instead of campaign)
+  std::optional<level::LevelFile> m_levelFile;
+
+  //! Index of the next built-in level, random tiles after the last one
+  std::size_t m_campaignLevel{ 0 };
+
+  //! Layout of current level (random tiles are generated if not set)
+  std::optional<level::LevelView> m_level;
+
+  //! Loads chunks of level, note: must be destroyed before level
+  std::unique_ptr<LevelStreamer> m_streamer;
+
+  //! Region of resident chunks (in chunks)
+  SDL_Rect m_residentChunks{ 0, 0, 0, 0 };
+
+  //! Chunks whose tiles are in tile map (chunk index => is resident)
+  std::vector<bool> m_isChunkResident;
+
+  //! Chunks requested from streamer, but not received yet
+  std::vector<bool> m_isChunkRequested;
+
+  //! Lifes of level tiles that were hit (cell index => lifes), these
+  //! survive eviction of chunk
+  std::unordered_map<unsigned, std::uint8_t> m_hitTileLifes;
 };
\ No newline at end of file
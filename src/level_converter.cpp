@@ -0,0 +1,190 @@
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include <game/level.hpp>
+
+/**
+ * Converts text layout into binary level file
+ *
+ * Text layout:
+ *   # comment
+ *   color <symbol> <RRGGBB> [lifes] [pickup]
+ *   grid
+ *   <row of symbols, '.' is an empty cell>
+ *   ...
+ *
+ * Pickup is one of: speedup, slowdown, change_ball_size, change_paddle_size
+ */
+namespace {
+struct Symbol
+{
+  std::uint8_t color;
+  std::uint8_t lifes;
+  std::uint8_t pickup;
+};
+
+auto
+parsePickup(const std::string& name) -> std::uint8_t
+{
+  // note: encoded as Pickup::Type + 1
+  static const std::unordered_map<std::string, std::uint8_t> pickups = {
+    { "speedup", 1 },
+    { "slowdown", 2 },
+    { "change_ball_size", 3 },
+    { "change_paddle_size", 4 },
+  };
+
+  const auto it = pickups.find(name);
+  if (it == pickups.end()) {
+    throw std::runtime_error("Unknown pickup: " + name);
+  }
+  return it->second;
+}
+
+void
+convert(std::istream& input, const std::string& outputPath)
+{
+  std::unordered_map<char, Symbol> symbols;
+  std::vector<level::PaletteEntry> palette;
+  std::vector<std::string> grid;
+
+  bool isInGrid = false;
+  std::string line;
+  unsigned lineNumber = 0;
+  while (std::getline(input, line)) {
+    lineNumber++;
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+
+    if (line.empty() || line.front() == '#') {
+      continue;
+    }
+
+    if (isInGrid) {
+      grid.push_back(line);
+      continue;
+    }
+
+    std::istringstream tokens(line);
+    std::string keyword;
+    tokens >> keyword;
+
+    if (keyword == "grid") {
+      isInGrid = true;
+    } else if (keyword == "color") {
+      std::string symbol, rgb, pickup;
+      unsigned lifes = 1;
+      tokens >> symbol >> rgb;
+      if (symbol.size() != 1 || symbol == "." || rgb.size() != 6) {
+        throw std::runtime_error(
+          "Malformed color on line " + std::to_string(lineNumber));
+      }
+      if (!(tokens >> lifes)) {
+        lifes = 1;
+      }
+      tokens >> pickup;
+
+      if (palette.size() > 255 || lifes == 0 || lifes > 255) {
+        throw std::runtime_error(
+          "Invalid color on line " + std::to_string(lineNumber));
+      }
+
+      // note: stoul accepts prefix of digits, whole rgb must be parsed
+      unsigned long value = 0;
+      std::size_t parsedSize = 0;
+      try {
+        value = std::stoul(rgb, &parsedSize, 16);
+      } catch (const std::logic_error&) {
+        parsedSize = 0;
+      }
+      if (parsedSize != rgb.size()) {
+        throw std::runtime_error(
+          "Malformed color on line " + std::to_string(lineNumber));
+      }
+
+      palette.push_back(level::PaletteEntry{
+        static_cast<std::uint8_t>(value >> 16),
+        static_cast<std::uint8_t>(value >> 8),
+        static_cast<std::uint8_t>(value),
+        0xFF });
+
+      symbols[symbol.front()] =
+        Symbol{ static_cast<std::uint8_t>(palette.size() - 1),
+                static_cast<std::uint8_t>(lifes),
+                pickup.empty() ? std::uint8_t(0) : parsePickup(pickup) };
+    } else {
+      throw std::runtime_error("Unknown keyword on line " +
+                               std::to_string(lineNumber));
+    }
+  }
+
+  if (grid.empty()) {
+    throw std::runtime_error("Level has no grid");
+  }
+
+  const auto columns = grid.front().size();
+  const auto rows = grid.size();
+
+  std::vector<level::TileRecord> tiles;
+  tiles.reserve(columns * rows);
+  for (const auto& row : grid) {
+    if (row.size() != columns) {
+      throw std::runtime_error("Grid rows must have equal length");
+    }
+
+    for (const auto symbol : row) {
+      if (symbol == '.') {
+        tiles.push_back(level::TileRecord{});
+        continue;
+      }
+
+      const auto it = symbols.find(symbol);
+      if (it == symbols.end()) {
+        throw std::runtime_error(std::string("Undefined symbol: ") + symbol);
+      }
+
+      tiles.push_back(level::TileRecord{
+        it->second.color, it->second.lifes, it->second.pickup, 0 });
+    }
+  }
+
+  level::writeLevelFile(outputPath,
+                        static_cast<unsigned>(columns),
+                        static_cast<unsigned>(rows),
+                        palette,
+                        tiles);
+}
+} // namespace
+
+int
+main(int argc, char* args[])
+{
+  if (argc != 3) {
+    std::cerr << "Usage: level_converter <layout.txt> <level.arkl>"
+              << std::endl;
+    return 1;
+  }
+
+  try {
+    std::ifstream input(args[1]);
+    if (!input) {
+      throw std::runtime_error(std::string("Failed to open: ") + args[1]);
+    }
+
+    convert(input, args[2]);
+
+    // validate the result the same way game does
+    const auto view = level::LevelFile(args[2]).getView();
+    std::cout << "Written " << view.columns << "x" << view.rows
+              << " level: " << args[2] << std::endl;
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
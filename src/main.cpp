@@ -1,40 +1,74 @@
 #include <SDL.h>
 
 #include <SDL_image.h>
+#include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <filesystem>
 #include <format>
 #include <functional>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <string>
 #include <thread>
 
 #include "game/application.hpp"
-#include "game/sdl_helper.hpp"
+#include "game/quality_governor.hpp"
 #include "game/utils.hpp"
 #include "game/world.hpp"
 
 namespace {
+//! Pause overlay pulses in coarse steps (idle loop renders only these)
+constexpr auto pausePulseStep = std::chrono::milliseconds(100);
+
 void
 renderApplicationOverlay(Application& app)
 {
   // if stopped, add overlay
   if (app.isStopped()) {
     // temporal gradient of apha for overlay
-    unsigned alpha = 50 + (SDL_GetTicks() / 30) % 20;
-    SDL_SetRenderDrawBlendMode(app.getRenderer(), SDL_BLENDMODE_BLEND);
-    SDL_SetRenderDrawColor(app.getRenderer(), 255, 255, 255, alpha);
-    SDL_RenderFillRect(app.getRenderer(), NULL);
-    SDL_SetRenderDrawBlendMode(app.getRenderer(), SDL_BLENDMODE_NONE);
+    unsigned alpha = 50 + (SDL_GetTicks() / pausePulseStep.count()) % 20;
+    const auto ws = app.getWindowSize();
+    app.fillRect(SDL_Rect{ 0, 0, ws.x, ws.y },
+                 SDL_Color{ 255, 255, 255, static_cast<Uint8>(alpha) },
+                 SDL_BLENDMODE_BLEND);
 
     const auto blackText = app.getCachedTextureForText(std::format("Paused"));
-    const auto textSize = sdl_helper::getTextureSize(blackText);
+    const auto textSize = app.getTextureSize(blackText);
 
-    const auto ws = app.getWindowSize();
     SDL_Rect rect;
     rect.x = (ws.x - textSize.x) / 2;
     rect.y = (ws.y - textSize.y) / 2;
     rect.w = textSize.x;
     rect.h = textSize.y;
 
-    SDL_RenderCopy(app.getRenderer(), blackText, NULL, &rect);
+    app.copyTexture(blackText, NULL, &rect);
+  }
+}
+
+//! Target is either TCP port (on loopback) or path of file
+void
+addSpectatorSink(World& world, const std::string& target)
+{
+  const auto isDigit = [](char character) {
+    return character >= '0' && character <= '9';
+  };
+  const bool isPort =
+    !target.empty() && std::all_of(target.begin(), target.end(), isDigit);
+  auto& broadcaster = world.broadcastToSpectators();
+  if (isPort) {
+    // note: digits only, more than 5 of them are out of range of ports (and
+    // possibly of stoul)
+    const auto port = target.size() <= 5 ? std::stoul(target) : 0ul;
+    if (port < 1 || port > std::numeric_limits<std::uint16_t>::max()) {
+      throw std::runtime_error(
+        std::format("Port {} is out of range 1-65535", target));
+    }
+    broadcaster.addSink(std::make_unique<spectator::SocketSink>(
+      static_cast<std::uint16_t>(port)));
+  } else {
+    broadcaster.addSink(std::make_unique<spectator::FileSink>(target));
   }
 }
 } // namespace
@@ -47,10 +81,87 @@ main(int argc, char* args[])
   Application app;
   World world;
 
+  // optional flags (in any order), then optional binary level to play
+  // instead of random tiles
+  std::optional<std::string> levelPath;
+  for (int i = 1; i < argc; i++) {
+    const std::string argument = args[i];
+    if (argument == "--software") {
+      // own software rasterizer instead of SDL's renderer
+      app.setRenderBackend(RenderBackendType::software);
+    } else if (argument == "--export-state") {
+      // publish live state for external tools (see state_reader)
+      try {
+        world.exportState();
+      } catch (const std::runtime_error& error) {
+        SDL_Log("State is not exported: %s", error.what());
+      }
+    } else if (argument == "--spectators" && i + 1 < argc) {
+      // stream game to spectators (see spectator)
+      try {
+        addSpectatorSink(world, args[++i]);
+      } catch (const std::runtime_error& error) {
+        SDL_Log("Game is not streamed: %s", error.what());
+      }
+    } else if (argument.starts_with("--") || levelPath) {
+      const auto message = std::format(
+        "Unexpected argument: {}\n"
+        "Usage: {} [--software] [--export-state] "
+        "[--spectators <port|file>] [level]",
+        argument,
+        args[0]);
+      SDL_ShowSimpleMessageBox(
+        SDL_MESSAGEBOX_ERROR, "Fatal Error", message.c_str(), nullptr);
+      return 1;
+    } else {
+      levelPath = argument;
+    }
+  }
+
+  if (levelPath) {
+    try {
+      world.loadLevel(level::LevelFile(*levelPath));
+    } catch (const std::runtime_error& error) {
+      SDL_ShowSimpleMessageBox(
+        SDL_MESSAGEBOX_ERROR, "Fatal Error", error.what(), nullptr);
+      return 1;
+    }
+  }
+
   auto lastFrame = std::chrono::high_resolution_clock::now();
 
-  app.onInitCallback = [&]() { app.loadAssets("assets"); };
+  // note: weak machines trade optional work for steady frame rate
+  QualityGovernor governor;
+  std::uint64_t governedFrames = 0;
+
+  app.onInitCallback = [&]() {
+#ifdef ARKANOID_EMBED_ASSETS
+    app.loadBakedAssets();
+#else
+    app.loadAssets("assets");
+#endif
+
+    // note: artists may edit assets while game is running
+    if (std::filesystem::is_directory("assets")) {
+      app.watchAssets("assets");
+    }
+    world.bindSprites(app);
+  };
   app.onRenderCallback = [&]() {
+    // cost of the previous frame decides quality of this one
+    const auto& profiler = app.getProfiler();
+    if (profiler.getFrameCount() != governedFrames) {
+      governedFrames = profiler.getFrameCount();
+      if (const auto frame = profiler.getLastFrame();
+          frame && governor.onFrame(*frame)) {
+        world.setQuality(governor.getQuality());
+        SDL_Log("Quality level %u: tile overlay %s, %u ball microsteps",
+                governor.getLevel(),
+                governor.getQuality().hasTileOverlay ? "on" : "off",
+                governor.getQuality().ballMicrosteps);
+      }
+    }
+
     const auto now = std::chrono::high_resolution_clock::now();
     const auto delta = now - lastFrame;
 
@@ -66,6 +177,15 @@ main(int argc, char* args[])
     renderApplicationOverlay(app);
   };
 
+  app.getTimeUntilChangeCallback =
+    [&]() -> std::optional<std::chrono::microseconds> {
+    if (app.isStopped()) {
+      return pausePulseStep - std::chrono::milliseconds(SDL_GetTicks() %
+                                                        pausePulseStep.count());
+    }
+    return world.getTimeUntilChange();
+  };
+
   app.onSDLEventCallback = [&](const SDL_Event& event) {
     if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP) {
       world.onKeyPressed(event.type == SDL_KEYDOWN, event.key.keysym);
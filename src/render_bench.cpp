@@ -0,0 +1,373 @@
+#include <SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <format>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "game/application.hpp"
+#include "game/utils.hpp"
+#include "game/world.hpp"
+
+/**
+ * Headless rendering benchmark
+ *
+ * Plays scripted scenario with fixed time step on software renderer (no
+ * window, no GPU) and reports frame times, draw calls and filled pixels.
+ *
+ * Usage: render_bench [--frames N] [--level file.arkl] [--golden directory]
+ *                     [--update-golden] [--software]
+ *                     [--texture-budget KiB] [--record directory]
+ *                     [--trace trace.json]
+ *
+ * With --golden, each 60th frame is compared against BMP images of directory
+ * (or stored there with --update-golden). Exits with 1 if any frame differs.
+ * With --software, own rasterizer is used instead of SDL's software renderer.
+ * With --texture-budget, memory of cached textures is limited (to test eviction).
+ * With --record, frames are recorded as QOI images (to measure its overhead).
+ * With --trace, phase timers are exported as Chrome trace (chrome://tracing).
+ */
+
+namespace {
+//! Simulated time between frames
+constexpr auto frameDelta = std::chrono::microseconds(16'667);
+
+//! Frames of initial screen before the game starts
+constexpr unsigned initialScreenFrames = 30;
+
+//! How long does paddle move in one direction
+constexpr unsigned paddleSweepFrames = 40;
+
+//! Every n-th frame is compared against golden image
+constexpr unsigned goldenFrameInterval = 60;
+
+//! Allowed per-channel difference against golden image (rounding of scaling)
+constexpr int goldenChannelTolerance = 2;
+
+//! Allowed ratio of different pixels against golden image
+constexpr double goldenPixelTolerance = 0.001;
+
+constexpr unsigned randomSeed = 42;
+
+struct Settings
+{
+  unsigned frames{ 600 };
+  std::string levelPath;
+  std::string goldenDirectory;
+  bool updateGolden{ false };
+  RenderBackendType backend{ RenderBackendType::sdl };
+  std::size_t textureBudget{ Constants::textureCacheBudget };
+  std::string recordDirectory;
+  std::string tracePath;
+};
+
+Settings
+parseSettings(int argc, char* args[])
+{
+  Settings settings;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = args[i];
+    const auto nextValue = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value of " + arg);
+      }
+      return args[++i];
+    };
+
+    if (arg == "--frames") {
+      settings.frames = std::stoul(nextValue());
+    } else if (arg == "--level") {
+      settings.levelPath = nextValue();
+    } else if (arg == "--golden") {
+      settings.goldenDirectory = nextValue();
+    } else if (arg == "--update-golden") {
+      settings.updateGolden = true;
+    } else if (arg == "--software") {
+      settings.backend = RenderBackendType::software;
+    } else if (arg == "--texture-budget") {
+      settings.textureBudget = std::stoul(nextValue()) * 1024;
+    } else if (arg == "--record") {
+      settings.recordDirectory = nextValue();
+    } else if (arg == "--trace") {
+      settings.tracePath = nextValue();
+    } else {
+      throw std::runtime_error("Unknown argument: " + arg);
+    }
+  }
+  return settings;
+}
+
+SDL_Keysym
+makeKey(SDL_Keycode code)
+{
+  SDL_Keysym key{};
+  key.sym = code;
+  return key;
+}
+
+//! Scripted input: start the game, keep releasing ball and sweep paddle
+void
+playScenario(World& world, unsigned frame)
+{
+  if (frame == initialScreenFrames) {
+    world.onKeyPressed(true, makeKey(SDLK_RETURN));
+  }
+
+  if (frame < initialScreenFrames) {
+    return;
+  }
+
+  const auto gameFrame = frame - initialScreenFrames;
+  if (gameFrame % paddleSweepFrames == 0) {
+    // note: release ball whenever it's lost (ignored while in game)
+    world.onKeyPressed(true, makeKey(SDLK_SPACE));
+
+    const bool moveLeft = (gameFrame / paddleSweepFrames) % 2;
+    world.onKeyPressed(moveLeft, makeKey(SDLK_LEFT));
+    world.onKeyPressed(!moveLeft, makeKey(SDLK_RIGHT));
+  }
+}
+
+utils::RaiiOwnership<SDL_Surface>
+makeSurface(SDL_Surface* surface)
+{
+  return utils::make_raii_deleter<SDL_Surface>(
+    utils::throw_if_null(surface, "Failed to create surface"),
+    [](SDL_Surface* surface) { SDL_FreeSurface(surface); });
+}
+
+//! Read back content of render target (before it's presented)
+utils::RaiiOwnership<SDL_Surface>
+captureFrame(Application& app)
+{
+  const auto size = app.getWindowSize();
+  auto surface = makeSurface(SDL_CreateRGBSurfaceWithFormat(
+    0, size.x, size.y, 32, SDL_PIXELFORMAT_ARGB8888));
+  if (!app.readPixels(surface.get())) {
+    throw std::runtime_error(
+      std::format("Failed to read pixels: {}", SDL_GetError()));
+  }
+  return surface;
+}
+
+//! Returns count of pixels that differ more than tolerance
+unsigned
+countDifferentPixels(SDL_Surface* actual, SDL_Surface* expected)
+{
+  if (actual->w != expected->w || actual->h != expected->h) {
+    return actual->w * actual->h;
+  }
+
+  unsigned count = 0;
+  for (int y = 0; y < actual->h; y++) {
+    const auto* a = reinterpret_cast<const std::uint8_t*>(actual->pixels) +
+                    y * actual->pitch;
+    const auto* e = reinterpret_cast<const std::uint8_t*>(expected->pixels) +
+                    y * expected->pitch;
+    for (int x = 0; x < actual->w * 4; x += 4) {
+      for (int channel = 0; channel < 4; channel++) {
+        if (std::abs(a[x + channel] - e[x + channel]) >
+            goldenChannelTolerance) {
+          count++;
+          break;
+        }
+      }
+    }
+  }
+  return count;
+}
+
+//! Compare (or store) frame with golden image, returns false if differs
+bool
+checkGoldenFrame(const Settings& settings,
+                 unsigned frame,
+                 SDL_Surface* actual)
+{
+  const auto path =
+    std::filesystem::path(settings.goldenDirectory) /
+    std::format("frame_{:04}.bmp", frame);
+
+  if (settings.updateGolden) {
+    std::filesystem::create_directories(settings.goldenDirectory);
+    SDL_SaveBMP(actual, path.string().c_str());
+    return true;
+  }
+
+  auto loaded = SDL_LoadBMP(path.string().c_str());
+  if (loaded == nullptr) {
+    std::cerr << "Missing golden image: " << path.string() << std::endl;
+    return false;
+  }
+  const auto expected = makeSurface(
+    SDL_ConvertSurfaceFormat(makeSurface(loaded).get(),
+                             SDL_PIXELFORMAT_ARGB8888,
+                             0));
+
+  const auto differentPixels = countDifferentPixels(actual, expected.get());
+  const auto allowedPixels = static_cast<unsigned>(
+    goldenPixelTolerance * actual->w * actual->h);
+  if (differentPixels > allowedPixels) {
+    auto actualPath = path;
+    actualPath.replace_extension(".actual.bmp");
+    SDL_SaveBMP(actual, actualPath.string().c_str());
+
+    std::cerr << std::format("Frame {} differs from golden image in {} pixels "
+                             "(see {})",
+                             frame,
+                             differentPixels,
+                             actualPath.string())
+              << std::endl;
+    return false;
+  }
+  return true;
+}
+
+template<typename T>
+T
+getPercentile(const std::vector<T>& sortedValues, double percentile)
+{
+  const auto index = static_cast<std::size_t>(
+    percentile / 100.0 * (sortedValues.size() - 1) + 0.5);
+  return sortedValues[index];
+}
+} // namespace
+
+int
+main(int argc, char* args[])
+{
+  using clock = std::chrono::high_resolution_clock;
+
+  try {
+    const auto settings = parseSettings(argc, args);
+
+    Application app;
+    World world;
+    world.setRandomSeed(randomSeed);
+    if (!settings.levelPath.empty()) {
+      world.loadLevel(level::LevelFile(settings.levelPath));
+    }
+
+    unsigned frame = 0;
+    bool isGoldenFrame = false;
+    bool matchesGolden = true;
+    clock::duration captureTime{ 0 };
+
+    app.onInitCallback = [&]() {
+#ifdef ARKANOID_EMBED_ASSETS
+      app.loadBakedAssets();
+#else
+      app.loadAssets("assets");
+#endif
+      world.bindSprites(app);
+    };
+    app.onRenderCallback = [&]() {
+      world.render(app);
+
+      if (isGoldenFrame) {
+        const auto captureBeginning = clock::now();
+        matchesGolden &=
+          checkGoldenFrame(settings, frame, captureFrame(app).get());
+        captureTime = clock::now() - captureBeginning;
+      }
+    };
+    app.setRenderBackend(settings.backend);
+    app.setTextureBudget(settings.textureBudget);
+    app.createHeadlessApplication();
+    if (!settings.recordDirectory.empty()) {
+      app.startRecording(settings.recordDirectory);
+    }
+
+    std::vector<std::chrono::microseconds> frameTimes;
+    std::vector<unsigned> drawCalls;
+    std::uint64_t filledPixels = 0;
+
+    for (frame = 0; frame < settings.frames; frame++) {
+      playScenario(world, frame);
+      world.update(frameDelta);
+
+      isGoldenFrame = !settings.goldenDirectory.empty() &&
+                      frame % goldenFrameInterval == 0;
+      captureTime = clock::duration{ 0 };
+      app.resetRenderStats();
+
+      const auto frameBeginning = clock::now();
+      app.renderFrame();
+      const auto frameTime = clock::now() - frameBeginning - captureTime;
+
+      frameTimes.push_back(
+        std::chrono::duration_cast<std::chrono::microseconds>(frameTime));
+      drawCalls.push_back(app.getRenderStats().drawCalls);
+      filledPixels += app.getRenderStats().filledPixels;
+    }
+
+    app.stopRecording();
+
+    if (frameTimes.empty()) {
+      return 0;
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    std::sort(drawCalls.begin(), drawCalls.end());
+    std::uint64_t totalDrawCalls = 0;
+    for (const auto calls : drawCalls) {
+      totalDrawCalls += calls;
+    }
+
+    std::cout << std::format("frames: {}\n", frameTimes.size());
+    std::cout << std::format(
+      "frame time [us]: p50 {} p90 {} p99 {} max {}\n",
+      getPercentile(frameTimes, 50.0).count(),
+      getPercentile(frameTimes, 90.0).count(),
+      getPercentile(frameTimes, 99.0).count(),
+      frameTimes.back().count());
+    std::cout << std::format("draw calls per frame: avg {} p50 {} max {}\n",
+                             totalDrawCalls / frameTimes.size(),
+                             getPercentile(drawCalls, 50.0),
+                             drawCalls.back());
+    std::cout << std::format("pixels filled per frame: avg {}\n",
+                             filledPixels / frameTimes.size());
+
+    // average of phases over frames kept by profiler
+    const auto profiledFrames = app.getProfiler().getFrames();
+    std::cout << "phases per frame [us]:";
+    for (std::size_t phase = 0;
+         phase < static_cast<std::size_t>(ProfilePhase::count);
+         phase++) {
+      std::uint64_t total = 0;
+      for (const auto& profiled : profiledFrames) {
+        total += profiled.phaseNs[phase];
+      }
+      std::cout << std::format(
+        " {} {}",
+        getPhaseName(static_cast<ProfilePhase>(phase)),
+        total / 1000 / std::max<std::size_t>(1, profiledFrames.size()));
+    }
+    std::cout << "\n";
+    if (!settings.tracePath.empty()) {
+      app.getProfiler().exportChromeTrace(settings.tracePath);
+    }
+
+    const auto& textures = app.getTextureCacheStats();
+    std::cout << std::format(
+      "cached textures [KiB]: used {} peak {} budget {} evictions {}\n",
+      textures.usedBytes / 1024,
+      textures.peakBytes / 1024,
+      textures.budgetBytes / 1024,
+      textures.evictions);
+
+    if (!settings.goldenDirectory.empty()) {
+      std::cout << std::format("golden images: {}\n",
+                               settings.updateGolden ? "updated"
+                               : matchesGolden       ? "match"
+                                                     : "differ");
+    }
+    return matchesGolden ? 0 : 1;
+  } catch (const std::exception& error) {
+    std::cerr << error.what() << std::endl;
+    return 1;
+  }
+}
@@ -1,7 +1,33 @@
 #include <SDL.h>
+#include <algorithm>
+#include <array>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
 
+#include <game/level.hpp>
+#include <game/mpsc_queue.hpp>
+#include <game/occupancy_grid.hpp>
+#include <game/profiler.hpp>
+#include <game/qoi.hpp>
+#include <game/quality_governor.hpp>
+#include <game/raster.hpp>
+#include <game/resample.hpp>
+#include <game/rollback.hpp>
+#include <game/shared_state.hpp>
+#include <game/spectator_stream.hpp>
+#include <game/scaled_sprite_cache.hpp>
+#include <game/texture_cache.hpp>
+#include <game/vector_env.hpp>
 #include <game/world.hpp>
 
 void
@@ -49,10 +75,975 @@ testCollisionStateDetection()
   }
 }
 
+void
+testCollisionSpans()
+{
+  const auto makeTile = [](EntityID id, int column, int row) {
+    Tile tile;
+    tile.id = id;
+    tile.cell = { column, row };
+    tile.body = { column * 10.0f, row * 10.0f, 10.0f, 10.0f };
+    return tile;
+  };
+
+  // row 0: [0][1] . [3], row 1: [4]
+  const std::vector<Tile> tiles = { makeTile(0, 0, 0),
+                                    makeTile(1, 1, 0),
+                                    makeTile(3, 3, 0),
+                                    makeTile(4, 0, 1) };
+
+  CollisionSpans spans;
+  spans.rebuild(tiles, { 0, 0, 4, 2 }, { 10.0f, 10.0f });
+  // rows: [0 1], [3], [4], columns: [0 4], [1], [3]
+  assert(spans.getSpanCount() == 6);
+
+  const auto getContacts = [&](SDL_FRect ball) {
+    std::vector<std::pair<CollisionSpans::Span, EntityID>> contacts;
+    spans.forEachContact(ball, [&](const CollisionSpans::Span& span) {
+      contacts.emplace_back(span, spans.getTileHitBySpan(span, ball));
+    });
+    return contacts;
+  };
+
+  // ball over the seam of tiles 0 and 1 hits a single span
+  {
+    const auto contacts = getContacts({ 7, 2, 4, 4 });
+    assert(contacts.size() == 1);
+    assert(!contacts[0].first.isColumn);
+    assert(contacts[0].second == 0);
+  }
+
+  // ball at the side of column of tiles 0 and 4, over their seam, hits the
+  // column span once (flat wall, not two corners)
+  {
+    const auto contacts = getContacts({ -3, 8, 4, 4 });
+    assert(contacts.size() == 1);
+    assert(contacts[0].first.isColumn);
+    assert(contacts[0].second == 4);
+  }
+
+  // ball at the outer corner of a run still hits the row span
+  {
+    const auto contacts = getContacts({ 38, -3, 4, 4 });
+    assert(contacts.size() == 1);
+    assert(!contacts[0].first.isColumn);
+    assert(contacts[0].second == 3);
+  }
+
+  // removing tile re-merges its row & column only
+  spans.removeTile(tiles[0]);
+  assert(spans.getSpanCount() == 6);
+  spans.removeTile(tiles[1]);
+  assert(spans.getSpanCount() == 4);
+}
+
+void
+testScriptScheduler()
+{
+  std::vector<int> log;
+  const auto timeline = [&](int id) -> Script {
+    log.push_back(id);
+    co_await script::ticks(2);
+    log.push_back(id + 1);
+    co_await script::event(ScriptEvent::ball_lost);
+    log.push_back(id + 2);
+  };
+
+  ScriptScheduler scheduler;
+  scheduler.start(timeline(0));
+  scheduler.start(timeline(10), ScriptTag::world_speed);
+  assert((log == std::vector<int>{ 0, 10 }));
+
+  assert(scheduler.getTicksUntilWakeUp() == 2u);
+  scheduler.tick(1);
+  assert(log.size() == 2);
+  assert(scheduler.getTicksUntilWakeUp() == 1u);
+  scheduler.tick(1);
+  assert((log == std::vector<int>{ 0, 10, 1, 11 }));
+
+  // scripts waiting for events are woken up by input only
+  assert(!scheduler.getTicksUntilWakeUp().has_value());
+
+  // cancelled script is never resumed again
+  scheduler.cancel(ScriptTag::world_speed);
+  scheduler.raise(ScriptEvent::ball_lost);
+  assert((log == std::vector<int>{ 0, 10, 1, 11, 2 }));
+  assert(scheduler.getActiveCount() == 0);
+
+  // frames of host's scripts come from its own pool, thus they can be
+  // resumed & freed on another thread than the one which started them
+  struct Host : ScriptHost
+  {
+    ScriptScheduler scheduler;
+    int resumed = 0;
+
+    Script count()
+    {
+      co_await script::ticks(1);
+      resumed++;
+    }
+  };
+  auto host = std::make_unique<Host>();
+  host->scheduler.start(host->count());
+  host->scheduler.start(host->count());
+  std::thread([&host]() {
+    host->scheduler.tick(1);
+    assert(host->resumed == 2 && host->scheduler.getActiveCount() == 0);
+    host->scheduler.start(host->count());
+    host.reset();
+  }).join();
+}
+
+void
+testAtlasPacking()
+{
+  const std::vector<SDL_Point> sizes = {
+    { 640, 480 }, { 860, 765 }, { 348, 236 }, { 200, 50 }, { 600, 400 }
+  };
+  const auto layout = atlas::pack(sizes, { 4096, 4096 });
+
+  assert(layout.rects.size() == sizes.size());
+  for (std::size_t i = 0; i < sizes.size(); i++) {
+    const auto& rect = layout.rects[i];
+    assert(rect.w == sizes[i].x && rect.h == sizes[i].y);
+    assert(rect.x + rect.w <= layout.size.x);
+    assert(rect.y + rect.h <= layout.size.y);
+
+    for (std::size_t j = 0; j < i; j++) {
+      assert(!SDL_HasIntersection(&rect, &layout.rects[j]));
+    }
+  }
+
+  // images placed one by one do not overlap until atlas is full
+  atlas::ShelfAllocator allocator({ 64, 32 });
+  std::vector<SDL_Rect> placed;
+  while (const auto rect = allocator.allocate({ 20, 10 })) {
+    for (const auto& other : placed) {
+      assert(!SDL_HasIntersection(&*rect, &other));
+    }
+    assert(rect->x + rect->w <= 64 && rect->y + rect->h <= 32);
+    placed.push_back(*rect);
+  }
+  assert(placed.size() == 6);
+  assert(!allocator.allocate({ 64, 1 }));
+  allocator.clear();
+  assert(allocator.allocate({ 20, 10 })->x == 0);
+}
+
+void
+testRasterKernels()
+{
+  // compare vectorized kernels with exactly rounded blending (incl. tails)
+  const auto blend = [](std::uint32_t destination, std::uint32_t source) {
+    const auto alpha = source >> 24;
+    std::uint32_t result = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+      const auto s = shift == 24 ? 255 : (source >> shift) & 0xFF;
+      const auto d = (destination >> shift) & 0xFF;
+      result |= ((s * alpha + d * (255 - alpha)) * 2 + 255) / 510 << shift;
+    }
+    return result;
+  };
+
+  std::uint32_t seed = 1;
+  const auto random = [&seed]() { return seed = seed * 1664525 + 1013904223; };
+
+  for (int count : { 0, 1, 5, 8, 13, 64, 259 }) {
+    std::vector<std::uint32_t> destination(count), source(count);
+    for (int i = 0; i < count; i++) {
+      destination[i] = random();
+      source[i] = random();
+      // mix in fully opaque & transparent runs
+      if (i % 16 < 8) {
+        source[i] = (i % 32 < 16) ? source[i] | 0xFF000000
+                                  : source[i] & 0x00FFFFFF;
+      }
+    }
+
+    auto result = destination;
+    raster::blendSpan(result.data(), source.data(), count);
+    for (int i = 0; i < count; i++) {
+      assert(result[i] == blend(destination[i], source[i]));
+    }
+
+    const std::uint32_t color = 0x80336699;
+    result = destination;
+    raster::blendColorSpan(result.data(), color, count);
+    for (int i = 0; i < count; i++) {
+      assert(result[i] == blend(destination[i], color));
+    }
+
+    raster::fillSpan(result.data(), color, count);
+    for (int i = 0; i < count; i++) {
+      assert(result[i] == color);
+    }
+
+    std::vector<std::uint8_t> cells(count);
+    for (auto& cell : cells) {
+      cell = static_cast<std::uint8_t>(random() >> 24);
+    }
+    auto raised = cells;
+    raster::maxSpan(raised.data(), 128, count);
+    for (int i = 0; i < count; i++) {
+      assert(raised[i] == std::max<std::uint8_t>(cells[i], 128));
+    }
+  }
+}
+
+void
+testTextureCache()
+{
+  // textures are never dereferenced by cache, fake them by addresses
+  int destroyed = 0;
+  std::uintptr_t nextAddress = 0x100;
+  const auto makeTexture = [&]() {
+    return utils::make_raii_deleter<Texture>(
+      reinterpret_cast<Texture*>(nextAddress++),
+      [&destroyed](Texture*) { destroyed++; });
+  };
+
+  TextureCache cache(300);
+  cache.insert("a", makeTexture(), 100);
+  cache.insert("b", makeTexture(), 100);
+  cache.insert("c", makeTexture(), 100);
+
+  // over budget, but all were used in this frame
+  cache.insert("d", makeTexture(), 100);
+  assert(cache.getStats().usedBytes == 400);
+  assert(destroyed == 0);
+
+  // once frame ends, the least recently used are evicted
+  cache.beginFrame();
+  assert(cache.getStats().usedBytes == 300 && destroyed == 1);
+  assert(cache.find("a") == nullptr);
+  assert(cache.find("b") != nullptr);
+  cache.insert("e", makeTexture(), 100);
+  assert(cache.find("c") == nullptr);
+  assert(cache.find("b") != nullptr && cache.find("d") != nullptr);
+  assert(cache.getStats().usedBytes == 300);
+  assert(destroyed == 2 && cache.getStats().evictions == 2);
+  assert(cache.getStats().peakBytes == 400);
+
+  // replacing texture of key does not change accounting of others
+  cache.insert("e", makeTexture(), 50);
+  assert(cache.getStats().usedBytes == 250 && destroyed == 3);
+
+  cache.beginFrame();
+  cache.beginFrame();
+  assert(cache.find("b") != nullptr);
+  cache.evictUnused(1);
+  assert(cache.getStats().textureCount == 1 && destroyed == 5);
+
+  cache.setBudget(0);
+  assert(cache.getStats().textureCount == 1);
+  cache.beginFrame();
+  assert(cache.getStats().usedBytes == 0 && destroyed == 6);
+}
+
+void
+testScaledSpriteCache()
+{
+  // atlas holds four 10x10 sprites (with padding)
+  ScaledSpriteCache cache({ 22, 22 });
+  const auto sprite = [](std::uint32_t index) { return SpriteHandle{ index }; };
+  assert(cache.insert(sprite(0), { 10, 10 }));
+  assert(cache.insert(sprite(1), { 10, 10 }));
+  assert(cache.find(sprite(0), { 10, 10 }) != nullptr);
+  assert(cache.find(sprite(0), { 10, 9 }) == nullptr);
+  assert(!cache.insert(sprite(2), { 30, 5 }));
+
+  // least recently used sprite (of earlier frame) gives up its place
+  cache.beginFrame();
+  assert(cache.insert(sprite(2), { 10, 10 }));
+  assert(cache.insert(sprite(3), { 10, 10 }));
+  cache.beginFrame();
+  cache.find(sprite(1), { 10, 10 });
+  const auto reused = cache.insert(sprite(4), { 8, 8 });
+  assert(reused && reused->x == 0 && reused->y == 0);
+  assert(cache.find(sprite(0), { 10, 10 }) == nullptr);
+  assert(cache.find(sprite(1), { 10, 10 }) != nullptr);
+
+  // sprites of this frame are kept, atlas is freed when frame ends
+  for (std::uint32_t index : { 2, 3 }) {
+    cache.find(sprite(index), { 10, 10 });
+  }
+  assert(!cache.insert(sprite(5), { 10, 10 }));
+  assert(cache.getCount() == 4);
+  cache.beginFrame();
+  assert(cache.getCount() == 0);
+  assert(cache.insert(sprite(5), { 10, 10 }));
+
+  // sprites unused for long are evicted
+  cache.beginFrame();
+  cache.beginFrame();
+  cache.evictUnused(1);
+  assert(cache.getCount() == 0);
+}
+
+void
+testQoiEncoder()
+{
+  // red (difference to initial black), run of red, black (difference)
+  const std::uint32_t pixels[] = { 0xFFFF0000, 0xFFFF0000, 0xFF000000 };
+  std::vector<std::uint8_t> encoded;
+  qoi::encode(pixels, 3, 1, sizeof(pixels), encoded);
+
+  const std::vector<std::uint8_t> expected = {
+    'q', 'o', 'i', 'f', 0, 0, 0, 3, 0, 0, 0, 1, 3, 0, // header
+    0x5A, 0xC0, 0x7A,                                 // pixels
+    0, 0, 0, 0, 0, 0, 0, 1                            // end marker
+  };
+  assert(encoded == expected);
+}
+
+void
+testResample()
+{
+  // opaque red & transparent black: average keeps color, halves alpha
+  std::uint32_t pixels[] = { 0xFFFF0000, 0x00000000, 0xFF00FF00, 0xFF00FF00 };
+  auto* image = SDL_CreateRGBSurfaceWithFormatFrom(
+    pixels, 2, 2, 32, 2 * sizeof(std::uint32_t), SDL_PIXELFORMAT_ARGB8888);
+  assert(image != nullptr);
+
+  const auto halved = resample::scaleAreaAverage(image, SDL_Point{ 1, 2 });
+  assert(halved->w == 1 && halved->h == 2);
+  const auto* scaled = static_cast<const std::uint32_t*>(halved->pixels);
+  assert(scaled[0] == 0x80FF0000);
+  const auto* secondRow = reinterpret_cast<const std::uint32_t*>(
+    static_cast<const std::uint8_t*>(halved->pixels) + halved->pitch);
+  assert(secondRow[0] == 0xFF00FF00);
+
+  // upscaling by whole multiple replicates pixels
+  const auto doubled = resample::scaleAreaAverage(image, SDL_Point{ 4, 4 });
+  const auto* firstRow = static_cast<const std::uint32_t*>(doubled->pixels);
+  assert(firstRow[0] == 0xFFFF0000 && firstRow[1] == 0xFFFF0000);
+  assert(firstRow[2] == 0 && firstRow[3] == 0);
+
+  SDL_FreeSurface(image);
+}
+
+void
+testProfiler()
+{
+  Profiler profiler;
+
+  // without installed profiler, scopes are not recorded
+  {
+    ProfileScope scope(ProfilePhase::events);
+  }
+  assert(profiler.getFrameCount() == 0);
+
+  Profiler::setCurrent(&profiler);
+  const auto begin = Profiler::Clock::now();
+  for (int frame = 0; frame < 3; frame++) {
+    profiler.beginFrame();
+    profiler.record(ProfilePhase::dynamics,
+                    begin,
+                    begin + std::chrono::microseconds(100 * (frame + 1)));
+    profiler.recordEventQueueDepth(2);
+    profiler.recordEventQueueDepth(1);
+    profiler.recordTimerLateness(std::chrono::microseconds(-5));
+    {
+      ProfileScope scope(ProfilePhase::renderHUD);
+    }
+  }
+  profiler.beginFrame();
+  Profiler::setCurrent(nullptr);
+
+  const auto frames = profiler.getFrames();
+  assert(profiler.getFrameCount() == 3 && frames.size() == 3);
+  const auto dynamics = static_cast<std::size_t>(ProfilePhase::dynamics);
+  assert(frames[0].phaseNs[dynamics] == 100'000);
+  assert(frames[2].phaseNs[dynamics] == 300'000);
+  assert(frames[1].eventQueueDepth == 2 && frames[1].maxLatenessUs == 0);
+  assert(profiler.getBusyPercentile(0) <= profiler.getBusyPercentile(100));
+
+  // ring buffer keeps only the latest frames
+  for (std::size_t frame = 1; frame < Profiler::frameCapacity; frame++) {
+    profiler.beginFrame();
+  }
+  assert(profiler.getFrames().size() == Profiler::frameCapacity);
+  assert(profiler.getFrames().front().phaseNs[dynamics] == 300'000);
+
+  // long scopes (e.g. idle wait) do not wrap around
+  const auto sleep = static_cast<std::size_t>(ProfilePhase::sleep);
+  profiler.beginFrame();
+  profiler.record(ProfilePhase::sleep, begin, begin + std::chrono::seconds(5));
+  profiler.beginFrame();
+  assert(profiler.getLastFrame()->phaseNs[sleep] == 5'000'000'000ull);
+}
+
+void
+testAutopilot()
+{
+  struct AutopilotWorld : public World
+  {
+    using World::initializeWorld;
+    using World::predictBallLanding;
+  };
+
+  AutopilotWorld world;
+  world.initializeWorld();
+
+  // paddle & world as placed by initializePaddle()
+  const float landingY = Constants::worldHeight -
+                         Constants::paddleHeight * 1.7f - Constants::ballRadius;
+  const auto predict = [&](SDL_FPoint position, SDL_FPoint speed) {
+    Ball ball;
+    ball.radius = Constants::ballRadius;
+    ball.position = position;
+    ball.speed = speed;
+    return world.predictBallLanding(ball);
+  };
+  const auto isNear = [](std::optional<float> x, float expected) {
+    return x.has_value() && std::abs(*x - expected) < 0.01f;
+  };
+
+  // falling straight down
+  assert(isNear(predict({ 500, landingY - 400 }, { 0, 100 }), 500));
+  assert(!predict({ 500, landingY - 400 }, { 100, 0 }).has_value());
+
+  // reflected from right wall: 485 units to wall, 715 back
+  assert(isNear(predict({ 500, landingY - 400 }, { 300, 100 }), 270));
+
+  // moving upward: reflected from ceiling, then from left wall
+  const float distance = (landingY - 300 - Constants::ballRadius) +
+                         (landingY - Constants::ballRadius);
+  assert(isNear(predict({ 500, landingY - 300 }, { -100, -100 }),
+                Constants::ballRadius + (distance - 485)));
+}
+
+void
+testVectorEnv()
+{
+  constexpr std::size_t envCount = 5;
+  constexpr auto observationSize = World::observationSize;
+
+  // the same seeds give the same episodes, regardless of threads
+  VectorEnv single(envCount, 1, 7, 4);
+  VectorEnv parallel(envCount, 3, 7, 4);
+
+  std::vector<float> observations[2];
+  std::vector<float> rewards[2];
+  std::vector<std::uint8_t> dones[2];
+  for (auto i = 0; i < 2; i++) {
+    observations[i].resize(envCount * observationSize);
+    rewards[i].resize(envCount);
+    dones[i].resize(envCount);
+  }
+  single.reset(observations[0].data());
+  parallel.reset(observations[1].data());
+  assert(observations[0] == observations[1]);
+
+  // world is playing: paddle & ball are inside view
+  assert(observations[0][0] > 0 && observations[0][0] < 1);
+  assert(observations[0][2] == 1.0f);
+
+  unsigned finishedEpisodes = 0;
+  std::vector<AgentAction> actions(envCount);
+  for (unsigned step = 0; step < 2000; step++) {
+    for (std::size_t i = 0; i < envCount; i++) {
+      actions[i] = static_cast<AgentAction>((step / 10 + i) % 4);
+    }
+    single.step(actions.data(),
+                observations[0].data(),
+                rewards[0].data(),
+                dones[0].data());
+    parallel.step(actions.data(),
+                  observations[1].data(),
+                  rewards[1].data(),
+                  dones[1].data());
+    assert(observations[0] == observations[1]);
+    assert(rewards[0] == rewards[1] && dones[0] == dones[1]);
+
+    for (const auto done : dones[0]) {
+      finishedEpisodes += done;
+    }
+  }
+
+  // random play loses all balls, finished worlds are restarted
+  assert(finishedEpisodes > 0);
+}
+
+void
+testOccupancyGrid()
+{
+  constexpr int width = 8;
+  constexpr int height = 4;
+  std::vector<std::uint8_t> cells(OccupancyGrid::getSize(width, height));
+  OccupancyGrid grid(cells, width, height);
+  grid.setView({ 0, 0, 80, 40 });
+
+  // partially covered cells at edges get proportional value
+  grid.addRect(GridChannel::tiles, { 15, 10, 30, 10 }, 200);
+  const auto tiles = grid.getChannel(GridChannel::tiles);
+  assert(tiles[width + 1] == 100);
+  assert(tiles[width + 2] == 200 && tiles[width + 3] == 200);
+  assert(tiles[width + 4] == 100);
+  assert(tiles[width + 5] == 0 && tiles[1] == 0);
+
+  // overlapping rectangles keep the higher value, channels are separated
+  grid.addRect(GridChannel::tiles, { 0, 0, 80, 40 }, 150);
+  assert(tiles[0] == 150 && tiles[width + 2] == 200);
+  assert(grid.getChannel(GridChannel::paddle)[0] == 0);
+
+  grid.setRect(GridChannel::ballSpeedX, { 25, 25, 1, 1 }, 7);
+  assert(grid.getChannel(GridChannel::ballSpeedX)[2 * width + 2] == 7);
+  assert(OccupancyGrid::toSigned(0.0f) == 128);
+  assert(OccupancyGrid::toSigned(-2.0f) == 1);
+  assert(OccupancyGrid::toSigned(1.0f) == 255);
+
+  // world fills tiles, paddle (thinner than cell) & ball of its view
+  World world;
+  world.setRandomSeed(3);
+  world.restartLevel();
+  std::vector<std::uint8_t> worldCells(OccupancyGrid::getSize(84, 84));
+  OccupancyGrid worldGrid(worldCells, 84, 84);
+  world.renderOccupancyGrid(worldGrid);
+  for (const auto channel :
+       { GridChannel::tiles, GridChannel::paddle, GridChannel::ball }) {
+    const auto plane = worldGrid.getChannel(channel);
+    assert(*std::max_element(plane.begin(), plane.end()) > 0);
+  }
+}
+
+void
+testSharedState()
+{
+  const std::string name = "/arkanoid_sandbox_state";
+  shared_state::Writer writer(name);
+  const shared_state::Reader reader(name);
+  assert(!reader.read());
+
+  // another game can not take over (and remove) the segment
+  bool isRejected = false;
+  try {
+    shared_state::Writer other(name);
+  } catch (const std::runtime_error&) {
+    isRejected = true;
+  }
+  assert(isRejected);
+  assert(!shared_state::Reader(name).read());
+
+  // snapshots read while writer publishes are never torn
+  constexpr std::uint64_t publishCount = 20'000;
+  std::thread publisher([&]() {
+    for (std::uint64_t tick = 1; tick <= publishCount; tick++) {
+      shared_state::Snapshot snapshot{};
+      snapshot.tick = tick;
+      snapshot.score = static_cast<std::int32_t>(tick);
+      snapshot.paddleX = static_cast<float>(tick);
+      snapshot.tiles.fill(static_cast<std::uint8_t>(tick));
+      writer.publish(snapshot);
+    }
+  });
+
+  std::uint64_t lastTick = 0;
+  while (lastTick < publishCount) {
+    const auto snapshot = reader.read();
+    if (!snapshot) {
+      continue;
+    }
+    assert(snapshot->tick >= lastTick);
+    assert(snapshot->score == static_cast<std::int32_t>(snapshot->tick));
+    assert(snapshot->paddleX == static_cast<float>(snapshot->tick));
+    assert(snapshot->tiles.back() ==
+           static_cast<std::uint8_t>(snapshot->tick));
+    lastTick = snapshot->tick;
+  }
+  publisher.join();
+
+  // world publishes after each update
+  World world;
+  world.exportState(name + "_world");
+  world.restartLevel();
+  world.update(std::chrono::milliseconds(16));
+  const shared_state::Reader worldReader(name + "_world");
+  const auto snapshot = worldReader.read();
+  assert(snapshot && snapshot->tick == 1);
+  assert(snapshot->status == GameStatus::running && snapshot->hasBall == 1);
+}
+
+void
+testRollback()
+{
+  // restored world re-simulates the same frames exactly
+  const auto step = std::chrono::microseconds(16'667);
+  const auto actionAt = [](unsigned frame) {
+    return static_cast<AgentAction>((frame * 7 + frame / 13) % 4);
+  };
+  World world;
+  world.setRandomSeed(7);
+  world.setDeterministic(true);
+  world.restartLevel();
+  for (unsigned frame = 0; frame < 60; frame++) {
+    world.applyAction(actionAt(frame));
+    world.update(step);
+  }
+  WorldSnapshot saved;
+  world.saveState(saved);
+  std::vector<std::uint64_t> checksums;
+  for (unsigned frame = 60; frame < 600; frame++) {
+    world.applyAction(actionAt(frame));
+    world.update(step);
+    checksums.push_back(world.getStateChecksum());
+  }
+  world.restoreState(saved);
+  for (unsigned frame = 60; frame < 600; frame++) {
+    world.applyAction(actionAt(frame));
+    world.update(step);
+    assert(world.getStateChecksum() == checksums[frame - 60]);
+  }
+
+  // state not shown in snapshot (random generator) still tells worlds apart
+  World reseeded;
+  reseeded.setRandomSeed(8);
+  reseeded.setDeterministic(true);
+  reseeded.restartLevel();
+  reseeded.restoreState(saved);
+  world.restoreState(saved);
+  assert(reseeded.getStateChecksum() == world.getStateChecksum());
+  reseeded.setRandomSeed(9);
+  assert(reseeded.getStateChecksum() != world.getStateChecksum());
+
+  // peers over bad link mispredict, roll back and still agree
+  LossyLink link({ .latencyTicks = 3, .jitterTicks = 3, .lossRate = 0.1f });
+  RollbackSession first(link.getEndpoint(0), { .localPlayer = 0 });
+  RollbackSession second(link.getEndpoint(1), { .localPlayer = 1 });
+  for (unsigned tick = 0; tick < 600; tick++) {
+    first.advanceFrame(actionAt(first.getFrame()));
+    second.advanceFrame(actionAt(second.getFrame() / 5));
+    link.tick();
+  }
+  for (auto* session : { &first, &second }) {
+    assert(!session->isDesynced());
+    assert(session->getFrame() > 300);
+    assert(session->getStats().rollbacks > 0);
+    assert(session->getStats().verifiedChecksums > 0);
+    assert(session->getStats().maxRollbackDepth <= 8);
+  }
+  assert(link.getLostCount() > 0);
+}
+
+void
+testSpectatorStream()
+{
+  //! Keeps all messages in memory
+  class MemorySink : public spectator::Sink
+  {
+  public:
+    void write(const spectator::Message& message) override
+    {
+      messages.push_back(message);
+    }
+
+    std::vector<spectator::Message> messages;
+  };
+
+  World world;
+  world.setRandomSeed(3);
+  world.setAutopilot(true);
+  world.restartLevel();
+  auto& broadcaster = world.broadcastToSpectators();
+  auto sink = std::make_unique<MemorySink>();
+  const auto& messages = sink->messages;
+  broadcaster.addSink(std::move(sink));
+
+  // decoder fed in uneven chunks rebuilds the frame of each tick
+  spectator::Decoder decoder;
+  spectator::Frame expected;
+  std::size_t deltaBytes = 0;
+  std::size_t keyframeBytes = 0;
+  for (unsigned tick = 0; tick < 600; tick++) {
+    world.update(std::chrono::microseconds(16'667));
+    world.getSpectatorFrame(expected);
+
+    const auto& bytes = *messages.back().bytes;
+    const auto half = std::span(bytes).first(bytes.size() / 2);
+    assert(decoder.feed(half) == 0);
+    assert(decoder.feed(std::span(bytes).subspan(half.size())) == 1);
+    const auto& frame = decoder.getFrame();
+    assert(frame.tick == expected.tick && frame.fields == expected.fields);
+    assert(frame.cells == expected.cells && frame.pickups == expected.pickups);
+
+    (messages.back().isKeyframe ? keyframeBytes : deltaBytes) += bytes.size();
+  }
+  assert(messages.size() == 600 && messages.front().isKeyframe);
+  assert(keyframeBytes / (600 / spectator::defaultKeyframeInterval) >
+         4 * deltaBytes / (600 - 600 / spectator::defaultKeyframeInterval));
+
+  // spectator joining in the middle waits for keyframe
+  spectator::Decoder lateDecoder;
+  for (std::size_t i = 10; i < messages.size(); i++) {
+    lateDecoder.feed(*messages[i].bytes);
+    assert(lateDecoder.isSynced() ==
+           (i >= spectator::defaultKeyframeInterval));
+  }
+  assert(lateDecoder.getFrame().cells == decoder.getFrame().cells);
+
+  // keyframe of world whose cell count overflows 64 bits is refused
+  {
+    std::vector<std::uint8_t> malformed = { 'A', 'R', 'K', 'V',
+                                            spectator::version,
+                                            1, // keyframe
+                                            0, // tick
+                                            0x80, 0x80, 0x80, 0x80, 0x10,
+                                            0x80, 0x80, 0x80, 0x80, 0x10 };
+    const auto size = static_cast<std::uint32_t>(malformed.size());
+    malformed.insert(malformed.begin(),
+                     { static_cast<std::uint8_t>(size), 0, 0, 0 });
+    std::string error;
+    try {
+      spectator::Decoder().feed(std::as_bytes(std::span(malformed)));
+    } catch (const std::runtime_error& exception) {
+      error = exception.what();
+    }
+    assert(error.find("Too large world") != std::string::npos);
+  }
+
+  // spectators on loopback socket share the same stream (note: any free
+  // port, runs of tests must not collide)
+  spectator::SocketSink socketSink(0);
+  StreamClient first("127.0.0.1", socketSink.getPort());
+  StreamClient second("127.0.0.1", socketSink.getPort());
+  spectator::Decoder firstDecoder;
+  spectator::Decoder secondDecoder;
+  for (const auto& message : messages) {
+    socketSink.write(message);
+    firstDecoder.feed(first.receive().value());
+    secondDecoder.feed(second.receive().value());
+  }
+  assert(socketSink.getSpectatorCount() == 2);
+  for (unsigned attempt = 0; attempt < 100; attempt++) {
+    firstDecoder.feed(first.receive().value());
+    secondDecoder.feed(second.receive().value());
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  for (const auto* spectatorDecoder : { &firstDecoder, &secondDecoder }) {
+    assert(spectatorDecoder->getFrame().tick == decoder.getFrame().tick);
+    assert(spectatorDecoder->getFrame().cells == decoder.getFrame().cells);
+  }
+}
+
+void
+testCommandQueue()
+{
+  MpscQueue<int> small(3);
+  assert(small.getCapacity() == 4);
+  for (int i = 0; i < 4; i++) {
+    assert(small.push(i));
+  }
+  assert(!small.push(4));
+  for (int i = 0; i < 4; i++) {
+    assert(small.pop() == i);
+  }
+  assert(!small.pop());
+
+  // values of each producer arrive in order, none is lost or duplicated
+  constexpr unsigned producerCount = 4;
+  constexpr std::uint32_t valueCount = 50'000;
+  MpscQueue<std::uint64_t> queue(256);
+  std::vector<std::thread> producers;
+  for (std::uint64_t producer = 0; producer < producerCount; producer++) {
+    producers.emplace_back([&queue, producer]() {
+      for (std::uint32_t i = 0; i < valueCount; i++) {
+        while (!queue.push(producer << 32 | i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  std::array<std::uint32_t, producerCount> nextValues{};
+  for (std::uint64_t received = 0; received < producerCount * valueCount;) {
+    const auto value = queue.pop();
+    if (!value) {
+      std::this_thread::yield();
+      continue;
+    }
+    assert((*value & 0xFFFFFFFF) == nextValues[*value >> 32]);
+    nextValues[*value >> 32]++;
+    received++;
+  }
+  for (auto& producer : producers) {
+    producer.join();
+  }
+  assert(!queue.pop());
+
+  // world applies commands at the start of tick, in order of submission
+  World world;
+  world.restartLevel();
+  const auto paddleX = world.getStateSnapshot().paddleX;
+  std::thread([&world]() {
+    world.submitCommand({ WorldCommand::Type::moveRight, 1 });
+    world.submitCommand({ WorldCommand::Type::moveRight, 0 });
+    world.submitCommand({ WorldCommand::Type::moveLeft, 1 });
+  }).join();
+  world.update(std::chrono::milliseconds(16));
+  assert(world.getStateSnapshot().paddleX < paddleX);
+}
+
+void
+testQualityGovernor()
+{
+  using std::chrono::microseconds;
+
+  QualityGovernor::Settings settings;
+  settings.targetFrameTime = microseconds(10'000);
+  settings.degradeFrames = 3;
+  settings.restoreFrames = 5;
+  QualityGovernor governor(settings);
+
+  // render is the expensive part: tile overlay goes first
+  for (int i = 0; i < 2; i++) {
+    assert(!governor.onFrame(microseconds(2'000), microseconds(12'000)));
+  }
+  assert(governor.onFrame(microseconds(2'000), microseconds(12'000)));
+  assert(!governor.getQuality().hasTileOverlay);
+  assert(governor.getQuality().ballMicrosteps == Constants::ballMicrosteps);
+  assert(governor.getLevel() == 1);
+
+  // still over budget: microsteps are reduced down to the minimum
+  unsigned changes = 0;
+  for (int i = 0; i < 30; i++) {
+    changes += governor.onFrame(microseconds(2'000), microseconds(12'000));
+  }
+  assert(changes == 2);
+  assert(governor.getQuality().ballMicrosteps == Constants::minBallMicrosteps);
+
+  // frames within budget but without headroom keep the quality
+  QualityGovernor steady(settings);
+  for (int i = 0; i < 100; i++) {
+    assert(!steady.onFrame(microseconds(3'000), microseconds(4'000)));
+  }
+  assert(steady.getLevel() == 0);
+
+  // waiting for vblank in present is not work of frame
+  ProfileFrame vsynced;
+  vsynced.phaseNs[static_cast<std::size_t>(ProfilePhase::present)] =
+    15'000'000;
+  vsynced.phaseNs[static_cast<std::size_t>(ProfilePhase::renderEntities)] =
+    1'000'000;
+  for (int i = 0; i < 100; i++) {
+    assert(!steady.onFrame(vsynced));
+  }
+  assert(steady.getLevel() == 0);
+
+  // headroom restores microsteps first, then the overlay
+  while (!governor.onFrame(microseconds(500), microseconds(500))) {
+  }
+  assert(governor.getQuality().ballMicrosteps < Constants::ballMicrosteps);
+  assert(!governor.getQuality().hasTileOverlay);
+  for (int i = 0; i < 100; i++) {
+    governor.onFrame(microseconds(500), microseconds(500));
+  }
+  assert(governor.getQuality() == QualitySettings{});
+  assert(governor.getLevel() == 0);
+
+  // the coarsest microsteps still keep ball within the world
+  World world;
+  world.setRandomSeed(1);
+  world.setQuality({ false, Constants::minBallMicrosteps });
+  world.setAutopilot(true);
+  for (int i = 0; i < 600; i++) {
+    world.update(std::chrono::milliseconds(34));
+    const auto state = world.getStateSnapshot();
+    assert(!state.hasBall ||
+           (state.ballX >= 0 && state.ballX <= Constants::worldWidth &&
+            state.ballY >= 0));
+  }
+}
+
+void
+testLevelFileValidation()
+{
+  const auto path =
+    (std::filesystem::temp_directory_path() / "sandbox_level.arkl").string();
+  const auto isRejected = [&](const level::Header& header,
+                              std::span<const level::TileRecord> tiles) {
+    {
+      std::ofstream file(path, std::ios::binary);
+      file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+      file.write(reinterpret_cast<const char*>(tiles.data()),
+                 tiles.size_bytes());
+    }
+    try {
+      level::LevelFile level(path);
+      return false;
+    } catch (const std::runtime_error&) {
+      return true;
+    }
+  };
+
+  level::Header header{};
+  header.magic = level::magic;
+  header.version = level::version;
+  header.paletteOffset = sizeof(header);
+  header.tilesOffset = sizeof(header);
+  assert(!isRejected(header, {}));
+
+  // columns * rows * sizeof(TileRecord) wraps around in 64 bits
+  header.columns = 0x80000000u;
+  header.rows = 0x80000000u;
+  assert(isRejected(header, {}));
+
+  header.columns = 1;
+  header.rows = 1;
+  assert(isRejected(header, {}));
+
+  // count of tiles in header can not exceed the grid (records are not
+  // scanned)
+  const std::array<level::TileRecord, 1> tiles = { level::TileRecord{
+    0, 1, 0, 0 } };
+  assert(!isRejected(header, tiles));
+  header.tileCount = 2;
+  assert(isRejected(header, tiles));
+  header.tileCount = 1;
+  assert(!isRejected(header, tiles));
+  std::filesystem::remove(path);
+}
+
+void
+testCamera()
+{
+  // ball high above in tall world, paddle at the bottom stays in view
+  const SDL_FPoint worldSize{ 1000, 3000 };
+  const SDL_FRect paddle{ 400, 2980, 200, 10 };
+  Camera camera;
+  camera.view = SDL_FRect{ 0, 0, 1000, 750 };
+  camera.moveTo(SDL_FPoint{ 500, 100 }, worldSize);
+  camera.keepInView(paddle, worldSize);
+  assert(camera.view.y + camera.view.h >= paddle.y + paddle.h);
+  assert(camera.view.y <= paddle.y);
+
+  // body already in view does not move it
+  const auto view = camera.view;
+  camera.keepInView(SDL_FRect{ 100, 2500, 10, 10 }, worldSize);
+  assert(camera.view.x == view.x && camera.view.y == view.y);
+}
+
 int
 main(int argc, char* args[])
 {
   testCollisionStateDetection();
+  testCollisionSpans();
+  testScriptScheduler();
+  testAtlasPacking();
+  testRasterKernels();
+  testTextureCache();
+  testScaledSpriteCache();
+  testQoiEncoder();
+  testResample();
+  testProfiler();
+  testAutopilot();
+  testVectorEnv();
+  testOccupancyGrid();
+  testSharedState();
+  testRollback();
+  testSpectatorStream();
+  testCommandQueue();
+  testQualityGovernor();
+  testLevelFileValidation();
+  testCamera();
   std::cout << "end" << std::endl;
   return 0;
 }
\ No newline at end of file
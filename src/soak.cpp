@@ -0,0 +1,342 @@
+#include <SDL.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+// note: must follow windows.h
+#include <psapi.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "game/application.hpp"
+#include "game/world.hpp"
+
+/**
+ * Soak test: autopilot plays the game for a long time
+ *
+ * Usage: soak [--minutes N] [--interval seconds] [--window] [--software]
+ *             [--level file.arkl] [--output samples.csv]
+ *             [--max-rss-growth MiB]
+ *
+ * Headless by default: frames are simulated with fixed time step as fast as
+ * possible. With --window, the game is played in real time in a window.
+ * Each interval, frame-time percentiles, resident memory, cached textures and
+ * depth of event queue are printed (and appended to CSV). Exits with 1 if
+ * resident memory grew more than allowed since the first interval.
+ */
+
+namespace {
+//! Simulated time between headless frames
+constexpr auto frameDelta = std::chrono::microseconds(16'667);
+
+struct Settings
+{
+  std::chrono::minutes duration{ 60 };
+  std::chrono::seconds interval{ 60 };
+  bool isWindowed{ false };
+  RenderBackendType backend{ RenderBackendType::sdl };
+  std::string levelPath;
+  std::string outputPath;
+  std::optional<std::size_t> maxRssGrowth;
+};
+
+//! Measurements of single interval
+struct Sample
+{
+  std::chrono::seconds elapsed{ 0 };
+  std::size_t frames{ 0 };
+  std::chrono::microseconds frameTimeP50{ 0 };
+  std::chrono::microseconds frameTimeP99{ 0 };
+  std::chrono::microseconds frameTimeMax{ 0 };
+  std::size_t residentBytes{ 0 };
+  std::size_t textureCount{ 0 };
+  std::size_t textureBytes{ 0 };
+  std::size_t maxEventQueueDepth{ 0 };
+};
+
+Settings
+parseSettings(int argc, char* args[])
+{
+  Settings settings;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = args[i];
+    const auto nextValue = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value of " + arg);
+      }
+      return args[++i];
+    };
+
+    if (arg == "--minutes") {
+      settings.duration = std::chrono::minutes(std::stoul(nextValue()));
+    } else if (arg == "--interval") {
+      settings.interval =
+        std::chrono::seconds(std::max(1ul, std::stoul(nextValue())));
+    } else if (arg == "--window") {
+      settings.isWindowed = true;
+    } else if (arg == "--software") {
+      settings.backend = RenderBackendType::software;
+    } else if (arg == "--level") {
+      settings.levelPath = nextValue();
+    } else if (arg == "--output") {
+      settings.outputPath = nextValue();
+    } else if (arg == "--max-rss-growth") {
+      settings.maxRssGrowth = std::stoul(nextValue()) * 1024 * 1024;
+    } else {
+      throw std::runtime_error("Unknown argument: " + arg);
+    }
+  }
+  return settings;
+}
+
+//! Resident memory of process in bytes (0 if unknown on platform)
+std::size_t
+getResidentBytes()
+{
+#ifdef _WIN32
+  PROCESS_MEMORY_COUNTERS counters;
+  if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    return counters.WorkingSetSize;
+  }
+  return 0;
+#else
+  // note: second field is count of resident pages
+  std::ifstream statm("/proc/self/statm");
+  std::size_t totalPages = 0;
+  std::size_t residentPages = 0;
+  if (!(statm >> totalPages >> residentPages)) {
+    return 0;
+  }
+  return residentPages * static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+/**
+ * @brief Collects frame times & game state, summarizes them per interval
+ */
+class SoakMonitor
+{
+public:
+  using Clock = std::chrono::steady_clock;
+
+  explicit SoakMonitor(const Settings& settings)
+    : m_settings(settings)
+    , m_start(Clock::now())
+    , m_intervalStart(m_start)
+  {
+    if (!settings.outputPath.empty()) {
+      m_output.open(settings.outputPath);
+      if (!m_output) {
+        throw std::runtime_error("Failed to open output: " +
+                                 settings.outputPath);
+      }
+      m_output << "elapsed_s,frames,frame_p50_us,frame_p99_us,frame_max_us,"
+                  "rss_kib,textures,texture_kib,max_event_queue\n";
+    }
+  }
+
+  //! Record finished frame, returns false once soak should end
+  bool onFrame(std::chrono::microseconds frameTime,
+               const Application& app,
+               const World& world)
+  {
+    m_frameTimes.push_back(frameTime);
+    m_maxEventQueueDepth =
+      std::max(m_maxEventQueueDepth, world.getPendingEventCount());
+
+    const auto now = Clock::now();
+    if (now - m_intervalStart >= m_settings.interval) {
+      addSample(app);
+      m_intervalStart = now;
+    }
+    return now - m_start < m_settings.duration;
+  }
+
+  //! Print summary, returns false if memory grew over limit
+  bool finish(const Application& app)
+  {
+    if (!m_frameTimes.empty()) {
+      addSample(app);
+    }
+    if (m_samples.empty()) {
+      return true;
+    }
+
+    const auto& first = m_samples.front();
+    const auto& last = m_samples.back();
+    const auto growth = static_cast<std::int64_t>(last.residentBytes) -
+                        static_cast<std::int64_t>(first.residentBytes);
+    std::size_t frames = 0;
+    std::size_t maxTextures = 0;
+    std::size_t maxEventQueueDepth = 0;
+    auto worstFrameTimeP99 = std::chrono::microseconds(0);
+    for (const auto& sample : m_samples) {
+      frames += sample.frames;
+      maxTextures = std::max(maxTextures, sample.textureCount);
+      maxEventQueueDepth =
+        std::max(maxEventQueueDepth, sample.maxEventQueueDepth);
+      worstFrameTimeP99 = std::max(worstFrameTimeP99, sample.frameTimeP99);
+    }
+
+    std::cout << std::format(
+      "soak: {} s, {} frames, worst p99 {} us, RSS growth {} KiB, "
+      "max textures {}, max event queue {}\n",
+      last.elapsed.count(),
+      frames,
+      worstFrameTimeP99.count(),
+      growth / 1024,
+      maxTextures,
+      maxEventQueueDepth);
+
+    if (m_settings.maxRssGrowth &&
+        growth > static_cast<std::int64_t>(*m_settings.maxRssGrowth)) {
+      std::cerr << std::format(
+        "Resident memory grew by {} KiB (limit {} KiB)\n",
+        growth / 1024,
+        *m_settings.maxRssGrowth / 1024);
+      return false;
+    }
+    return true;
+  }
+
+protected:
+  void addSample(const Application& app)
+  {
+    std::sort(m_frameTimes.begin(), m_frameTimes.end());
+    const auto percentile = [this](double percentile) {
+      return m_frameTimes[static_cast<std::size_t>(
+        percentile / 100.0 * (m_frameTimes.size() - 1))];
+    };
+
+    const auto& textures = app.getTextureCacheStats();
+    Sample sample;
+    sample.elapsed =
+      std::chrono::duration_cast<std::chrono::seconds>(Clock::now() - m_start);
+    sample.frames = m_frameTimes.size();
+    sample.frameTimeP50 = percentile(50.0);
+    sample.frameTimeP99 = percentile(99.0);
+    sample.frameTimeMax = m_frameTimes.back();
+    sample.residentBytes = getResidentBytes();
+    sample.textureCount = textures.textureCount;
+    sample.textureBytes = textures.usedBytes;
+    sample.maxEventQueueDepth = m_maxEventQueueDepth;
+    m_samples.push_back(sample);
+
+    std::cout << std::format(
+      "[{:>6} s] frames {} frame time [us] p50 {} p99 {} max {} | RSS {} KiB "
+      "| textures {} ({} KiB) | max event queue {}\n",
+      sample.elapsed.count(),
+      sample.frames,
+      sample.frameTimeP50.count(),
+      sample.frameTimeP99.count(),
+      sample.frameTimeMax.count(),
+      sample.residentBytes / 1024,
+      sample.textureCount,
+      sample.textureBytes / 1024,
+      sample.maxEventQueueDepth);
+
+    if (m_output.is_open()) {
+      m_output << std::format("{},{},{},{},{},{},{},{},{}\n",
+                              sample.elapsed.count(),
+                              sample.frames,
+                              sample.frameTimeP50.count(),
+                              sample.frameTimeP99.count(),
+                              sample.frameTimeMax.count(),
+                              sample.residentBytes / 1024,
+                              sample.textureCount,
+                              sample.textureBytes / 1024,
+                              sample.maxEventQueueDepth);
+      m_output.flush();
+    }
+
+    m_frameTimes.clear();
+    m_maxEventQueueDepth = 0;
+  }
+
+private:
+  const Settings& m_settings;
+  Clock::time_point m_start;
+  Clock::time_point m_intervalStart;
+
+  //! Frames of current interval
+  std::vector<std::chrono::microseconds> m_frameTimes;
+  std::size_t m_maxEventQueueDepth{ 0 };
+
+  std::vector<Sample> m_samples;
+  std::ofstream m_output;
+};
+} // namespace
+
+int
+main(int argc, char* args[])
+{
+  using clock = std::chrono::high_resolution_clock;
+
+  try {
+    const auto settings = parseSettings(argc, args);
+
+    Application app;
+    World world;
+    if (!settings.levelPath.empty()) {
+      world.loadLevel(level::LevelFile(settings.levelPath));
+    }
+    world.setAutopilot(true);
+
+    SoakMonitor monitor(settings);
+    auto lastFrame = clock::now();
+    bool isRunning = true;
+
+    app.onInitCallback = [&]() {
+#ifdef ARKANOID_EMBED_ASSETS
+      app.loadBakedAssets();
+#else
+      app.loadAssets("assets");
+#endif
+      world.bindSprites(app);
+      lastFrame = clock::now();
+    };
+    app.onRenderCallback = [&]() {
+      const auto now = clock::now();
+      const auto frameTime =
+        std::chrono::duration_cast<std::chrono::microseconds>(now - lastFrame);
+      lastFrame = now;
+
+      // note: window is not paused for soak (even when it loses focus)
+      world.update(settings.isWindowed ? frameTime : frameDelta);
+      world.render(app);
+
+      isRunning = monitor.onFrame(frameTime, app, world);
+      if (!isRunning && settings.isWindowed) {
+        SDL_Event quit{};
+        quit.type = SDL_QUIT;
+        SDL_PushEvent(&quit);
+      }
+    };
+    app.setRenderBackend(settings.backend);
+
+    if (settings.isWindowed) {
+      app.createApplication();
+      app.runLoop();
+    } else {
+      app.createHeadlessApplication();
+      while (isRunning) {
+        app.renderFrame();
+      }
+    }
+
+    return monitor.finish(app) ? 0 : 1;
+  } catch (const std::exception& e) {
+    std::cerr << "Soak failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,260 @@
+#include <SDL.h>
+
+#include <chrono>
+#include <format>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "game/application.hpp"
+#include "game/camera.hpp"
+#include "game/constants.hpp"
+#include "game/spectator_stream.hpp"
+#include "game/transport.hpp"
+#include "game/world.hpp"
+
+/**
+ * Spectator: watch game streamed by `arkanoid --spectators <port|file>`
+ *
+ * Usage: spectator [--host 127.0.0.1] [--port 7100] [--file stream.arkv]
+ *                  [--software] [--headless]
+ *
+ * Connects to game's port (or follows file as it grows) and renders the
+ * decoded state. With --headless, only received bandwidth is printed each
+ * second. Ends when the game closes the stream (or window is closed).
+ */
+
+namespace {
+//! Bytes read from file per poll
+constexpr std::size_t fileChunkSize = 64 * 1024;
+
+//! Headless spectator polls stream with this period
+constexpr auto headlessPollPeriod = std::chrono::milliseconds(5);
+
+struct Settings
+{
+  std::string host{ "127.0.0.1" };
+  std::uint16_t port{ spectator::defaultPort };
+  std::string filePath;
+  RenderBackendType backend{ RenderBackendType::sdl };
+  bool isHeadless{ false };
+};
+
+Settings
+parseSettings(int argc, char* args[])
+{
+  Settings settings;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = args[i];
+    const auto nextValue = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value of " + arg);
+      }
+      return args[++i];
+    };
+
+    if (arg == "--host") {
+      settings.host = nextValue();
+    } else if (arg == "--port") {
+      settings.port = static_cast<std::uint16_t>(std::stoul(nextValue()));
+    } else if (arg == "--file") {
+      settings.filePath = nextValue();
+    } else if (arg == "--software") {
+      settings.backend = RenderBackendType::software;
+    } else if (arg == "--headless") {
+      settings.isHeadless = true;
+    } else {
+      throw std::runtime_error("Unknown argument: " + arg);
+    }
+  }
+  return settings;
+}
+
+//! Source of stream: received bytes (possibly none yet), none once it ended
+using StreamSource = std::function<std::optional<Datagram>()>;
+
+StreamSource
+openSource(const Settings& settings)
+{
+  if (settings.filePath.empty()) {
+    auto client = std::make_shared<StreamClient>(settings.host, settings.port);
+    return [client]() { return client->receive(); };
+  }
+
+  auto file = std::make_shared<std::ifstream>(settings.filePath,
+                                              std::ios::binary);
+  if (!*file) {
+    throw std::runtime_error("Failed to open stream: " + settings.filePath);
+  }
+
+  // note: file is followed as game appends to it, it never ends
+  return [file]() -> std::optional<Datagram> {
+    Datagram bytes(fileChunkSize);
+    file->read(reinterpret_cast<char*>(bytes.data()), bytes.size());
+    bytes.resize(static_cast<std::size_t>(file->gcount()));
+    file->clear();
+    return bytes;
+  };
+}
+
+void
+renderText(Application& app, const std::string& text, SDL_Point position)
+{
+  const auto texture = app.getCachedTextureForText(text);
+  const auto textSize = app.getTextureSize(texture);
+  SDL_Rect rect{ position.x, position.y, textSize.x, textSize.y };
+  app.copyTexture(texture, NULL, &rect);
+}
+
+void
+renderFrame(Application& app, const spectator::Frame& frame)
+{
+  using spectator::dequantize;
+  using spectator::Field;
+
+  const auto appSize = app.getWindowSize();
+  SDL_Rect viewport;
+  viewport.x = Constants::worldRenderingHorizontalMargin;
+  viewport.y = Constants::worldRenderingTopMargin;
+  viewport.w = appSize.x - Constants::worldRenderingHorizontalMargin * 2;
+  viewport.h = appSize.y - Constants::worldRenderingTopMargin;
+
+  Camera camera;
+  camera.view = dequantize(frame[Field::viewX],
+                           frame[Field::viewY],
+                           frame[Field::viewWidth],
+                           frame[Field::viewHeight]);
+  const auto transform = camera.getViewTransform({ viewport.w, viewport.h });
+
+  app.setViewport(&viewport);
+  for (int row = 0; row < frame.rows; row++) {
+    for (int column = 0; column < frame.columns; column++) {
+      const auto& cell = frame.cells[row * frame.columns + column];
+      const SDL_FRect body{ static_cast<float>(column * Constants::tileWidth),
+                            static_cast<float>(row * Constants::tileHeight),
+                            static_cast<float>(Constants::tileWidth),
+                            static_cast<float>(Constants::tileHeight) };
+      if (cell.lifes > 0 && SDL_HasIntersectionF(&body, &camera.view)) {
+        app.fillRect(transform.toView(body), cell.color);
+      }
+    }
+  }
+
+  if (const auto radius = frame[Field::ballRadius]; radius > 0) {
+    app.fillRect(transform.toView(dequantize(frame[Field::ballX] - radius,
+                                             frame[Field::ballY] - radius,
+                                             radius * 2,
+                                             radius * 2)),
+                 Color::black);
+  }
+  app.fillRect(transform.toView(dequantize(frame[Field::paddleX],
+                                           frame[Field::paddleY],
+                                           frame[Field::paddleWidth],
+                                           frame[Field::paddleHeight])),
+               Color::black);
+  for (const auto& pickup : frame.pickups) {
+    app.fillRect(
+      transform.toView(
+        dequantize(pickup.x, pickup.y, pickup.width, pickup.height)),
+      pickup.color);
+  }
+  app.setViewport(nullptr);
+
+  const auto status = static_cast<GameStatus>(frame[Field::status]);
+  const auto statusText = status == GameStatus::running     ? ""
+                          : status == GameStatus::game_over ? " - game over"
+                          : status == GameStatus::you_won   ? " - won"
+                                                            : " - not started";
+  renderText(app,
+             std::format("Lives: {}  Score: {}{}",
+                         frame[Field::remainingBalls],
+                         frame[Field::score],
+                         statusText),
+             { 5, 5 });
+}
+
+//! Print received bandwidth each second until stream ends
+void
+runHeadless(const StreamSource& receive, spectator::Decoder& decoder)
+{
+  using clock = std::chrono::steady_clock;
+  auto secondStart = clock::now();
+  std::uint64_t secondBytes = decoder.getReceivedBytes();
+  std::size_t secondMessages = 0;
+
+  while (const auto bytes = receive()) {
+    secondMessages += decoder.feed(*bytes);
+    if (bytes->empty()) {
+      std::this_thread::sleep_for(headlessPollPeriod);
+    }
+
+    if (clock::now() - secondStart >= std::chrono::seconds(1)) {
+      std::cout << std::format(
+        "tick {} | {} messages, {} B/s | score {}\n",
+        decoder.getFrame().tick,
+        secondMessages,
+        decoder.getReceivedBytes() - secondBytes,
+        decoder.getFrame()[spectator::Field::score]);
+      secondStart = clock::now();
+      secondBytes = decoder.getReceivedBytes();
+      secondMessages = 0;
+    }
+  }
+}
+} // namespace
+
+int
+main(int argc, char* args[])
+{
+  try {
+    const auto settings = parseSettings(argc, args);
+    const auto receive = openSource(settings);
+    spectator::Decoder decoder;
+
+    if (settings.isHeadless) {
+      runHeadless(receive, decoder);
+      return 0;
+    }
+
+    Application app;
+    bool hasEnded = false;
+    app.onInitCallback = [&]() {};
+    app.onRenderCallback = [&]() {
+      // note: messages are applied as they come, the latest state is shown
+      while (!hasEnded) {
+        const auto bytes = receive();
+        if (!bytes) {
+          hasEnded = true;
+          break;
+        }
+        if (bytes->empty()) {
+          break;
+        }
+        decoder.feed(*bytes);
+      }
+
+      if (decoder.isSynced()) {
+        renderFrame(app, decoder.getFrame());
+      } else {
+        renderText(app,
+                   hasEnded ? "Stream ended" : "Waiting for keyframe",
+                   { 5, 5 });
+      }
+    };
+    app.setRenderBackend(settings.backend);
+
+    app.createApplication();
+    app.runLoop();
+
+    std::cout << std::format("spectator: received {} B, tick {}\n",
+                             decoder.getReceivedBytes(),
+                             decoder.getFrame().tick);
+    return 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Spectator failed: " << e.what() << std::endl;
+    return 1;
+  }
+}
@@ -0,0 +1,113 @@
+#include "arkanoid_state.h"
+
+#include <algorithm>
+#include <exception>
+#include <stdexcept>
+#include <string>
+
+#include "game/shared_state.hpp"
+
+struct arkanoid_state_reader
+{
+  explicit arkanoid_state_reader(const char* name)
+    : reader(name != nullptr ? name : shared_state::defaultName)
+  {
+  }
+
+  shared_state::Reader reader;
+};
+
+static_assert(ARKANOID_STATE_TILE_COLUMNS == shared_state::tileColumns);
+static_assert(ARKANOID_STATE_TILE_ROWS == shared_state::tileRows);
+
+namespace {
+thread_local std::string lastError;
+
+//! Run function, converting exceptions into error code & message
+template<typename Function>
+int
+guard(Function&& function)
+{
+  try {
+    const auto result = function();
+    lastError.clear();
+    return result;
+  } catch (const std::exception& e) {
+    lastError = e.what();
+  } catch (...) {
+    lastError = "Unknown error";
+  }
+  return -1;
+}
+} // namespace
+
+extern "C" {
+arkanoid_state_reader*
+arkanoid_state_open(const char* name)
+{
+  arkanoid_state_reader* reader = nullptr;
+  guard([&]() {
+    reader = new arkanoid_state_reader(name);
+    return 0;
+  });
+  return reader;
+}
+
+void
+arkanoid_state_close(arkanoid_state_reader* reader)
+{
+  delete reader;
+}
+
+int
+arkanoid_state_read(arkanoid_state_reader* reader, arkanoid_state* state)
+{
+  return guard([&]() {
+    if (reader == nullptr || state == nullptr) {
+      throw std::invalid_argument("Missing reader or state");
+    }
+
+    const auto snapshot = reader->reader.read();
+    if (!snapshot) {
+      return 1;
+    }
+
+    state->tick = snapshot->tick;
+    state->status = snapshot->status;
+    state->score = snapshot->score;
+    state->remaining_balls = snapshot->remainingBalls;
+    state->remaining_tiles = snapshot->remainingTiles;
+    state->speed = snapshot->speed;
+    state->has_ball = snapshot->hasBall;
+    state->ball_x = snapshot->ballX;
+    state->ball_y = snapshot->ballY;
+    state->ball_speed_x = snapshot->ballSpeedX;
+    state->ball_speed_y = snapshot->ballSpeedY;
+    state->ball_radius = snapshot->ballRadius;
+    state->paddle_x = snapshot->paddleX;
+    state->paddle_y = snapshot->paddleY;
+    state->paddle_width = snapshot->paddleWidth;
+    state->paddle_height = snapshot->paddleHeight;
+    state->view_x = snapshot->viewX;
+    state->view_y = snapshot->viewY;
+    state->view_width = snapshot->viewWidth;
+    state->view_height = snapshot->viewHeight;
+    state->first_column = snapshot->firstColumn;
+    state->first_row = snapshot->firstRow;
+    std::copy(snapshot->tiles.begin(), snapshot->tiles.end(), state->tiles);
+    return 0;
+  });
+}
+
+uint64_t
+arkanoid_state_retry_count(const arkanoid_state_reader* reader)
+{
+  return reader != nullptr ? reader->reader.getRetryCount() : 0;
+}
+
+const char*
+arkanoid_state_last_error(void)
+{
+  return lastError.c_str();
+}
+}
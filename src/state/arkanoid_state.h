@@ -0,0 +1,83 @@
+#ifndef ARKANOID_STATE_H
+#define ARKANOID_STATE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * C API for reading live state of running game (overlays, analytics, tests)
+ *
+ * Game started with --export-state publishes its state into shared memory
+ * after each update. Reading never slows the game down: torn reads (while
+ * the game was writing) are detected and retried.
+ *
+ * Functions returning int return 0 on success, 1 if no state is available
+ * yet and -1 on failure, see arkanoid_state_last_error().
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct arkanoid_state_reader arkanoid_state_reader;
+
+enum arkanoid_status
+{
+  ARKANOID_STATUS_INITIAL_SCREEN = 0,
+  ARKANOID_STATUS_RUNNING = 1,
+  ARKANOID_STATUS_YOU_WON = 2,
+  ARKANOID_STATUS_GAME_OVER = 3
+};
+
+#define ARKANOID_STATE_TILE_COLUMNS 10
+#define ARKANOID_STATE_TILE_ROWS 10
+
+/* Consistent state of game after single update (positions in world units) */
+typedef struct arkanoid_state
+{
+  uint64_t tick;
+  int32_t status; /* enum arkanoid_status */
+  int32_t score;
+  uint32_t remaining_balls;
+  uint32_t remaining_tiles;
+  float speed;
+
+  uint32_t has_ball; /* ball values are zero if not in play */
+  float ball_x, ball_y;
+  float ball_speed_x, ball_speed_y;
+  float ball_radius;
+
+  float paddle_x, paddle_y, paddle_width, paddle_height;
+  float view_x, view_y, view_width, view_height;
+
+  /* Lifes of tiles in cells of view (row-major, 0 = empty), tiles[0] is at
+   * level cell (first_column, first_row) */
+  int32_t first_column, first_row;
+  uint8_t tiles[ARKANOID_STATE_TILE_COLUMNS * ARKANOID_STATE_TILE_ROWS];
+} arkanoid_state;
+
+/* Open state of running game, NULL name uses the default one. Returns NULL
+ * on failure (e.g. game is not running). */
+arkanoid_state_reader*
+arkanoid_state_open(const char* name);
+
+void
+arkanoid_state_close(arkanoid_state_reader* reader);
+
+/* Read the latest state */
+int
+arkanoid_state_read(arkanoid_state_reader* reader, arkanoid_state* state);
+
+/* Count of torn reads retried by reader so far */
+uint64_t
+arkanoid_state_retry_count(const arkanoid_state_reader* reader);
+
+/* Message of the last failure on calling thread (empty if none) */
+const char*
+arkanoid_state_last_error(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
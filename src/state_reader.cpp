@@ -0,0 +1,144 @@
+#include <chrono>
+#include <cstdint>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+#include "state/arkanoid_state.h"
+
+/**
+ * Prints live state of running game (started with --export-state)
+ *
+ * Usage: state_reader [--name shm_name] [--interval ms] [--count N]
+ *                     [--tiles]
+ *
+ * Reads the state each interval (count 0 = until interrupted) and prints
+ * a line per read. With --tiles, lifes of tiles in view are printed too.
+ */
+
+namespace {
+struct Settings
+{
+  std::string name;
+  std::chrono::milliseconds interval{ 500 };
+  unsigned count{ 0 };
+  bool hasTiles{ false };
+};
+
+Settings
+parseSettings(int argc, char* args[])
+{
+  Settings settings;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = args[i];
+    const auto nextValue = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value of " + arg);
+      }
+      return args[++i];
+    };
+
+    if (arg == "--name") {
+      settings.name = nextValue();
+    } else if (arg == "--interval") {
+      settings.interval = std::chrono::milliseconds(std::stoul(nextValue()));
+    } else if (arg == "--count") {
+      settings.count = std::stoul(nextValue());
+    } else if (arg == "--tiles") {
+      settings.hasTiles = true;
+    } else {
+      throw std::runtime_error("Unknown argument: " + arg);
+    }
+  }
+  return settings;
+}
+
+const char*
+getStatusName(std::int32_t status)
+{
+  switch (status) {
+    case ARKANOID_STATUS_INITIAL_SCREEN:
+      return "initial screen";
+    case ARKANOID_STATUS_RUNNING:
+      return "running";
+    case ARKANOID_STATUS_YOU_WON:
+      return "you won";
+    case ARKANOID_STATUS_GAME_OVER:
+      return "game over";
+    default:
+      return "unknown";
+  }
+}
+
+void
+printState(const arkanoid_state& state, bool hasTiles)
+{
+  std::cout << std::format(
+    "tick {} | {} | score {} | balls {} | tiles {} | paddle x {:.0f}",
+    state.tick,
+    getStatusName(state.status),
+    state.score,
+    state.remaining_balls,
+    state.remaining_tiles,
+    state.paddle_x);
+  if (state.has_ball) {
+    std::cout << std::format(" | ball [{:.0f}, {:.0f}] speed [{:.0f}, {:.0f}]",
+                             state.ball_x,
+                             state.ball_y,
+                             state.ball_speed_x,
+                             state.ball_speed_y);
+  }
+  std::cout << "\n";
+
+  if (hasTiles) {
+    for (int row = 0; row < ARKANOID_STATE_TILE_ROWS; row++) {
+      for (int column = 0; column < ARKANOID_STATE_TILE_COLUMNS; column++) {
+        const auto lifes =
+          state.tiles[row * ARKANOID_STATE_TILE_COLUMNS + column];
+        std::cout << (lifes > 0 ? static_cast<char>('0' + lifes % 10) : '.');
+      }
+      std::cout << "\n";
+    }
+  }
+}
+} // namespace
+
+int
+main(int argc, char* args[])
+{
+  try {
+    const auto settings = parseSettings(argc, args);
+
+    auto* reader = arkanoid_state_open(
+      settings.name.empty() ? nullptr : settings.name.c_str());
+    if (reader == nullptr) {
+      throw std::runtime_error(arkanoid_state_last_error());
+    }
+
+    for (unsigned read = 0; settings.count == 0 || read < settings.count;
+         read++) {
+      arkanoid_state state;
+      const auto result = arkanoid_state_read(reader, &state);
+      if (result < 0) {
+        arkanoid_state_close(reader);
+        throw std::runtime_error(arkanoid_state_last_error());
+      }
+      if (result == 0) {
+        printState(state, settings.hasTiles);
+      } else {
+        std::cout << "waiting for the game to publish state\n";
+      }
+      std::this_thread::sleep_for(settings.interval);
+    }
+
+    std::cout << std::format("torn reads retried: {}\n",
+                             arkanoid_state_retry_count(reader));
+    arkanoid_state_close(reader);
+  } catch (const std::exception& e) {
+    std::cerr << "Reading state failed: " << e.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,212 @@
+#include <SDL.h>
+
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <string>
+
+#include "game/application.hpp"
+#include "game/rollback.hpp"
+#include "game/transport.hpp"
+#include "game/world.hpp"
+
+/**
+ * Versus: two players on two computers (or two windows), kept in sync by
+ * rollback over UDP
+ *
+ * Usage: versus --player 0|1 --port local-port --peer host:port
+ *                [--seed N] [--max-rollback frames] [--software]
+ *
+ * Both peers must use the same seed. Each player plays own field (the same
+ * level), opponent's score is shown at the top. Left/right arrows move the
+ * paddle, space releases the ball. Statistics of rollbacks are printed when
+ * window is closed.
+ */
+
+namespace {
+struct Settings
+{
+  RollbackSession::Settings session;
+  std::uint16_t localPort{ 0 };
+  std::string remoteHost;
+  std::uint16_t remotePort{ 0 };
+  RenderBackendType backend{ RenderBackendType::sdl };
+};
+
+Settings
+parseSettings(int argc, char* args[])
+{
+  Settings settings;
+  for (int i = 1; i < argc; i++) {
+    const std::string arg = args[i];
+    const auto nextValue = [&]() -> std::string {
+      if (i + 1 >= argc) {
+        throw std::runtime_error("Missing value of " + arg);
+      }
+      return args[++i];
+    };
+
+    if (arg == "--player") {
+      settings.session.localPlayer = std::stoul(nextValue());
+    } else if (arg == "--port") {
+      settings.localPort = static_cast<std::uint16_t>(std::stoul(nextValue()));
+    } else if (arg == "--peer") {
+      const auto peer = nextValue();
+      const auto separator = peer.rfind(':');
+      if (separator == std::string::npos) {
+        throw std::runtime_error("Peer must be host:port, got: " + peer);
+      }
+      settings.remoteHost = peer.substr(0, separator);
+      settings.remotePort =
+        static_cast<std::uint16_t>(std::stoul(peer.substr(separator + 1)));
+    } else if (arg == "--seed") {
+      settings.session.seed = std::stoul(nextValue());
+    } else if (arg == "--max-rollback") {
+      settings.session.maxRollbackFrames = std::stoul(nextValue());
+    } else if (arg == "--software") {
+      settings.backend = RenderBackendType::software;
+    } else {
+      throw std::runtime_error("Unknown argument: " + arg);
+    }
+  }
+
+  if (settings.localPort == 0 || settings.remotePort == 0) {
+    throw std::runtime_error("Both --port and --peer are required");
+  }
+  return settings;
+}
+
+//! Input of local player from keyboard, release is reported once per press
+class KeyboardInput
+{
+public:
+  void onEvent(const SDL_Event& event)
+  {
+    if (event.type != SDL_KEYDOWN && event.type != SDL_KEYUP) {
+      return;
+    }
+
+    const bool isKeyDown = event.type == SDL_KEYDOWN;
+    if (event.key.keysym.sym == SDLK_LEFT) {
+      m_isLeftDown = isKeyDown;
+    }
+    if (event.key.keysym.sym == SDLK_RIGHT) {
+      m_isRightDown = isKeyDown;
+    }
+    if (event.key.keysym.sym == SDLK_SPACE && isKeyDown &&
+        !event.key.repeat) {
+      m_isReleaseRequested = true;
+    }
+  }
+
+  AgentAction takeAction()
+  {
+    if (m_isReleaseRequested) {
+      m_isReleaseRequested = false;
+      return AgentAction::release;
+    }
+    if (m_isLeftDown != m_isRightDown) {
+      return m_isLeftDown ? AgentAction::left : AgentAction::right;
+    }
+    return AgentAction::none;
+  }
+
+private:
+  bool m_isLeftDown{ false };
+  bool m_isRightDown{ false };
+  bool m_isReleaseRequested{ false };
+};
+
+void
+renderOpponent(Application& app, RollbackSession& session, bool isStalled)
+{
+  const auto& opponent =
+    session.getWorld(1 - session.getLocalPlayer()).getGameState();
+  const auto text =
+    isStalled ? std::string("Waiting for opponent")
+              : std::format("Opponent: {} ({} balls)",
+                            opponent.score,
+                            opponent.remainingBalls);
+
+  const auto texture = app.getCachedTextureForText(text);
+  const auto textSize = app.getTextureSize(texture);
+  const auto ws = app.getWindowSize();
+  SDL_Rect rect{ ws.x - textSize.x - 10, 10, textSize.x, textSize.y };
+  app.copyTexture(texture, NULL, &rect);
+}
+} // namespace
+
+int
+main(int argc, char* args[])
+{
+  using clock = std::chrono::steady_clock;
+
+  try {
+    const auto settings = parseSettings(argc, args);
+
+    UdpTransport transport(
+      settings.localPort, settings.remoteHost, settings.remotePort);
+    RollbackSession session(transport, settings.session);
+    auto& localWorld = session.getWorld(settings.session.localPlayer);
+
+    Application app;
+    KeyboardInput input;
+    auto lastFrame = clock::now();
+    auto unsimulatedTime = clock::duration(0);
+    bool isStalled = false;
+
+    app.onInitCallback = [&]() {
+#ifdef ARKANOID_EMBED_ASSETS
+      app.loadBakedAssets();
+#else
+      app.loadAssets("assets");
+#endif
+      for (unsigned player = 0; player < RollbackSession::playerCount;
+           player++) {
+        session.getWorld(player).bindSprites(app);
+      }
+      lastFrame = clock::now();
+    };
+    app.onRenderCallback = [&]() {
+      // note: simulation runs in fixed frames regardless of refresh rate
+      const auto now = clock::now();
+      unsimulatedTime += now - lastFrame;
+      lastFrame = now;
+      while (unsimulatedTime >= RollbackSession::frameDelta) {
+        isStalled = !session.advanceFrame(input.takeAction());
+        if (isStalled) {
+          unsimulatedTime = clock::duration(0);
+          break;
+        }
+        unsimulatedTime -= RollbackSession::frameDelta;
+      }
+
+      localWorld.render(app);
+      renderOpponent(app, session, isStalled);
+    };
+    app.onSDLEventCallback = [&](const SDL_Event& event) {
+      input.onEvent(event);
+    };
+    app.setRenderBackend(settings.backend);
+
+    app.createApplication();
+    app.runLoop();
+
+    const auto& stats = session.getStats();
+    std::cout << std::format(
+      "versus: {} frames, {} rollbacks ({} frames re-simulated, max depth {}, "
+      "max {} us), {} stalled frames, {} checksums verified{}\n",
+      session.getFrame(),
+      stats.rollbacks,
+      stats.resimulatedFrames,
+      stats.maxRollbackDepth,
+      stats.maxRollbackTime.count(),
+      stats.stalledFrames,
+      stats.verifiedChecksums,
+      session.isDesynced() ? ", DESYNCED" : "");
+    return session.isDesynced() ? 1 : 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Versus failed: " << e.what() << std::endl;
+    return 1;
+  }
+}